@@ -0,0 +1,182 @@
+#include <Conversion.hpp>
+#include <HalfFloat.hpp>
+
+#include <spdlog/spdlog.h>
+
+#include <boost/program_options.hpp>
+
+#include <opencv2/imgcodecs.hpp>
+#include <opencv2/imgproc.hpp>
+
+#include <chrono>
+#include <cmath>
+#include <cstring>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+/// Synthesize a camera-like frame: smooth illumination gradient, a few flat objects and sensor noise.
+[[nodiscard]] auto syntheticFrame(int width, int height) -> cv::Mat {
+  cv::Mat frame(height, width, CV_8UC3);
+  std::mt19937 generator(42);// NOLINT(cert-msc32-c,cert-msc51-cpp)
+  std::normal_distribution<double> noise(0.0, 1.5);
+
+  // NOLINTBEGIN(altera-unroll-loops)
+  for (int row = 0; row < height; ++row) {
+    auto *pixels = frame.ptr<unsigned char>(row);
+    for (int col = 0; col < width; ++col) {
+      auto const object = ((row / 64) + (col / 96)) % 5 == 0;
+      for (int channel = 0; channel < 3; ++channel) {
+        auto const base = object ? 40.0 + 50.0 * channel : 60.0 + 120.0 * col / width + 40.0 * row / height;
+        auto const value = std::clamp(base + noise(generator), 0.0, 255.0);
+        pixels[col * 3 + channel] = static_cast<unsigned char>(value);
+      }
+    }
+  }
+  // NOLINTEND(altera-unroll-loops)
+  return frame;
+}
+
+/// Synthesize a depth map in meters (CV_32FC1): a tilted ground plane with a few boxes and sensor noise.
+[[nodiscard]] auto syntheticDepthMap(int width, int height) -> cv::Mat {
+  cv::Mat depth(height, width, CV_32FC1);
+  std::mt19937 generator(42);// NOLINT(cert-msc32-c,cert-msc51-cpp)
+  std::normal_distribution<float> noise(0.0F, 0.002F);
+
+  // NOLINTBEGIN(altera-unroll-loops)
+  for (int row = 0; row < height; ++row) {
+    auto *values = depth.ptr<float>(row);
+    for (int col = 0; col < width; ++col) {
+      auto const box = ((row / 128) + (col / 160)) % 4 == 0;
+      auto const plane = 4.0F - 3.0F * static_cast<float>(row) / static_cast<float>(height);
+      values[col] = (box ? plane - 0.5F : plane) + noise(generator);
+    }
+  }
+  // NOLINTEND(altera-unroll-loops)
+  return depth;
+}
+
+/// \return largest absolute difference between the values of both images; NaN if their shapes differ.
+[[nodiscard]] auto maxAbsError(cv::Mat const &expected, cv::Mat const &actual) -> double {
+  if (expected.rows != actual.rows || expected.cols != actual.cols || expected.channels() != actual.channels()) {
+    return std::nan("");
+  }
+
+  cv::Mat expected64{};
+  cv::Mat actual64{};
+  expected.convertTo(expected64, CV_64F);
+  actual.convertTo(actual64, CV_64F);
+  return cv::norm(expected64, actual64, cv::NORM_INF);
+}
+
+/// Average wall time of #function in milliseconds.
+template<typename Function> [[nodiscard]] auto measureMs(std::size_t iterations, Function &&function) -> double {
+  auto const start = std::chrono::steady_clock::now();
+  // NOLINTNEXTLINE(altera-unroll-loops)
+  for (std::size_t i = 0; i < iterations; ++i) { function(); }
+  auto const finish = std::chrono::steady_clock::now();
+  return std::chrono::duration<double, std::milli>(finish - start).count() / static_cast<double>(iterations);
+}
+
+// NOLINTNEXTLINE(bugprone-exception-escape)
+auto main(int argc, char const *const *argv) -> int {
+
+  boost::program_options::options_description description("Compare image encodings (speed and size).");
+  description.add_options()("help", "produce help message")(
+    "image", boost::program_options::value<std::string>()->default_value(""),
+    "Camera frame to encode; a synthetic 1920x1080 frame is used if empty.")(
+    "depthMap", boost::program_options::bool_switch(), "Use a synthetic 1920x1080 float depth map instead.")(
+    "grayscale", boost::program_options::bool_switch(), "Convert the image to a single-channel grayscale frame.")(
+    "encodings",
+    boost::program_options::value<std::vector<std::string>>()->multitoken(),
+    "Encodings to compare; by default all encodings applicable to the image.")(
+    "iterations", boost::program_options::value<std::size_t>()->default_value(20));
+
+  boost::program_options::variables_map variableMap;
+  boost::program_options::store(boost::program_options::parse_command_line(argc, argv, description), variableMap);
+  boost::program_options::notify(variableMap);
+
+  if (variableMap.contains("help")) {
+    std::cout << description << std::endl;
+    return 0;
+  }
+
+  auto const imagePath = variableMap["image"].as<std::string>();
+  auto const depthMap = variableMap["depthMap"].as<bool>();
+  cv::Mat image{};
+  if (depthMap) {
+    image = syntheticDepthMap(1920, 1080);
+  } else {
+    image = imagePath.empty() ? syntheticFrame(1920, 1080) : cv::imread(imagePath, cv::IMREAD_UNCHANGED);
+  }
+  if (image.empty()) {
+    spdlog::error("Could not read image {}.", imagePath);
+    return 1;
+  }
+  if (variableMap["grayscale"].as<bool>() && image.channels() >= 3) {
+    cv::cvtColor(image, image, image.channels() == 3 ? cv::COLOR_BGR2GRAY : cv::COLOR_BGRA2GRAY);
+  }
+
+  auto const floatingPoint = image.depth() == CV_32F || image.depth() == CV_64F;
+  auto encodings = floatingPoint ? std::vector<std::string>{ "MAT_RAW", "MAT_RAW_F16", "MAT_RAW_Q16", "MAT_RAW_Q8" }
+                                 : std::vector<std::string>{ "MAT_RAW", "IMAGE_PNG", "IMAGE_QOI", "IMAGE_JSON" };
+  if (variableMap.contains("encodings")) { encodings = variableMap["encodings"].as<std::vector<std::string>>(); }
+
+  auto const iterations = std::max<std::size_t>(variableMap["iterations"].as<std::size_t>(), 1);
+  auto const rawSize = static_cast<double>(image.total() * image.elemSize());
+
+  std::cout << fmt::format("{}x{} type {}, {} iterations\n", image.cols, image.rows, image.type(), iterations);
+
+  if (image.depth() == CV_32F) {
+    auto const values = image.total() * static_cast<std::size_t>(image.channels());
+    std::vector<float> floats(image.ptr<float>(), image.ptr<float>() + values);
+    std::vector<uint16_t> halves(values);
+    auto const toHalfMs = measureMs(iterations, [&]() { dataspree::inference::floatToHalf(floats, halves); });
+    auto const toFloatMs = measureMs(iterations, [&]() { dataspree::inference::halfToFloat(halves, floats); });
+    std::cout << fmt::format("half precision kernels ({}): to half {:.1f} MB/s, to float {:.1f} MB/s\n",
+      dataspree::inference::halfFloatKernel(),
+      static_cast<double>(values * sizeof(float)) / 1e3 / toHalfMs,
+      static_cast<double>(values * sizeof(float)) / 1e3 / toFloatMs);
+  }
+
+  std::cout << fmt::format("{:<12} {:>12} {:>8} {:>12} {:>12} {:>14} {:>12}\n",
+    "encoding",
+    "bytes",
+    "ratio",
+    "encode [ms]",
+    "decode [ms]",
+    "encode [MB/s]",
+    "max error");
+
+  // NOLINTNEXTLINE(altera-unroll-loops)
+  for (auto const &encoding : encodings) {
+    std::vector<unsigned char> payload{};
+    auto const encodeMs =
+      measureMs(iterations, [&]() { payload = dataspree::inference::encodeImage(image, encoding); });
+    if (payload.empty()) {
+      spdlog::warn("Encoding {} is not applicable to this image.", encoding);
+      continue;
+    }
+
+    auto const payloadSize = payload.size();
+    auto data = dataspree::inference::Buffer(std::vector<char>(payload.begin(), payload.end()));
+    std::optional<cv::Mat> decoded{};
+    auto const decodeMs =
+      measureMs(iterations, [&]() { decoded = dataspree::inference::decodeImage(data, encoding); });
+
+    // Round trip accuracy; 0 for lossless encodings.
+    auto const error = decoded.has_value() ? maxAbsError(image, decoded.value()) : std::nan("");
+
+    std::cout << fmt::format("{:<12} {:>12} {:>8.2f} {:>12.2f} {:>12.2f} {:>14.1f} {:>12.3g}\n",
+      encoding,
+      payloadSize,
+      rawSize / static_cast<double>(payloadSize),
+      encodeMs,
+      decodeMs,
+      rawSize / 1e3 / encodeMs,
+      error);
+  }
+
+  return 0;
+}
@@ -0,0 +1,298 @@
+#include <EventLoop.hpp>
+#include <TcpConnection.hpp>
+
+#include <spdlog/spdlog.h>
+
+#include <boost/program_options.hpp>
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <array>
+#include <chrono>
+#include <cstring>
+#include <iostream>
+#include <optional>
+#include <string>
+#include <thread>
+#include <vector>
+
+/// Ways in which a TcpConnection reads and writes its socket.
+enum class Transport : uint8_t { BLOCKING, EPOLL, IO_URING };
+
+[[nodiscard]] constexpr auto toString(Transport transport) -> std::string_view {
+  switch (transport) {
+  case Transport::BLOCKING:
+    return "blocking";
+  case Transport::EPOLL:
+    return "epoll";
+  default:
+    return "io_uring";
+  }
+}
+
+// NOLINTNEXTLINE(altera-struct-pack-align)
+struct Measurement {
+  double seconds{ 0.0 };
+  std::size_t frames{ 0 };
+  std::size_t bytes{ 0 };
+  /// System calls on the socket (see TcpConnection::getNumberOfSocketCalls) and epoll_wait calls of the event loop.
+  uint64_t calls{ 0 };
+};
+
+/// Listening socket on the loopback interface.
+// NOLINTNEXTLINE(altera-struct-pack-align)
+struct Loopback {
+  Loopback() : fd(socket(AF_INET, SOCK_STREAM, 0)) {
+    sockaddr_in address{};
+    address.sin_family = AF_INET;
+    address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    // NOLINTNEXTLINE(cppcoreguidelines-pro-type-reinterpret-cast)
+    auto *socketAddress = reinterpret_cast<sockaddr *>(&address);
+    socklen_t length = sizeof(address);
+    if (bind(this->fd, socketAddress, length) != 0 || listen(this->fd, 1) != 0
+        || getsockname(this->fd, socketAddress, &length) != 0) {
+      throw std::runtime_error("Could not listen on the loopback interface.");
+    }
+    this->port = ntohs(address.sin_port);
+  }
+
+  ~Loopback() { close(this->fd); }
+
+  Loopback(Loopback const &) = delete;
+  Loopback(Loopback &&) = delete;
+  auto operator=(Loopback const &other) noexcept -> Loopback & = delete;
+  auto operator=(Loopback &&other) noexcept -> Loopback & = delete;
+
+  int fd;
+  uint16_t port{ 0 };
+};
+
+/// Frame (header and payload) of an item with #payloadSize bytes of data.
+[[nodiscard]] auto encodeFrame(std::size_t payloadSize, dataspree::inference::EncodingMode encodingMode)
+  -> std::string {
+  dataspree::inference::core::Item item{};
+  item["data"] = std::string(payloadSize, 'x');
+  auto const message = dataspree::inference::encodeMessage(item, encodingMode);
+
+  std::string body{};
+  // NOLINTNEXTLINE(altera-unroll-loops)
+  for (auto const &segment : message.segments) { body.append(segment.data(), segment.size()); }
+
+  auto const size = dataspree::inference::core::toBigEndian(static_cast<uint32_t>(body.size()));
+  std::string frame(size.begin(), size.end());
+  frame.push_back(static_cast<char>(encodingMode));
+  return frame + body;
+}
+
+/// \return false if #transport is not available.
+auto configure(dataspree::inference::TcpConnection &connection, Transport transport) -> bool {
+  return transport != Transport::IO_URING || connection.setIoUring(true);
+}
+
+/// Receive #frames frames that a peer writes as fast as it can.
+[[nodiscard]] auto measureReceive(Loopback &loopback,
+  Transport transport,
+  std::size_t frames,
+  std::string const &frame,
+  dataspree::inference::EncodingMode encodingMode) -> std::optional<Measurement> {
+  std::thread peer([&loopback, frames, &frame]() {
+    auto const fd = accept(loopback.fd, nullptr, nullptr);
+    std::string batch{};
+    // NOLINTNEXTLINE(altera-unroll-loops)
+    for (std::size_t index = 0; index < 64; ++index) { batch += frame; }
+
+    // The connection closes early if the transport is not available; MSG_NOSIGNAL fails the send instead of raising
+    // SIGPIPE.
+    // NOLINTBEGIN(altera-unroll-loops)
+    auto failed = false;
+    for (std::size_t sent = 0; sent < frames && !failed;) {
+      auto const count = std::min<std::size_t>(64, frames - sent);
+      auto const size = count * frame.size();
+      for (std::size_t offset = 0; offset < size;) {
+        auto const written = send(fd, &batch[offset], size - offset, MSG_NOSIGNAL);
+        if (written <= 0) {
+          failed = true;
+          break;
+        }
+        offset += static_cast<std::size_t>(written);
+      }
+      sent += count;
+    }
+
+    // Read the handshake and wait until the connection is closed.
+    std::array<char, 4096> drain{};
+    while (read(fd, drain.data(), drain.size()) > 0) {}
+    // NOLINTEND(altera-unroll-loops)
+    close(fd);
+  });
+
+  std::optional<Measurement> measurement{};
+  {
+    dataspree::inference::TcpConnection connection("127.0.0.1",
+      loopback.port,
+      dataspree::inference::ReceiveProperties(std::string("benchmark"), encodingMode));
+    if (configure(connection, transport)) {
+      measurement = Measurement{ .frames = frames, .bytes = frames * frame.size() };
+      dataspree::inference::core::Item item{};
+      auto const start = std::chrono::steady_clock::now();
+
+      // NOLINTBEGIN(altera-unroll-loops)
+      if (transport == Transport::EPOLL) {
+        dataspree::inference::EventLoop loop{};
+        std::size_t received{ 0 };
+        loop.add(connection, [&received](auto & /*connection*/, auto & /*item*/) { ++received; });
+        while (received < frames) {
+          loop.runOnce(1000);
+          ++measurement->calls;
+        }
+      } else {
+        for (std::size_t index = 0; index < frames; ++index) {
+          if (connection.receiveItemInto(item) != dataspree::inference::ReceiveStatus::OK) {
+            measurement = std::nullopt;
+            break;
+          }
+        }
+      }
+      // NOLINTEND(altera-unroll-loops)
+
+      if (measurement.has_value()) {
+        measurement->seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        measurement->calls += connection.getNumberOfSocketCalls();
+      }
+    }
+  }
+  peer.join();
+  return measurement;
+}
+
+/// Send #frames frames to a peer that reads as fast as it can; the time includes the reads of the peer.
+[[nodiscard]] auto measureSend(Loopback &loopback,
+  Transport transport,
+  std::size_t frames,
+  std::size_t payloadSize,
+  dataspree::inference::EncodingMode encodingMode) -> std::optional<Measurement> {
+  std::size_t bytes{ 0 };
+  std::thread peer([&loopback, &bytes]() {
+    auto const fd = accept(loopback.fd, nullptr, nullptr);
+    std::vector<char> buffer(std::size_t{ 1 } << 20U);
+    // NOLINTNEXTLINE(altera-unroll-loops)
+    for (auto read = ::read(fd, buffer.data(), buffer.size()); read > 0;
+         read = ::read(fd, buffer.data(), buffer.size())) {
+      bytes += static_cast<std::size_t>(read);
+    }
+    close(fd);
+  });
+
+  std::optional<Measurement> measurement{};
+  {
+    dataspree::inference::TcpConnection connection(
+      "127.0.0.1", loopback.port, dataspree::inference::ReceiveProperties(std::string(""), encodingMode));
+    dataspree::inference::core::Item item{};
+    item["data"] = std::string(payloadSize, 'x');
+
+    if (configure(connection, transport)) {
+      measurement = Measurement{ .frames = frames };
+      auto const start = std::chrono::steady_clock::now();
+
+      // NOLINTBEGIN(altera-unroll-loops)
+      if (transport == Transport::EPOLL) {
+        dataspree::inference::EventLoop loop{};
+        loop.add(connection);
+        for (std::size_t index = 0; index < frames; ++index) { loop.sendItem(connection, item, "benchmark"); }
+        while (connection.hasPendingSends()) {
+          loop.runOnce(1000);
+          ++measurement->calls;
+        }
+        loop.remove(connection);
+      } else {
+        for (std::size_t index = 0; index < frames; ++index) { connection.sendItem(item, "benchmark"); }
+      }
+      // NOLINTEND(altera-unroll-loops)
+
+      measurement->calls += connection.getNumberOfSocketCalls();
+      shutdown(connection.getSocket(), SHUT_WR);
+      peer.join();
+      measurement->seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+      measurement->bytes = bytes;
+      if (connection.getNumberOfMessagesSent() != frames) { measurement = std::nullopt; }
+    }
+  }
+  if (peer.joinable()) { peer.join(); }
+  return measurement;
+}
+
+// NOLINTNEXTLINE(bugprone-exception-escape)
+auto main(int argc, char const *const *argv) -> int {
+
+  boost::program_options::options_description description(
+    "Compare the transports of TcpConnection on the loopback interface (throughput and system calls per frame).");
+  description.add_options()("help", "produce help message")(
+    "frames", boost::program_options::value<std::size_t>()->default_value(20000), "Frames per measurement.")(
+    "payloadSizes",
+    boost::program_options::value<std::vector<std::size_t>>()->multitoken()->default_value({ 256, 16384, 1048576 },
+      "256 16384 1048576"),
+    "Bytes of data per frame.")(
+    "encoding",
+    boost::program_options::value<int>()->default_value(
+      dataspree::inference::core::getUnderlyingValue(dataspree::inference::EncodingMode::MSGPACK)),
+    "Encoding (0) JSON (1) MSGPACK.");
+
+  boost::program_options::variables_map variableMap;
+  boost::program_options::store(boost::program_options::parse_command_line(argc, argv, description), variableMap);
+  boost::program_options::notify(variableMap);
+
+  if (variableMap.contains("help")) {
+    std::cout << description << std::endl;
+    return 0;
+  }
+
+  spdlog::set_level(spdlog::level::warn);
+  Loopback loopback{};
+  auto const baseFrames = std::max<std::size_t>(variableMap["frames"].as<std::size_t>(), 1);
+  auto const encodingMode = dataspree::inference::EncodingMode(
+    static_cast<std::underlying_type_t<dataspree::inference::EncodingMode>>(variableMap["encoding"].as<int>()));
+
+  std::cout << fmt::format("{:<8} {:>10} {:<10} {:>8} {:>12} {:>10} {:>12}\n",
+    "",
+    "payload",
+    "transport",
+    "frames",
+    "frames/s",
+    "MB/s",
+    "calls/frame");
+
+  // NOLINTBEGIN(altera-unroll-loops)
+  for (auto const payloadSize : variableMap["payloadSizes"].as<std::vector<std::size_t>>()) {
+    // Large frames are sent fewer times, such that every measurement moves a similar amount of data.
+    auto const frames = std::max<std::size_t>(baseFrames * 256 / std::max<std::size_t>(payloadSize, 256), 100);
+    auto const frame = encodeFrame(payloadSize, encodingMode);
+
+    for (auto const direction : { std::string_view("receive"), std::string_view("send") }) {
+      for (auto const transport : { Transport::BLOCKING, Transport::EPOLL, Transport::IO_URING }) {
+        auto const measurement = direction == "receive"
+                                   ? measureReceive(loopback, transport, frames, frame, encodingMode)
+                                   : measureSend(loopback, transport, frames, payloadSize, encodingMode);
+        if (!measurement.has_value()) {
+          std::cout << fmt::format(
+            "{:<8} {:>10} {:<10} {:>8} {:>12}\n", direction, payloadSize, toString(transport), frames, "n/a");
+          continue;
+        }
+
+        std::cout << fmt::format("{:<8} {:>10} {:<10} {:>8} {:>12.0f} {:>10.1f} {:>12.3f}\n",
+          direction,
+          payloadSize,
+          toString(transport),
+          measurement->frames,
+          static_cast<double>(measurement->frames) / measurement->seconds,
+          static_cast<double>(measurement->bytes) / 1e6 / measurement->seconds,
+          static_cast<double>(measurement->calls) / static_cast<double>(measurement->frames));
+      }
+    }
+  }
+  // NOLINTEND(altera-unroll-loops)
+
+  return 0;
+}
@@ -1,8 +1,16 @@
 #ifndef DATASPREE_INFERENCE_CONVERSION_HPP
 #define DATASPREE_INFERENCE_CONVERSION_HPP
 
+#include <EncodedImageCache.hpp>
+#include <ThreadPool.hpp>
+#include <TileDelta.hpp>
+
 #include <dataspree/inference/core/Item.hpp>
 
+#include <algorithm>
+#include <span>
+#include <string_view>
+
 namespace dataspree::inference {
 
 struct [[nodiscard]] Buffer {
@@ -49,6 +57,149 @@ private:
 /// Supported message encodings.
 enum class EncodingMode : uint8_t { JSON = 0, MSGPACK = 1 };
 
+/// Client-side filter that is applied while received messages are parsed; skipped subtrees are never converted into
+/// items. Complements the server-side included_paths / excluded_paths for fields that cannot be excluded there.
+///
+/// Paths are relative to the transmitted item and use the syntax of ReceiveProperties::excludedPaths: each element is
+/// an object key or "*", which matches any key and any array element.
+// NOLINTNEXTLINE(altera-struct-pack-align)
+struct DecodeFilter {
+
+  enum class Comparison : uint8_t {
+    LESS = 0,
+    LESS_EQUAL = 1,
+    GREATER = 2,
+    GREATER_EQUAL = 3,
+    EQUAL = 4,
+    NOT_EQUAL = 5,
+  };
+
+  /// Drops the elements of the array at #path whose numeric #field does not satisfy the comparison with #value (f.i.,
+  /// { { "inference", "detection" }, "confidence", Comparison::GREATER_EQUAL, 0.5 }). Elements without a numeric
+  /// #field are kept.
+  // NOLINTNEXTLINE(altera-struct-pack-align)
+  struct Predicate {
+    std::vector<std::string> path;
+    std::string field;
+    Comparison comparison = Comparison::GREATER_EQUAL;
+    double value = 0.0;
+
+    [[nodiscard]] inline auto accepts(double fieldValue) const noexcept -> bool {
+      switch (comparison) {
+      case Comparison::LESS:
+        return fieldValue < value;
+      case Comparison::LESS_EQUAL:
+        return fieldValue <= value;
+      case Comparison::GREATER:
+        return fieldValue > value;
+      case Comparison::GREATER_EQUAL:
+        return fieldValue >= value;
+      case Comparison::EQUAL:
+        return fieldValue == value;
+      case Comparison::NOT_EQUAL:
+        return fieldValue != value;
+      default:
+        return true;
+      }
+    }
+  };
+
+  /// If not empty, only these subtrees (and the objects on the way to them) are decoded.
+  std::vector<std::vector<std::string>> includedPaths{};
+
+  /// Subtrees that are not decoded.
+  std::vector<std::vector<std::string>> excludedPaths{};
+
+  std::vector<Predicate> predicates{};
+
+  [[nodiscard]] inline auto empty() const noexcept -> bool {
+    return includedPaths.empty() && excludedPaths.empty() && predicates.empty();
+  }
+
+  /// \return length of the longest path; nodes below that depth are never filtered.
+  [[nodiscard]] inline auto depth() const noexcept -> std::size_t {
+    std::size_t result{ 0 };
+    for (auto const &path : includedPaths) { result = std::max(result, path.size()); }
+    for (auto const &path : excludedPaths) { result = std::max(result, path.size()); }
+    for (auto const &predicate : predicates) { result = std::max(result, predicate.path.size() + 1); }
+    return result;
+  }
+
+  /// \return true if the subtree at #path is not decoded.
+  [[nodiscard]] inline auto skips(std::span<std::string_view const> path) const noexcept -> bool {
+    auto const matches = [path](std::vector<std::string> const &pattern) {
+      auto const length = std::min(pattern.size(), path.size());
+      for (std::size_t i = 0; i < length; ++i) {
+        if (pattern[i] != "*" && pattern[i] != path[i]) { return false; }
+      }
+      return true;
+    };
+
+    // Excluded paths match subtrees; included paths also match the objects on the way to them.
+    if (std::ranges::any_of(
+          excludedPaths, [&](auto const &pattern) { return pattern.size() <= path.size() && matches(pattern); })) {
+      return true;
+    }
+    return !includedPaths.empty() && std::ranges::none_of(includedPaths, matches);
+  }
+
+  /// \return true if an element of the array at #path is dropped.
+  /// \param field returns the numeric value of a field of the element (std::optional<double>(std::string_view)).
+  template<typename Field>
+  [[nodiscard]] inline auto rejects(std::span<std::string_view const> path, Field &&field) const -> bool {
+    return std::ranges::any_of(predicates, [&](Predicate const &predicate) {
+      if (predicate.path.size() != path.size()) { return false; }
+      for (std::size_t i = 0; i < path.size(); ++i) {
+        if (predicate.path[i] != "*" && predicate.path[i] != path[i]) { return false; }
+      }
+      auto const value = field(std::string_view(predicate.field));
+      return value.has_value() && !predicate.accepts(value.value());
+    });
+  }
+};
+
+/// Client-side options that determine how received messages are decoded.
+// NOLINTNEXTLINE(altera-struct-pack-align)
+struct DecodeProperties {
+
+  /// Keep encoded images (PNG, JPEG, MAT_RAW) as core::LazyMat and only decode them on first access via
+  /// at<cv::Mat>() / find_at<cv::Mat>(). Consumers that never look at the pixels skip image decoding entirely.
+  bool lazyImageDecoding = false;
+
+  /// If set, messages with several encoded elements (f.i., the image plus ROI crops) are decoded concurrently on
+  /// these workers; decodeItem returns once all of them are decoded. Messages with a single encoded element are
+  /// always decoded on the calling thread.
+  std::shared_ptr<ThreadPool> decodePool{};
+
+  /// Reconstructs IMAGE_TILE_DELTA images from the previously received frame of the same path. Required to decode
+  /// that encoding; such images are always decoded eagerly, in order of arrival.
+  std::shared_ptr<TileDeltaDecoder> tileDeltaDecoder{};
+
+  /// Decode item.inference.detection straight from the message into a contiguous std::vector<core::Detection>
+  /// instead of one Item per detection and field; keys outside of the standard schema (x, y, width, height,
+  /// orientation, confidence, label) are dropped. Detections that do not follow the schema are decoded as items.
+  bool typedDetections = false;
+
+  /// Subtrees and array elements that are skipped while parsing.
+  DecodeFilter filter{};
+};
+
+/// Client-side options that determine how images of sent messages are encoded.
+// NOLINTNEXTLINE(altera-struct-pack-align)
+struct EncodeProperties {
+
+  /// If set, encoded image payloads are looked up in and added to this cache.
+  std::shared_ptr<EncodedImageCache> imageCache{};
+
+  /// Tracks the frames sent per path; required to send images with the IMAGE_TILE_DELTA encoding.
+  std::shared_ptr<TileDeltaEncoder> tileDeltaEncoder{};
+
+  /// If set, the images of messages with several images (f.i., the image plus ROI crops or a stereo pair) are encoded
+  /// concurrently on these workers before the message is serialized. Messages with a single image are always encoded
+  /// on the calling thread.
+  std::shared_ptr<ThreadPool> encodePool{};
+};
+
 /// Helper struct that allows the user to define the configuration message for default receive configurations.
 // NOLINTNEXTLINE(altera-struct-pack-align)
 struct ReceiveProperties {
@@ -111,21 +262,113 @@ struct ReceiveProperties {
 
   [[nodiscard]] constexpr auto getEncodingMode() const noexcept -> EncodingMode { return encodingMode; }
 
+  [[nodiscard]] constexpr auto getDecodeProperties() const noexcept -> DecodeProperties const & {
+    return decodeProperties;
+  }
+
+  /// Set the client-side decoding options; these are not transmitted to the Dataspree Inference instance.
+  inline auto setDecodeProperties(DecodeProperties properties) noexcept -> ReceiveProperties & {
+    this->decodeProperties = std::move(properties);
+    return *this;
+  }
+
 private:
   std::string producerName;
   uint32_t maxSendIntervalMs;
   EncodingMode encodingMode;
+  DecodeProperties decodeProperties{};
 
   std::vector<std::vector<std::string>> includedPaths{};
   std::vector<std::vector<std::string>> excludedPaths{};
   std::map<std::string, std::string> encodingMap;
 };
 
-[[nodiscard]] auto encodeItem(core::Item &item, EncodingMode encodingMode,
-  std::string preferredImageEncoding = "") -> Buffer;
+/// Encode an item.
+///
+/// #item is not modified; elements without declared encoding are listed in the encoded elements of the payload only.
+/// The same item may therefore be encoded concurrently, f.i., for several consumers or encoding modes.
+/// \param encodeProperties image cache and tile delta state used to encode the images of the item.
+[[nodiscard]] auto encodeItem(core::Item const &item,
+  EncodingMode encodingMode,
+  std::string preferredImageEncoding = "",
+  EncodeProperties const &encodeProperties = {}) -> Buffer;
+
+/// Encoded message that consists of several memory regions, which are transmitted back to back (f.i., with a single
+/// writev) instead of being concatenated into one buffer.
+// NOLINTNEXTLINE(altera-struct-pack-align)
+struct [[nodiscard]] EncodedMessage final {
+
+  [[nodiscard]] inline auto size() const noexcept -> std::size_t {
+    std::size_t size{ 0 };
+    // NOLINTNEXTLINE(altera-unroll-loops)
+    for (auto const &segment : segments) { size += segment.size(); }
+    return size;
+  }
 
-[[nodiscard]] auto decodeItem(char const *buffer, std::size_t bufferSize, EncodingMode encodingMode) -> core::Item;
+  /// Owns the memory of the segments, except for the memory that is referenced in the encoded item.
+  std::shared_ptr<void const> storage{};
+
+  /// Consecutive parts of the message.
+  std::vector<std::span<char const>> segments{};
+};
 
+/// Encode an item like encodeItem, but reference large payloads instead of copying them into the message.
+///
+/// In MSGPACK, encoded images are referenced from their payload buffers and MAT_RAW images whose data can be sent
+/// as is (continuous single- or two-channel and N-D mats) directly from the data of the cv::Mat. Large strings and
+/// byte arrays are referenced from #item. #item and its images must therefore not be modified until the message is
+/// sent. JSON messages consist of a single segment.
+[[nodiscard]] auto encodeMessage(core::Item const &item,
+  EncodingMode encodingMode,
+  std::string preferredImageEncoding = "",
+  EncodeProperties const &encodeProperties = {}) -> EncodedMessage;
+
+[[nodiscard]] auto decodeItem(char const *buffer,
+  std::size_t bufferSize,
+  EncodingMode encodingMode,
+  DecodeProperties const &decodeProperties = {}) -> core::Item;
+
+/// Decode a message into #item, reusing the nodes of the previously decoded message.
+///
+/// Keys, arrays, strings and typed detections of #item are overwritten in place, so that a stream of messages with a
+/// stable schema is decoded without reallocating the item tree. Keys that are missing in the new message are removed.
+/// \param item previously decoded message (or an empty item); holds the decoded message afterwards.
+auto decodeInto(core::Item &item,
+  char const *buffer,
+  std::size_t bufferSize,
+  EncodingMode encodingMode,
+  DecodeProperties const &decodeProperties = {}) -> void;
+
+
+/// Encode an image into a payload.
+/// \param encoding one of IMAGE_PNG, IMAGE_JSON (JPEG), IMAGE_QOI (fast lossless) or MAT_RAW (any depth supported by
+///        numpy, any number of channels and dimensions). Floating point images
+///        may be sent as MAT_RAW_F16 (half precision) or linearly quantized over their value range as MAT_RAW_Q8 /
+///        MAT_RAW_Q16; these are decoded into CV_32F images.
+/// \return raw (i.e., not base64-encoded) payload; empty if the image could not be encoded.
+[[nodiscard]] auto encodeImage(cv::Mat const &image, std::string const &encoding) -> std::vector<unsigned char>;
+
+/// Decode an image payload.
+/// \param data raw (i.e., not base64-encoded) payload.
+/// \param encoding encoding of the payload (f.i., MAT_RAW or IMAGE_PNG).
+/// \return decoded image or std::nullopt if the payload could not be decoded.
+[[nodiscard]] auto decodeImage(Buffer &data, std::string const &encoding) -> std::optional<cv::Mat>;
+
+/// Decode an EncodingType.PointCloud payload, i.e., a MAT_RAW array of shape (points, fields) or (rows, cols,
+/// fields) with the fields x, y, z [, intensity] [, r, g, b] (3, 4, 6 or 7 fields).
+/// \param payload raw (i.e., not base64-encoded) payload; float32 payloads are transposed directly into the point
+///        cloud without intermediate copies.
+/// \return decoded point cloud or std::nullopt if the payload could not be decoded.
+[[nodiscard]] auto decodePointCloud(std::span<unsigned char const> payload) -> std::optional<core::PointCloud>;
+
+/// Decode a point cloud that was transmitted as a list of points; each point is either a list of 3, 4, 6 or 7 numbers
+/// (see above) or an object with the keys x, y, z and optionally intensity and r, g, b.
+/// \return decoded point cloud or std::nullopt if the item is not a valid list of points.
+[[nodiscard]] auto decodePointCloud(core::Item const &points) -> std::optional<core::PointCloud>;
+
+/// Encode a point cloud as float32 MAT_RAW payload of shape (points, fields).
+/// \return raw (i.e., not base64-encoded) payload; empty if the point cloud could not be encoded.
+[[nodiscard]] auto encodePointCloud(core::PointCloud const &pointCloud) -> std::vector<unsigned char>;
 
 }// namespace dataspree::inference
 
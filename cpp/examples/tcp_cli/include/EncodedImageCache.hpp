@@ -0,0 +1,128 @@
+#ifndef DATASPREE_INFERENCE_ENCODED_IMAGE_CACHE_HPP
+#define DATASPREE_INFERENCE_ENCODED_IMAGE_CACHE_HPP
+
+#include <dataspree/inference/core/Item.hpp>
+
+#include <opencv2/core/mat.hpp>
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <utility>
+
+namespace dataspree::inference {
+
+/// Bounded least-recently-used cache of encoded image payloads.
+///
+/// Entries are identified by the identity of the image (data pointer, size, type and step), the requested encoding
+/// and a generation tag. The generation tag is either declared by the user via #setGeneration (f.i., a frame counter)
+/// or computed from the image content, which is considerably cheaper than PNG or JPEG encoding. Payloads are shared
+/// and immutable, such that hits and inserts do not copy them.
+// NOLINTNEXTLINE(altera-struct-pack-align)
+struct [[nodiscard]] EncodedImageCache final {
+
+  /// Identifies an encoded image.
+  // NOLINTNEXTLINE(altera-struct-pack-align)
+  struct Key {
+    void const *data;
+    int rows;
+    int cols;
+    int type;
+    std::size_t step;
+    uint64_t generation;
+    std::string encoding;
+
+    [[nodiscard]] auto operator==(Key const &other) const noexcept -> bool = default;
+  };
+
+  /// Encoded payload, shared by the cache and the messages that it was sent with.
+  using Payload = std::shared_ptr<core::Item const>;
+
+  /// \param maxEntries maximum number of cached payloads and of declared generations.
+  /// \param maxBytes maximum accumulated size of all cached payloads.
+  explicit EncodedImageCache(std::size_t maxEntries = 8, std::size_t maxBytes = std::size_t{ 64 } << 20U)
+    : maxEntries(maxEntries), maxBytes(maxBytes) {}
+
+  /// Declare the generation of an image buffer. As long as a generation is declared for a buffer, its content is not
+  /// hashed; the user is responsible to declare a new generation whenever the content of the buffer changes.
+  ///
+  /// The declaration holds a reference to the buffer (cv::UMatData) and is dropped once the user released all of
+  /// theirs, such that a buffer that is reused for another frame (f.i., by FrameBufferPool) never inherits it. Images
+  /// that wrap user memory are identified by their data pointer instead; their generation must be cleared (see
+  /// #clearGeneration) or declared anew before the memory is reused. At most maxEntries generations are declared;
+  /// the content of images whose declaration was dropped is hashed.
+  auto setGeneration(cv::Mat const &image, uint64_t generation) -> void;
+
+  /// Drop the declared generation of an image buffer; its content is hashed again from now on.
+  auto clearGeneration(cv::Mat const &image) -> void;
+
+  /// Derive the key under which the payload of #image encoded with #encoding is cached.
+  [[nodiscard]] auto key(cv::Mat const &image, std::string encoding) -> Key;
+
+  /// \return the cached payload or nullptr; updates the hit and miss counters.
+  [[nodiscard]] auto find(Key const &key) -> Payload;
+
+  /// Cache the payload, evicting the least recently used entries if the cache is full.
+  /// \param size size of the payload in bytes.
+  auto insert(Key key, Payload payload, std::size_t size) -> void;
+
+  /// Remove all cached payloads and declared generations.
+  auto clear() -> void;
+
+  [[nodiscard]] inline auto getHits() const noexcept -> uint64_t { return hits.load(std::memory_order_relaxed); }
+
+  [[nodiscard]] inline auto getMisses() const noexcept -> uint64_t { return misses.load(std::memory_order_relaxed); }
+
+private:
+  struct KeyHash {
+    [[nodiscard]] auto operator()(Key const &key) const noexcept -> std::size_t;
+  };
+
+  // NOLINTNEXTLINE(altera-struct-pack-align)
+  struct Entry {
+    Key key;
+    Payload payload;
+    std::size_t size;
+  };
+
+  /// Generation declared for an image buffer (see #setGeneration).
+  // NOLINTNEXTLINE(altera-struct-pack-align)
+  struct Declaration {
+    /// Reference to the buffer, which keeps it from being reused while the generation is declared; empty for images
+    /// that wrap user memory.
+    cv::Mat buffer;
+    uint64_t generation;
+  };
+
+  /// \return identity of the buffer of #image under which its generation is declared.
+  [[nodiscard]] static auto bufferOf(cv::Mat const &image) noexcept -> void const *;
+
+  /// Hash the pixel content of an image.
+  [[nodiscard]] static auto hashContent(cv::Mat const &image) -> uint64_t;
+
+  auto evict() -> void;
+
+  /// Drop the declarations of buffers that the user released. Requires the lock.
+  auto dropReleasedGenerations() -> void;
+
+  std::size_t maxEntries;
+  std::size_t maxBytes;
+
+  mutable std::mutex mutex{};
+  std::list<Entry> entries{};
+  std::unordered_map<Key, std::list<Entry>::iterator, KeyHash> index{};
+  std::unordered_map<void const *, Declaration> generations{};
+  std::size_t cachedBytes{ 0 };
+
+  std::atomic<uint64_t> hits{ 0 };
+  std::atomic<uint64_t> misses{ 0 };
+};
+
+}// namespace dataspree::inference
+
+#endif// DATASPREE_INFERENCE_ENCODED_IMAGE_CACHE_HPP
@@ -0,0 +1,268 @@
+#ifndef DATASPREE_INFERENCE_EVENT_LOOP_HPP
+#define DATASPREE_INFERENCE_EVENT_LOOP_HPP
+
+#include <Task.hpp>
+#include <TcpConnection.hpp>
+
+#include <dataspree/inference/core/Item.hpp>
+
+#include <atomic>
+#include <chrono>
+#include <coroutine>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <stop_token>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+namespace dataspree::inference {
+
+/// Drives many TcpConnections from a single thread with epoll (Linux only).
+///
+/// Connections are established as usual (including the ReceiveProperties handshake) and then added to the loop, which
+/// switches them to non-blocking mode. Each connection decodes its messages into its own item, which is reused for
+/// the next message (see decodeInto) and handed to the item callback. Messages are sent with #sendItem; the ones that
+/// the socket does not accept immediately are queued and sent once the socket is writable. The receive timeout of
+/// the connections does not apply; idle connections are kept.
+///
+/// Coroutines (see Task and #spawn) receive and send with #receiveItemAsync and #sendItemAsync instead, which suspend
+/// them until the loop completed the operation, such that many streams are pipelined in straight-line code.
+// NOLINTNEXTLINE(altera-struct-pack-align)
+struct [[nodiscard]] EventLoop final {
+
+  /// Invoked for every received message; #item is only valid during the call.
+  using ItemCallback = std::function<void(TcpConnection &connection, core::Item &item)>;
+
+  /// Invoked once the peer closed the connection or the socket failed; the connection is removed from the loop
+  /// before, such that it can be reconnected and added again.
+  using CloseCallback = std::function<void(TcpConnection &connection, ReceiveStatus status)>;
+
+  struct ReceiveItemAwaitable;
+  struct SendItemAwaitable;
+
+  EventLoop();
+
+  /// Destroys the spawned coroutines that did not finish.
+  ~EventLoop();
+
+  EventLoop(EventLoop const &) = delete;
+  EventLoop(EventLoop &&) = delete;
+  auto operator=(EventLoop const &other) noexcept -> EventLoop & = delete;
+  auto operator=(EventLoop &&other) noexcept -> EventLoop & = delete;
+
+  /// Add a connected #connection to the loop; it must outlive its membership. Not thread-safe.
+  /// \param onItem receives the messages that no coroutine awaits; without it, messages are only read while a
+  ///        coroutine awaits them.
+  /// \return false if the connection is not connected or could not be registered.
+  auto add(TcpConnection &connection, ItemCallback onItem = {}, CloseCallback onClose = {}) -> bool;
+
+  /// Remove #connection from the loop; it stays in non-blocking mode. Coroutines that wait for the connection are
+  /// resumed with CANCELLED. Not thread-safe.
+  auto remove(TcpConnection &connection) -> void;
+
+  /// Send #item to #consumerName without blocking (see TcpConnection::sendItem); images of the item are sent from
+  /// their buffers, which must not be overwritten until the message is sent (see TcpConnection::hasPendingSends).
+  /// \return false if the connection failed.
+  auto sendItem(TcpConnection &connection, core::Item const &item, std::string const &consumerName) -> bool;
+
+  /// Await the next message of #connection, which is decoded into #item (see TcpConnection::receiveItemInto). The
+  /// connection is added to the loop if necessary. Concurrent receivers of a connection get its messages in order.
+  /// \param timeoutMs 0 to wait without deadline; a message that is interrupted by the timeout is resumed by the next
+  ///        receive.
+  /// \param stopToken cancels waiting (f.i., from another thread).
+  /// \return awaitable whose result is OK, TIMEOUT, CANCELLED or the status with which the connection was closed.
+  [[nodiscard]] auto receiveItemAsync(TcpConnection &connection,
+    core::Item &item,
+    std::size_t timeoutMs = 0,
+    std::stop_token stopToken = {}) -> ReceiveItemAwaitable;
+
+  /// Queue #item for #consumerName immediately (see #sendItem) and await that the message is sent completely, after
+  /// which the buffers of its images may be overwritten. The connection is added to the loop if necessary.
+  /// \param timeoutMs 0 to wait without deadline; a message that is not sent by then stays queued.
+  /// \param stopToken cancels waiting; the message stays queued.
+  /// \return awaitable whose result is true once the message was sent.
+  [[nodiscard]] auto sendItemAsync(TcpConnection &connection,
+    core::Item const &item,
+    std::string const &consumerName,
+    std::size_t timeoutMs = 0,
+    std::stop_token stopToken = {}) -> SendItemAwaitable;
+
+  /// Start #task, which runs on the loop until it finished; exceptions that escape it are logged.
+  auto spawn(Task<void> task) -> void;
+
+  /// Execute #function on the loop; may be called from any thread.
+  auto post(std::function<void()> function) -> void;
+
+  /// Handle the events that occur within #timeoutMs (and the deadlines of awaiting coroutines that passed).
+  /// \param timeoutMs -1 to wait for the first event.
+  /// \return number of received messages.
+  auto runOnce(int timeoutMs = -1) -> std::size_t;
+
+  /// Handle events until #stop is called.
+  auto run() -> void;
+
+  /// Let #run return; may be called from any thread (and from the callbacks).
+  auto stop() noexcept -> void;
+
+  /// \return number of connections in the loop.
+  [[nodiscard]] inline auto size() const noexcept -> std::size_t { return this->registrations.size(); }
+
+private:
+  using Clock = std::chrono::steady_clock;
+
+  /// Coroutine that waits for an operation of a connection.
+  // NOLINTNEXTLINE(altera-struct-pack-align)
+  struct Waiter {
+    Waiter(EventLoop &loop, TcpConnection &connection, std::size_t timeoutMs, std::stop_token stopToken);
+
+    /// Stop waiting if the coroutine is destroyed while it is suspended.
+    ~Waiter() { this->unregister(); }
+
+    Waiter(Waiter const &) = delete;
+    Waiter(Waiter &&) = delete;
+    auto operator=(Waiter const &other) noexcept -> Waiter & = delete;
+    auto operator=(Waiter &&other) noexcept -> Waiter & = delete;
+
+    /// Suspend #coroutine until the loop completes the operation, the deadline passes or waiting is cancelled.
+    auto suspend(std::coroutine_handle<> coroutine, std::deque<Waiter *> &queue) -> void;
+
+    /// Remove the waiter from the loop; returns the suspended coroutine.
+    auto unregister() -> std::coroutine_handle<>;
+
+    EventLoop *loop;
+    TcpConnection *connection;
+    uint64_t id;
+    std::optional<Clock::time_point> deadline{};
+    std::stop_token stopToken;
+    ReceiveStatus status{ ReceiveStatus::OK };
+
+    /// State while suspended.
+    std::coroutine_handle<> coroutine{};
+    std::deque<Waiter *> *queue{ nullptr };
+    std::multimap<Clock::time_point, Waiter *>::iterator timer{};
+    std::optional<std::stop_callback<std::function<void()>>> stopCallback{};
+  };
+
+  // NOLINTNEXTLINE(altera-struct-pack-align)
+  struct Registration {
+    /// nullptr once the connection was removed.
+    TcpConnection *connection;
+    ItemCallback onItem;
+    CloseCallback onClose;
+
+    /// Item into which the messages of the connection are decoded.
+    core::Item item{};
+
+    /// Coroutines that await messages (ReceiveItemAwaitable) and sends (SendItemAwaitable), in order.
+    std::deque<Waiter *> receivers{};
+    std::deque<Waiter *> senders{};
+
+    /// Events for which epoll waits.
+    uint32_t events{ 0 };
+  };
+
+  /// \return registration of #connection, which is added to the loop if necessary; nullptr if that failed.
+  auto registrationOf(TcpConnection &connection) -> Registration *;
+
+  /// Wait for the socket of #registration to become readable if messages are expected and to become writable if its
+  /// connection has queued messages.
+  auto updateInterest(Registration &registration) -> bool;
+
+  /// Decode the buffered messages of #registration for its receivers (or its item callback).
+  /// \return number of decoded messages.
+  auto deliver(Registration &registration) -> std::size_t;
+
+  /// Resume the coroutines whose messages were sent.
+  auto resumeSenders(Registration &registration) -> void;
+
+  /// Resume the coroutine of #waiter with #status.
+  static auto complete(Waiter &waiter, ReceiveStatus status) -> void;
+
+  /// Remove the connection of #registration and resume its coroutines with #status.
+  auto detach(Registration &registration, ReceiveStatus status) -> void;
+
+  /// Remove the connection of #registration and notify the close callback.
+  auto close(Registration &registration, ReceiveStatus status) -> void;
+
+  /// Interrupt epoll_wait.
+  auto wake() const noexcept -> void;
+
+  int epollFd{ -1 };
+
+  /// Event file descriptor that wakes up the loop (see #stop and #post).
+  int wakeFd{ -1 };
+
+  std::atomic<bool> stopping{ false };
+
+  std::unordered_map<TcpConnection const *, std::unique_ptr<Registration>> registrations{};
+
+  /// Registrations that were removed while handling events; released once all events are handled.
+  std::vector<std::unique_ptr<Registration>> removedRegistrations{};
+
+  /// Suspended coroutines by id and by deadline.
+  uint64_t nextWaiterId{ 0 };
+  std::unordered_map<uint64_t, Waiter *> waiters{};
+  std::multimap<Clock::time_point, Waiter *> timers{};
+
+  /// Frames (see std::coroutine_handle::address) of the coroutines started by #spawn that did not finish.
+  std::unordered_set<void *> spawned{};
+
+  std::mutex postMutex{};
+  std::vector<std::function<void()>> posted{};
+};
+
+/// Awaitable of EventLoop::receiveItemAsync.
+// NOLINTNEXTLINE(altera-struct-pack-align)
+struct [[nodiscard]] EventLoop::ReceiveItemAwaitable final : EventLoop::Waiter {
+  ReceiveItemAwaitable(EventLoop &loop,
+    TcpConnection &connection,
+    core::Item &item,
+    std::size_t timeoutMs,
+    std::stop_token stopToken)
+    : Waiter(loop, connection, timeoutMs, std::move(stopToken)), item(&item) {}
+
+  /// Decode a message that is buffered already without suspending.
+  [[nodiscard]] auto await_ready() -> bool;
+
+  /// \return false if the connection could not be waited for.
+  [[nodiscard]] auto await_suspend(std::coroutine_handle<> coroutine) -> bool;
+
+  [[nodiscard]] inline auto await_resume() const noexcept -> ReceiveStatus { return this->status; }
+
+  core::Item *item;
+};
+
+/// Awaitable of EventLoop::sendItemAsync.
+// NOLINTNEXTLINE(altera-struct-pack-align)
+struct [[nodiscard]] EventLoop::SendItemAwaitable final : EventLoop::Waiter {
+  /// Queue the message.
+  SendItemAwaitable(EventLoop &loop,
+    TcpConnection &connection,
+    core::Item const &item,
+    std::string const &consumerName,
+    std::size_t timeoutMs,
+    std::stop_token stopToken);
+
+  /// Complete if the message was sent by the first attempt.
+  [[nodiscard]] auto await_ready() const noexcept -> bool;
+
+  /// \return false if the connection was removed from the loop.
+  [[nodiscard]] auto await_suspend(std::coroutine_handle<> coroutine) -> bool;
+
+  [[nodiscard]] inline auto await_resume() const noexcept -> bool { return this->status == ReceiveStatus::OK; }
+
+  /// Number of sent messages (see TcpConnection::getNumberOfMessagesSent) once this message was sent.
+  std::size_t sentTarget{ 0 };
+};
+
+}// namespace dataspree::inference
+
+#endif// DATASPREE_INFERENCE_EVENT_LOOP_HPP
@@ -0,0 +1,121 @@
+#ifndef DATASPREE_INFERENCE_FRAME_BUFFER_POOL_HPP
+#define DATASPREE_INFERENCE_FRAME_BUFFER_POOL_HPP
+
+#include <opencv2/core/mat.hpp>
+#include <opencv2/core/version.hpp>
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+namespace dataspree::inference {
+
+/// cv::MatAllocator that keeps released image buffers for reuse.
+///
+/// Streams decode and encode images of the same size every frame; recycling their buffers avoids the malloc / munmap
+/// churn and the page faults of touching freshly mapped memory. Buffers are pooled by their (rounded) size in bytes,
+/// which covers all image types of that size. Large buffers are mapped as separate, 2 MiB aligned slabs and advised
+/// to be backed by transparent huge pages (Linux only). Buffers are released instead of pooled once the pool retains
+/// more than the configured number of bytes.
+///
+/// Images keep a pointer to their allocator, so the pool must outlive all images that it allocated; use #instance.
+// NOLINTNEXTLINE(altera-struct-pack-align)
+struct [[nodiscard]] FrameBufferPool final : cv::MatAllocator {
+
+#if CV_VERSION_MAJOR >= 4
+  using AccessFlags = cv::AccessFlag;
+#else
+  /// OpenCV 3 passes the access flags of the allocator as int.
+  using AccessFlags = int;
+#endif
+
+  /// Smaller buffers are served well by malloc and are not pooled.
+  static constexpr std::size_t minPooledSize{ std::size_t{ 64 } << 10U };
+
+  /// Buffers of at least this size are allocated as huge page backed slabs.
+  static constexpr std::size_t hugePageSize{ std::size_t{ 2 } << 20U };
+
+  /// \param maxRetainedBytes maximum accumulated size of all buffers that are kept for reuse; 0 disables pooling.
+  /// \param maxBuffersPerSize maximum number of buffers of the same size that are kept for reuse.
+  explicit FrameBufferPool(std::size_t maxRetainedBytes = std::size_t{ 256 } << 20U, std::size_t maxBuffersPerSize = 4)
+    : maxRetainedBytes(maxRetainedBytes), maxBuffersPerSize(maxBuffersPerSize) {}
+
+  /// Release all pooled buffers; buffers that are still in use must not be returned afterwards.
+  ~FrameBufferPool() override;
+
+  FrameBufferPool(FrameBufferPool const &) = delete;
+  FrameBufferPool(FrameBufferPool &&) = delete;
+  auto operator=(FrameBufferPool const &other) noexcept -> FrameBufferPool & = delete;
+  auto operator=(FrameBufferPool &&other) noexcept -> FrameBufferPool & = delete;
+
+  /// \return process-wide pool that is never destroyed; used for the images of decodeItem and encodeImage.
+  [[nodiscard]] static auto instance() -> FrameBufferPool &;
+
+  /// Change the retention limits; pooled buffers that exceed the new limits are released.
+  auto configure(std::size_t newMaxRetainedBytes, std::size_t newMaxBuffersPerSize) -> void;
+
+  /// \return empty image that allocates its buffer from this pool (f.i., as output of cv::imdecode or convertTo).
+  [[nodiscard]] auto mat() -> cv::Mat;
+
+  /// \return image with uninitialized content whose buffer is allocated from this pool.
+  [[nodiscard]] auto mat(int dims, int const *sizes, int type) -> cv::Mat;
+
+  [[nodiscard]] inline auto mat(int rows, int cols, int type) -> cv::Mat {
+    std::array<int, 2> const sizes{ rows, cols };
+    return mat(2, sizes.data(), type);
+  }
+
+  /// Release all pooled buffers.
+  auto trim() -> void;
+
+  [[nodiscard]] inline auto getHits() const noexcept -> uint64_t { return hits.load(std::memory_order_relaxed); }
+
+  [[nodiscard]] inline auto getMisses() const noexcept -> uint64_t { return misses.load(std::memory_order_relaxed); }
+
+  [[nodiscard]] auto getRetainedBytes() const -> std::size_t;
+
+  auto allocate(int dims,
+    int const *sizes,
+    int type,
+    void *data,
+    std::size_t *step,
+    AccessFlags flags,
+    cv::UMatUsageFlags usageFlags) const -> cv::UMatData * override;
+
+  auto allocate(cv::UMatData *data, AccessFlags accessFlags, cv::UMatUsageFlags usageFlags) const -> bool override;
+
+  auto deallocate(cv::UMatData *data) const -> void override;
+
+private:
+  /// \return size of the buffer that is allocated for #size bytes.
+  [[nodiscard]] static auto capacity(std::size_t size) noexcept -> std::size_t;
+
+  [[nodiscard]] auto acquire(std::size_t capacity) const -> unsigned char *;
+
+  auto release(unsigned char *buffer, std::size_t capacity) const -> void;
+
+  /// Release pooled buffers of sizes other than #keep until #bytes more fit into the pool. Requires the lock.
+  auto makeRoom(std::size_t bytes, std::size_t keep) const -> void;
+
+  [[nodiscard]] static auto allocateBuffer(std::size_t capacity) -> unsigned char *;
+
+  static auto freeBuffer(unsigned char *buffer, std::size_t capacity) noexcept -> void;
+
+  std::size_t maxRetainedBytes;
+  std::size_t maxBuffersPerSize;
+
+  mutable std::mutex mutex{};
+  mutable std::unordered_map<std::size_t, std::vector<unsigned char *>> buffers{};
+  mutable std::size_t retainedBytes{ 0 };
+
+  mutable std::atomic<uint64_t> hits{ 0 };
+  mutable std::atomic<uint64_t> misses{ 0 };
+};
+
+}// namespace dataspree::inference
+
+#endif// DATASPREE_INFERENCE_FRAME_BUFFER_POOL_HPP
@@ -0,0 +1,30 @@
+#ifndef DATASPREE_INFERENCE_HALF_FLOAT_HPP
+#define DATASPREE_INFERENCE_HALF_FLOAT_HPP
+
+#include <cstdint>
+#include <span>
+#include <string_view>
+
+namespace dataspree::inference {
+
+/// Convert a single precision float to IEEE 754 half precision (round to nearest even; NaN stays NaN, values beyond
+/// the half precision range become infinity).
+[[nodiscard]] auto floatToHalf(float value) noexcept -> uint16_t;
+
+/// Convert an IEEE 754 half precision value to single precision (exact).
+[[nodiscard]] auto halfToFloat(uint16_t value) noexcept -> float;
+
+/// Convert #source to half precision; uses F16C instructions if the CPU supports them.
+/// \param destination must hold at least source.size() values.
+auto floatToHalf(std::span<float const> source, std::span<uint16_t> destination) noexcept -> void;
+
+/// Convert #source to single precision; uses F16C instructions if the CPU supports them.
+/// \param destination must hold at least source.size() values.
+auto halfToFloat(std::span<uint16_t const> source, std::span<float> destination) noexcept -> void;
+
+/// \return name of the conversion kernels that are used on this CPU ("F16C" or "scalar").
+[[nodiscard]] auto halfFloatKernel() noexcept -> std::string_view;
+
+}// namespace dataspree::inference
+
+#endif// DATASPREE_INFERENCE_HALF_FLOAT_HPP
@@ -0,0 +1,156 @@
+#ifndef DATASPREE_INFERENCE_IO_URING_HPP
+#define DATASPREE_INFERENCE_IO_URING_HPP
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <span>
+#include <vector>
+
+#ifdef __linux__
+#include <sys/socket.h>
+#endif
+
+struct io_uring_sqe;
+struct io_uring_cqe;
+struct io_uring_buf_ring;
+struct iovec;
+
+namespace dataspree::inference {
+
+/// Minimal io_uring for the blocking receive and send paths of a TcpConnection, on the raw system calls (no liburing).
+///
+/// Receives take their memory from a ring of buffers that is registered with the kernel once (provided buffers). A
+/// multishot receive stays armed across calls and completes every chunk of data as it arrives, such that data that
+/// arrived in the meantime is taken from the completion queue without a system call. Sends submit the header and the
+/// body of every frame as linked operations, all frames of a call with a single system call.
+///
+/// Rings that receive require Linux 5.19 (provided buffer rings), rings that only send Linux 5.11; multishot receives
+/// require Linux 6.0 and fall back to single receives. Not thread-safe: a connection uses one ring for receiving and another one for sending.
+// NOLINTNEXTLINE(altera-struct-pack-align)
+struct [[nodiscard]] IoUring final {
+
+  using Clock = std::chrono::steady_clock;
+
+  /// Result of #receive if no data arrived before the deadline.
+  static constexpr int64_t timedOut{ -1 };
+
+  /// Result of #receive if the socket or the ring failed.
+  static constexpr int64_t failed{ -2 };
+
+  /// \param entries size of the submission queue.
+  /// \param numberReceiveBuffers number of receive buffers (rounded up to a power of two); 0 for rings that only send.
+  /// \return ring, or nullptr if the kernel does not support the required features or io_uring is disabled (f.i., by
+  ///         the seccomp profile of a container).
+  [[nodiscard]] static auto create(unsigned entries,
+    std::size_t numberReceiveBuffers = 0,
+    std::size_t receiveBufferSize = 0) -> std::unique_ptr<IoUring>;
+
+  /// Cancels the armed receive and releases the ring.
+  ~IoUring();
+
+  IoUring(IoUring const &) = delete;
+  IoUring(IoUring &&) = delete;
+  auto operator=(IoUring const &other) noexcept -> IoUring & = delete;
+  auto operator=(IoUring &&other) noexcept -> IoUring & = delete;
+
+  /// Copy data of #fd into #buffer; the data of a completion that does not fit is returned by the next calls.
+  /// \param deadline time at which #timedOut is returned; wait indefinitely if not set.
+  /// \return number of received bytes; 0 if the peer closed the connection, #timedOut or #failed otherwise.
+  [[nodiscard]] auto receive(int fd, std::span<char> buffer, std::optional<Clock::time_point> deadline) -> int64_t;
+
+  /// Send #frames over #fd in order; the first segment of each frame is its header, the others its body.
+  /// \param deadline time at which the operations are cancelled; wait indefinitely if not set.
+  /// \return number of bytes that were sent in order from the start; less than the size of the frames if the ring
+  ///         stopped early (short send, timeout or error), in which case the caller resumes at that byte.
+  [[nodiscard]] auto send(int fd, std::span<std::span<iovec const> const> frames,
+    std::optional<Clock::time_point> deadline) -> std::size_t;
+
+  /// \return number of system calls (io_uring_enter and io_uring_register) of the ring.
+  [[nodiscard]] inline auto getNumberOfSyscalls() const noexcept -> uint64_t {
+    return this->numberOfSyscalls.load(std::memory_order_relaxed);
+  }
+
+private:
+  IoUring() = default;
+
+  /// Register a ring of #count buffers of #size bytes, from which receives take their memory.
+  auto provideReceiveBuffers(std::size_t count, std::size_t size) -> bool;
+
+  /// Hand buffer #id back to the kernel.
+  auto recycleReceiveBuffer(uint16_t id) noexcept -> void;
+
+  /// \return cleared entry at the tail of the submission queue; nullptr if the queue is full.
+  auto nextSubmission() noexcept -> io_uring_sqe *;
+
+  /// Take back the entry that #nextSubmission returned last (before it is published by #enter).
+  auto discardSubmission() noexcept -> void;
+
+  /// Take the completion at the head of the completion queue into #completion.
+  /// \return false if the queue is empty.
+  auto takeCompletion(io_uring_cqe &completion) noexcept -> bool;
+
+  /// Submit the prepared entries and wait for #minComplete completions until #deadline.
+  /// \return number of submitted entries; negative errno on failure (-ETIME on timeout).
+  auto enter(unsigned minComplete, std::optional<Clock::time_point> deadline) noexcept -> int;
+
+  /// Cancel the operation in flight with #userData; the completion of the cancellation has the user data
+  /// cancelUserData.
+  auto cancel(uint64_t userData) noexcept -> bool;
+
+  int ringFd{ -1 };
+
+  /// Mapping of the submission and the completion queue (IORING_FEAT_SINGLE_MMAP) and of the submission entries.
+  void *queues{ nullptr };
+  std::size_t queuesSize{ 0 };
+  io_uring_sqe *submissions{ nullptr };
+  std::size_t submissionsSize{ 0 };
+
+  unsigned *submissionHead{ nullptr };
+  unsigned *submissionTail{ nullptr };
+  unsigned *submissionArray{ nullptr };
+  unsigned submissionMask{ 0 };
+  unsigned numberSubmissionEntries{ 0 };
+  /// Tail of the prepared entries, which is published by #enter.
+  unsigned preparedTail{ 0 };
+  /// Number of published entries that the kernel did not take yet.
+  unsigned unsubmitted{ 0 };
+
+  unsigned *completionHead{ nullptr };
+  unsigned *completionTail{ nullptr };
+  io_uring_cqe *completions{ nullptr };
+  unsigned completionMask{ 0 };
+
+  /// Provided buffers: the ring of their descriptors (shared with the kernel) and their memory.
+  io_uring_buf_ring *bufferRing{ nullptr };
+  std::size_t bufferRingSize{ 0 };
+  std::vector<char> receiveBuffers{};
+  std::size_t receiveBufferSize{ 0 };
+  uint16_t bufferRingMask{ 0 };
+  uint16_t bufferRingTail{ 0 };
+
+#ifdef __linux__
+  /// Headers of the message bodies of #send; kept while the kernel may refer to them.
+  std::vector<msghdr> sendBodies{};
+#endif
+  /// Set if the ring could not wait for the operations of #send, which then returns 0 (see TcpConnection).
+  bool sendFailed{ false };
+
+  /// Whether a receive is in flight and whether the kernel supports multishot receives.
+  bool receiveArmed{ false };
+  bool multishot{ true };
+
+  /// Data of the last receive completion that was not copied yet.
+  uint16_t pendingBuffer{ 0 };
+  std::size_t pendingOffset{ 0 };
+  std::size_t pendingSize{ 0 };
+
+  std::atomic<uint64_t> numberOfSyscalls{ 0 };
+};
+
+}// namespace dataspree::inference
+
+#endif// DATASPREE_INFERENCE_IO_URING_HPP
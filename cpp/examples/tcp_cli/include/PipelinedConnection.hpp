@@ -0,0 +1,171 @@
+#ifndef DATASPREE_INFERENCE_PIPELINED_CONNECTION_HPP
+#define DATASPREE_INFERENCE_PIPELINED_CONNECTION_HPP
+
+#include <TcpConnection.hpp>
+
+#include <dataspree/inference/core/Item.hpp>
+
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace dataspree::inference {
+
+/// Time that a stage of a PipelinedConnection spent on its messages.
+// NOLINTNEXTLINE(altera-struct-pack-align)
+struct PipelineStage {
+  /// Number of messages that passed the stage.
+  uint64_t messages{ 0 };
+
+  /// Time spent working (receive: waiting for, reading and decoding data; application: between the calls to the
+  /// connection; send: encoding and writing).
+  std::chrono::nanoseconds busy{};
+
+  /// Time spent waiting for the neighbouring stages (receive: for room in the receive queue; application: for
+  /// received messages and for room in the send queue; send: for messages to send).
+  std::chrono::nanoseconds stalled{};
+
+  /// \return average busy time per message in milliseconds.
+  [[nodiscard]] inline auto getBusyMs() const noexcept -> double {
+    return messages == 0 ? 0.0
+                         : std::chrono::duration<double, std::milli>(busy).count() / static_cast<double>(messages);
+  }
+
+  /// \return average stalled time per message in milliseconds.
+  [[nodiscard]] inline auto getStalledMs() const noexcept -> double {
+    return messages == 0 ? 0.0
+                         : std::chrono::duration<double, std::milli>(stalled).count() / static_cast<double>(messages);
+  }
+};
+
+/// Snapshot of the queues and stages of a PipelinedConnection. The stage that stalls least limits the throughput.
+// NOLINTNEXTLINE(altera-struct-pack-align)
+struct PipelineStatistics {
+  PipelineStage receive{};
+  PipelineStage application{};
+  PipelineStage send{};
+
+  /// Number of queued messages, now and at most since the pipeline was started.
+  std::size_t receiveQueueDepth{ 0 };
+  std::size_t sendQueueDepth{ 0 };
+  std::size_t maxReceiveQueueDepth{ 0 };
+  std::size_t maxSendQueueDepth{ 0 };
+};
+
+/// Full-duplex mode of a (blocking) TcpConnection: a receive thread reads and decodes messages into a bounded queue
+/// and a send thread encodes and writes the messages of another bounded queue, such that receiving, the work of the
+/// application and sending overlap instead of adding up per frame.
+///
+/// Full queues block the stage that feeds them (back pressure). Received items are recycled: #receive swaps the
+/// queued item with the item of the caller, whose nodes are reused for a later message (see decodeInto). Sent items
+/// share their images with the caller (cv::Mat is reference counted), so images must not be written to after they
+/// were passed to #send; use a new image per frame instead (see FrameBufferPool).
+///
+/// The connection must not be used otherwise while the pipeline runs; #receive and #send are meant to be called from
+/// a single application thread.
+// NOLINTNEXTLINE(altera-struct-pack-align)
+struct [[nodiscard]] PipelinedConnection final {
+
+  /// \param receiveQueueSize maximum number of received messages that wait for the application (at least one).
+  /// \param sendQueueSize maximum number of messages that wait for the send thread (at least one).
+  /// \param maxTimeouts number of consecutive receive timeouts of the connection after which the pipeline stops with
+  ///                    TIMEOUT (a vanished peer does not close the connection); 0 waits indefinitely.
+  explicit PipelinedConnection(TcpConnection &connection,
+    std::size_t receiveQueueSize = 2,
+    std::size_t sendQueueSize = 2,
+    std::size_t maxTimeouts = 0)
+    : connection(connection), receiveQueueSize(std::max<std::size_t>(receiveQueueSize, 1)),
+      sendQueueSize(std::max<std::size_t>(sendQueueSize, 1)), maxTimeouts(maxTimeouts) {}
+
+  /// Stops the pipeline.
+  ~PipelinedConnection() { this->stop(); }
+
+  PipelinedConnection(PipelinedConnection const &) = delete;
+  PipelinedConnection(PipelinedConnection &&) = delete;
+  auto operator=(PipelinedConnection const &other) noexcept -> PipelinedConnection & = delete;
+  auto operator=(PipelinedConnection &&other) noexcept -> PipelinedConnection & = delete;
+
+  /// Start the threads; the receive thread only runs if receiving is configured (see
+  /// TcpConnection::isReceiveConfigured). Queues and statistics of a previous run are reset.
+  auto start() -> void;
+
+  /// Join the threads and drop the queued messages. Waits for the current receive, which takes at most the timeout
+  /// of the connection.
+  auto stop() -> void;
+
+  /// Take the next received message, which is swapped into #item.
+  /// \param timeoutMs 0 to wait without deadline.
+  /// \return OK, TIMEOUT or the status with which the receive thread stopped (CLOSED, FAILED or TIMEOUT after
+  ///         maxTimeouts consecutive timeouts; the connection needs to be reestablished, see #stop and #start).
+  ///         CANCELLED if the pipeline is not running. #isRunning tells whether TIMEOUT stopped the pipeline.
+  auto receive(core::Item &item, std::size_t timeoutMs = 0) -> ReceiveStatus;
+
+  /// Queue #item for #consumerName; blocks while the send queue is full.
+  /// \return false if the connection failed or the pipeline is not running.
+  auto send(core::Item item, std::string consumerName) -> bool;
+
+  /// \return true while the threads run and the connection did not fail.
+  [[nodiscard]] auto isRunning() const -> bool;
+
+  [[nodiscard]] auto getStatistics() const -> PipelineStatistics;
+
+private:
+  using Clock = std::chrono::steady_clock;
+
+  // NOLINTNEXTLINE(altera-struct-pack-align)
+  struct OutgoingMessage {
+    core::Item item;
+    std::string consumerName;
+  };
+
+  auto receiveLoop() -> void;
+
+  auto sendLoop() -> void;
+
+  /// Stop the pipeline because the connection failed with #status. Requires the lock.
+  auto fail(ReceiveStatus status) -> void;
+
+  /// Account the application time since the previous call of the application. Requires the lock.
+  auto enterApplicationCall(Clock::time_point now) -> void;
+
+  TcpConnection &connection;
+  std::size_t receiveQueueSize;
+  std::size_t sendQueueSize;
+  std::size_t maxTimeouts;
+
+  mutable std::mutex mutex{};
+  std::condition_variable receiveQueueFilled{};
+  std::condition_variable receiveQueueDrained{};
+  std::condition_variable sendQueueFilled{};
+  std::condition_variable sendQueueDrained{};
+
+  bool running{ false };
+  bool receiving{ false };
+  bool stopping{ false };
+
+  /// Status with which the connection failed; OK while it works.
+  ReceiveStatus status{ ReceiveStatus::OK };
+
+  std::deque<core::Item> receiveQueue{};
+  /// Items that were handed back by the application and are decoded into again.
+  std::vector<core::Item> spareItems{};
+  std::deque<OutgoingMessage> sendQueue{};
+
+  PipelineStatistics statistics{};
+  Clock::time_point applicationReturned{};
+  bool applicationActive{ false };
+
+  std::thread receiveThread{};
+  std::thread sendThread{};
+};
+
+}// namespace dataspree::inference
+
+#endif// DATASPREE_INFERENCE_PIPELINED_CONNECTION_HPP
@@ -0,0 +1,123 @@
+#ifndef DATASPREE_INFERENCE_TASK_HPP
+#define DATASPREE_INFERENCE_TASK_HPP
+
+#include <coroutine>
+#include <exception>
+#include <optional>
+#include <utility>
+
+namespace dataspree::inference {
+
+template<typename Result> struct Task;
+
+/// Promise state that is shared by all results.
+// NOLINTNEXTLINE(altera-struct-pack-align)
+struct TaskPromiseBase {
+
+  /// Resumes the coroutine that awaited the task once the task finished (symmetric transfer).
+  struct FinalAwaiter {
+    [[nodiscard]] static constexpr auto await_ready() noexcept -> bool { return false; }
+
+    template<typename Promise>
+    [[nodiscard]] static auto await_suspend(std::coroutine_handle<Promise> handle) noexcept -> std::coroutine_handle<> {
+      return handle.promise().continuation;
+    }
+
+    static constexpr auto await_resume() noexcept -> void {}
+  };
+
+  /// Tasks start once they are awaited.
+  [[nodiscard]] static constexpr auto initial_suspend() noexcept -> std::suspend_always { return {}; }
+
+  [[nodiscard]] static constexpr auto final_suspend() noexcept -> FinalAwaiter { return {}; }
+
+  auto unhandled_exception() noexcept -> void { this->exception = std::current_exception(); }
+
+  /// Rethrow the exception that escaped the coroutine.
+  auto rethrow() const -> void {
+    if (this->exception) { std::rethrow_exception(this->exception); }
+  }
+
+  std::coroutine_handle<> continuation{ std::noop_coroutine() };
+  std::exception_ptr exception{};
+};
+
+// NOLINTNEXTLINE(altera-struct-pack-align)
+template<typename Result> struct TaskPromise : TaskPromiseBase {
+  template<typename Value> auto return_value(Value &&value) -> void {
+    this->result.emplace(std::forward<Value>(value));
+  }
+
+  [[nodiscard]] auto get() -> Result {
+    this->rethrow();
+    return std::move(this->result).value();
+  }
+
+  std::optional<Result> result{};
+};
+
+// NOLINTNEXTLINE(altera-struct-pack-align)
+template<> struct TaskPromise<void> : TaskPromiseBase {
+  static constexpr auto return_void() noexcept -> void {}
+
+  auto get() const -> void { this->rethrow(); }
+};
+
+/// Coroutine that produces a #Result; it starts once it is awaited and resumes the awaiting coroutine when it
+/// finished. Exceptions are rethrown to the awaiting coroutine. Coroutines that are not awaited by another coroutine
+/// are started with EventLoop::spawn.
+template<typename Result = void> struct [[nodiscard]] Task final {
+
+  struct promise_type : TaskPromise<Result> {
+    [[nodiscard]] auto get_return_object() noexcept -> Task {
+      return Task{ std::coroutine_handle<promise_type>::from_promise(*this) };
+    }
+  };
+
+  using Handle = std::coroutine_handle<promise_type>;
+
+  // NOLINTNEXTLINE(altera-struct-pack-align)
+  struct Awaiter {
+    [[nodiscard]] auto await_ready() const noexcept -> bool { return !this->handle || this->handle.done(); }
+
+    [[nodiscard]] auto await_suspend(std::coroutine_handle<> continuation) const noexcept -> std::coroutine_handle<> {
+      this->handle.promise().continuation = continuation;
+      return this->handle;
+    }
+
+    auto await_resume() const -> Result { return this->handle.promise().get(); }
+
+    Handle handle;
+  };
+
+  Task() = default;
+
+  explicit Task(Handle handle) noexcept : handle(handle) {}
+
+  ~Task() {
+    if (this->handle) { this->handle.destroy(); }
+  }
+
+  Task(Task const &) = delete;
+  Task(Task &&other) noexcept : handle(std::exchange(other.handle, {})) {}
+  auto operator=(Task const &other) noexcept -> Task & = delete;
+  auto operator=(Task &&other) noexcept -> Task & {
+    if (this != &other) {
+      if (this->handle) { this->handle.destroy(); }
+      this->handle = std::exchange(other.handle, {});
+    }
+    return *this;
+  }
+
+  auto operator co_await() const noexcept -> Awaiter { return Awaiter{ this->handle }; }
+
+  /// \return true if the coroutine finished.
+  [[nodiscard]] inline auto done() const noexcept -> bool { return !this->handle || this->handle.done(); }
+
+private:
+  Handle handle{};
+};
+
+}// namespace dataspree::inference
+
+#endif// DATASPREE_INFERENCE_TASK_HPP
@@ -2,6 +2,7 @@
 #define DATASPREE_INFERENCE_CONNECTION_HPP
 
 #include <Conversion.hpp>
+#include <IoUring.hpp>
 
 #include <dataspree/inference/core/Item.hpp>
 #include <dataspree/inference/core/Utils.hpp>
@@ -9,14 +10,26 @@
 #include <spdlog/spdlog.h>
 
 #include <algorithm>
+#include <array>
+#include <atomic>
 #include <bit>
 #include <cassert>
+#include <condition_variable>
 #include <cstdio>
 #include <cstring>
+#include <deque>
 #include <iostream>
 #include <map>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <span>
 #include <sstream>
 #include <string>
+#include <string_view>
+#include <thread>
+#include <tuple>
+#include <utility>
 #include <vector>
 
 #include <chrono>
@@ -33,6 +46,49 @@ extern SocketType invalidSocket;
 
 namespace dataspree::inference {
 
+/// Outcome of receiving a message.
+enum class ReceiveStatus : uint8_t {
+  OK = 0,
+  /// No complete message arrived before the deadline; the connection is still usable.
+  TIMEOUT = 1,
+  /// The peer closed the connection (f.i., because the server restarted).
+  CLOSED = 2,
+  /// The socket failed or is not connected.
+  FAILED = 3,
+  /// Waiting was cancelled (see EventLoop::receiveItemAsync); the connection is still usable.
+  CANCELLED = 4
+};
+
+[[nodiscard]] constexpr auto toString(ReceiveStatus status) noexcept -> std::string_view {
+  switch (status) {
+  case ReceiveStatus::OK:
+    return "OK";
+  case ReceiveStatus::TIMEOUT:
+    return "Timeout";
+  case ReceiveStatus::CLOSED:
+    return "Connection closed";
+  case ReceiveStatus::CANCELLED:
+    return "Cancelled";
+  default:
+    return "Error";
+  }
+}
+
+/// Options of TcpConnection::sendItems and of the writer of the multi-producer mode.
+// NOLINTNEXTLINE(altera-struct-pack-align)
+struct BatchProperties {
+  /// Maximum number of items that are written with one call or sent in one envelope.
+  std::size_t maxBatchSize{ 64 };
+
+  /// Time that the writer of the multi-producer mode waits for more messages before it sends fewer than
+  /// #maxBatchSize; 0 sends right away.
+  std::chrono::microseconds linger{ 0 };
+
+  /// Send each batch of sendItems as a single message {"consumer_name", "items": [...]} instead of one message per
+  /// item. Requires a server that accepts it; images are only encoded for single items (see "encoded_elements").
+  bool envelope{ false };
+};
+
 // NOLINTNEXTLINE(altera-struct-pack-align)
 struct [[nodiscard]] TcpConnection final {
 
@@ -59,18 +115,43 @@ struct [[nodiscard]] TcpConnection final {
     _connect();
   }
 
-  /// Transmit an item to the specified consumer
+  /// Transmit an item to the specified consumer. In multi-producer mode (see setMultiProducer), this returns once the
+  /// message is queued; MAT_RAW images are sent from their pixels (see encodeMessage), which must not be overwritten
+  /// until the message is sent (see getNumberOfPendingSends).
   template<typename String, typename = std::enable_if_t<std::is_constructible_v<std::string, std::decay_t<String>>>>
-  auto sendItem(core::Item &item, String consumer_name) -> bool {
+  auto sendItem(core::Item const &item, String consumer_name) -> bool {
     core::Item messageItem{};
     messageItem["consumer_name"] = consumer_name;
     messageItem["item"] = item;
-    return this->sendMessageItem(messageItem);
+    return this->sendMessageItem(std::move(messageItem));
+  }
+
+  /// Transmit several items to the specified consumer with as few syscalls as possible: the messages of up to
+  /// BatchProperties::maxBatchSize items are written together (or sent as one envelope, see BatchProperties).
+  /// \return false if the connection failed; the items of earlier batches may have been sent.
+  template<typename String, typename = std::enable_if_t<std::is_constructible_v<std::string, std::decay_t<String>>>>
+  auto sendItems(std::span<core::Item const> items, String consumer_name) -> bool {
+    return this->sendItemBatches(items, std::string(std::move(consumer_name)));
+  }
+
+  /// Set the options of sendItems and of the writer of the multi-producer mode; must not overlap with sending.
+  inline auto setBatchProperties(BatchProperties properties) noexcept -> void {
+    properties.maxBatchSize = std::max<std::size_t>(properties.maxBatchSize, 1);
+    this->batchProperties = properties;
+  }
+
+  [[nodiscard]] inline auto getBatchProperties() const noexcept -> BatchProperties const & {
+    return this->batchProperties;
   }
 
   /// Send a message that updates the connection properties, which determine the format in which the Inference
   /// server replies.
+  /// \return false if the message could not be sent, or if the properties were not applied because they decode
+  ///         IMAGE_TILE_DELTA images while only the latest messages are received (see setLatestMessagesOnly).
   inline auto sendUpdateReceiveProperties(ReceiveProperties const updatedReceiveProperties) -> bool {
+    if (this->maxLatestMessages > 0 && updatedReceiveProperties.getDecodeProperties().tileDeltaDecoder != nullptr) {
+      return false;
+    }
     this->receiveProperties = updatedReceiveProperties;
     return this->sendUpdateReceiveProperties();
   }
@@ -80,8 +161,17 @@ struct [[nodiscard]] TcpConnection final {
   inline auto sendUpdateReceiveProperties() -> bool {
     if (!this->receiveProperties.isReceiveConfigured()) { return true; }
 
-    auto greetingItem = this->receiveProperties.toItem();
-    return this->sendMessageItem(greetingItem);
+    return this->sendMessageItem(this->receiveProperties.toItem());
+  }
+
+  /// Set the options that determine how images of sent messages are encoded (f.i., the encoded image cache, which
+  /// may be shared between connections, or the IMAGE_TILE_DELTA state).
+  inline auto setEncodeProperties(EncodeProperties properties) noexcept -> void {
+    this->encodeProperties = std::move(properties);
+  }
+
+  [[nodiscard]] inline auto getEncodeProperties() const noexcept -> EncodeProperties const & {
+    return this->encodeProperties;
   }
 
   [[nodiscard]] inline auto isReceiveConfigured() const noexcept -> bool {
@@ -89,15 +179,114 @@ struct [[nodiscard]] TcpConnection final {
   }
 
   /// Receive an item from the consumer specified int he connection properties.
+  /// \return std::nullopt if no message was received; see getReceiveStatus for the reason.
   auto receiveItem() noexcept -> std::optional<core::Item> {
-    if (auto &&[encodingMode, optionalBuffer] = this->receiveMessage();
-        optionalBuffer.has_value() && encodingMode.has_value()) {
-      return { decodeItem(optionalBuffer.value().data(), optionalBuffer.value().size(), encodingMode.value()) };
+    if (auto const [status, encodingMode, message] = this->receiveMessage(); status == ReceiveStatus::OK) {
+      return decodeItem(message.data(), message.size(), encodingMode, this->receiveProperties.getDecodeProperties());
     }
-    spdlog::warn("Timeout while receiving message for producer \"{}\"", this->receiveProperties.getProducerName());
     return std::nullopt;
   }
 
+  /// Receive the next item into #item, reusing the nodes of the previously received item (see decodeInto).
+  /// \return status of the receive; #item is left unchanged unless the status is OK.
+  auto receiveItemInto(core::Item &item) noexcept -> ReceiveStatus {
+    auto const [status, encodingMode, message] = this->receiveMessage();
+    if (status == ReceiveStatus::OK) {
+      decodeInto(item, message.data(), message.size(), encodingMode, this->receiveProperties.getDecodeProperties());
+    }
+    return status;
+  }
+
+  /// \return status of the last receive.
+  [[nodiscard]] inline auto getReceiveStatus() const noexcept -> ReceiveStatus { return this->receiveStatus; }
+
+  /// Receive on a background thread that drains the socket continuously and keeps only the newest #count complete
+  /// messages; older ones are dropped before they are decoded (see getNumberOfMessagesDropped). receiveItem and
+  /// receiveItemInto decode the oldest kept message, such that a consumer that is slower than the producer gets a
+  /// recent frame instead of an ever growing backlog in the socket buffer. The mode is kept when reconnecting.
+  /// Not available if the decode properties have a tileDeltaDecoder: an IMAGE_TILE_DELTA image only holds the tiles
+  /// that changed since the previous frame of its path, which would be lost with the dropped messages.
+  /// \param count 0 to receive on the calling thread again (default); kept messages are dropped.
+  /// \return false in non-blocking mode or with a tileDeltaDecoder, which do not support it.
+  auto setLatestMessagesOnly(std::size_t count) -> bool;
+
+  /// \return number of messages that are kept by the background receiver; 0 if it is not used.
+  [[nodiscard]] inline auto getLatestMessagesOnly() const noexcept -> std::size_t { return this->maxLatestMessages; }
+
+  /// Let any number of threads send over the connection: sendItem encodes the message on the calling thread and
+  /// appends it to a lock-free queue, from which a single writer thread sends whole frames (several per syscall), such
+  /// that the frames of different threads never interleave. The queued messages are sent before the connection is
+  /// closed; the mode is kept when reconnecting. Changing the mode and establishConnection must not overlap with
+  /// sendItem. Images with the IMAGE_TILE_DELTA encoding require that each path is sent by a single thread. MAT_RAW
+  /// images are not copied: the queued message shares the pixels of the image (like EventLoop::sendItem), such that
+  /// the caller must not overwrite them (f.i., by capturing into the same cv::Mat) until the message is sent; pass a
+  /// clone otherwise.
+  /// \param maxQueuedMessages number of queued messages beyond which sendItem blocks; 0 sends on the calling thread
+  ///        again (default) once the queued messages were sent.
+  /// \return false in non-blocking mode, which does not support it.
+  auto setMultiProducer(std::size_t maxQueuedMessages) -> bool;
+
+  /// \return maximum number of queued messages of the multi-producer mode; 0 if it is not used.
+  [[nodiscard]] inline auto getMultiProducer() const noexcept -> std::size_t { return this->maxProducerMessages; }
+
+  /// Receive and send over io_uring (Linux, see IoUring) instead of poll / read and sendmsg: data is received into
+  /// buffers that are registered with the kernel by a multishot receive, and the header and body of each frame are
+  /// sent as linked operations. Applies to the blocking paths (including the background threads of the other modes);
+  /// the mode is kept when reconnecting. Must not overlap with receiving or sending.
+  /// \param enable false to use the portable paths again (default).
+  /// \return false if io_uring is not available (in which case the portable paths are used) or in non-blocking mode.
+  auto setIoUring(bool enable) -> bool;
+
+  /// \return true if io_uring is used (see setIoUring).
+  [[nodiscard]] inline auto getIoUring() const noexcept -> bool { return this->ioUring; }
+
+  /// Switch the socket to non-blocking mode, in which the connection is driven by an event loop (see EventLoop):
+  /// sendItem queues messages that cannot be sent immediately and receiveAvailable only reads the data that has
+  /// arrived. Switching back to blocking mode sends the queued messages (blocking). Not available while only the
+  /// latest messages are received (see setLatestMessagesOnly), in multi-producer mode (see setMultiProducer) or with
+  /// io_uring (see setIoUring).
+  /// \return false if the mode could not be changed.
+  auto setNonBlocking(bool enable) -> bool;
+
+  [[nodiscard]] inline auto isNonBlocking() const noexcept -> bool { return this->nonBlocking; }
+
+  [[nodiscard]] inline auto getSocket() const noexcept -> SocketType { return this->fdSocket; }
+
+  /// Read the data that has arrived into the receive buffer (at most one syscall; for non-blocking mode).
+  /// \return OK if data was read or none is available; CLOSED or FAILED otherwise.
+  auto receiveAvailable() noexcept -> ReceiveStatus;
+
+  /// Decode the next completely buffered message into #item (see receiveItemInto) without reading from the socket.
+  /// \return false if no complete message is buffered.
+  auto receiveBufferedItemInto(core::Item &item) noexcept -> bool {
+    auto const message = this->takeBufferedMessage();
+    if (!message.has_value()) { return false; }
+
+    auto const &[encodingMode, payload] = message.value();
+    decodeInto(item, payload.data(), payload.size(), encodingMode, this->receiveProperties.getDecodeProperties());
+    return true;
+  }
+
+  /// Send as much of the queued messages as the socket accepts (without blocking in non-blocking mode).
+  /// \return false if the socket failed.
+  auto flushSendQueue() -> bool;
+
+  [[nodiscard]] inline auto hasPendingSends() const noexcept -> bool { return !this->sendQueue.empty(); }
+
+  /// \return number of queued messages that were not sent completely (of the non-blocking or the multi-producer mode).
+  [[nodiscard]] inline auto getNumberOfPendingSends() const noexcept -> std::size_t {
+    return this->sendQueue.size() + this->numberOfProducerMessages.load(std::memory_order_relaxed);
+  }
+
+  /// \return number of messages that were sent completely since the connection was established.
+  [[nodiscard]] inline auto getNumberOfMessagesSent() const noexcept -> std::size_t {
+    return this->numberOfMessagesSentSinceStart.load(std::memory_order_relaxed);
+  }
+
+  /// \return number of system calls with which the socket was polled, read and written since the connection was
+  ///         established (an io_uring_enter counts as one call); to compare the transports.
+  [[nodiscard]] auto getNumberOfSocketCalls() const noexcept -> uint64_t;
+
   [[nodiscard]] inline auto getFramerateReceived() const noexcept {
     auto const finish = std::chrono::steady_clock::now();
     auto const elapsedSeconds =
@@ -105,71 +294,221 @@ struct [[nodiscard]] TcpConnection final {
     return std::tuple{ static_cast<double>(numberOfMessagesReceived) / elapsedSeconds, finish };
   }
 
+  /// \return number of received messages that were dropped without decoding since the connection was established,
+  ///         because newer messages arrived before they were taken (see setLatestMessagesOnly).
+  [[nodiscard]] inline auto getNumberOfMessagesDropped() const noexcept -> std::size_t {
+    return this->numberOfMessagesDroppedSinceStart.load(std::memory_order_relaxed);
+  }
+
   [[nodiscard]] inline auto getFramerateSent() const noexcept {
     auto const finish = std::chrono::steady_clock::now();
     auto const elapsedSeconds =
-      std::chrono::duration_cast<std::chrono::duration<double>>(finish - this->timeSent).count();
-    return std::tuple{ static_cast<double>(numberOfMessagesSent) / elapsedSeconds, finish };
+      std::chrono::duration_cast<std::chrono::duration<double>>(finish - this->timeSent.load()).count();
+    return std::tuple{ static_cast<double>(numberOfMessagesSent.load()) / elapsedSeconds, finish };
   }
 
 private:
 
-  /// Receive an encoded message via the socket.
+  /// Receive an encoded message via the socket; waits at most timeoutMs for the whole message (0: no timeout).
+  /// \return status, encoding and payload of the message; the payload points into the receive buffer and is only
+  ///         valid until the next message is received.
   [[nodiscard]] auto receiveMessage() const noexcept
-    -> std::pair<std::optional<EncodingMode>, std::optional<std::vector<char>>> {
-    // Unsigned int 4,  big endian
-    std::optional<std::vector<char>> sizeBuffer = receiveNumberOfBytes(4);
-    if (!sizeBuffer.has_value()) {
-      spdlog::warn("Error receiving message (part 1: size).");
-      return std::make_pair(std::nullopt, std::nullopt);
+    -> std::tuple<ReceiveStatus, EncodingMode, std::span<char const>> {
+    auto const deadline = this->timeoutMs > 0 ? std::optional(std::chrono::steady_clock::now()
+                                                              + std::chrono::milliseconds(this->timeoutMs))
+                                              : std::nullopt;
+
+    if (this->latestMessages.receiver.joinable()) {
+      auto message = this->takeLatestMessage(deadline);
+      if (this->receiveStatus != ReceiveStatus::OK) { this->warnReceiveFailure("latest messages"); }
+      return message;
     }
-    assert(sizeBuffer->size() == 4);
-    auto const messageSize = core::readBigEndian<uint32_t>(sizeBuffer.value().data());
 
-    std::optional<std::vector<char>> encodingModeBuffer = receiveNumberOfBytes(1);
-    if (!encodingModeBuffer.has_value()) {
-      spdlog::warn("Error receiving message (part 2: encoding).");
-      return std::make_pair(std::nullopt, std::nullopt);
+    // Size (unsigned int 4, big endian) and encoding (1 byte); only consumed once the whole message is buffered, such
+    // that a message that is interrupted by a timeout is resumed by the next call.
+    this->receiveStatus = fillReceiveBuffer(frameHeaderSize, deadline);
+    if (this->receiveStatus != ReceiveStatus::OK) {
+      this->warnReceiveFailure("part 1: header");
+      return { this->receiveStatus, EncodingMode{}, {} };
     }
-    assert(encodingModeBuffer->size() == 1);
-    auto const encodingMode = core::readBigEndian<uint8_t>(encodingModeBuffer.value().data());
+    auto const messageSize = this->bufferedMessageSize();
 
-    std::optional<std::vector<char>> message = receiveNumberOfBytes(messageSize);
-    if (!message.has_value()) {
-      spdlog::warn("Error receiving message (part 3: data).");
-      return std::make_pair(std::nullopt, std::nullopt);
+    this->receiveStatus = fillReceiveBuffer(frameHeaderSize + messageSize, deadline);
+    if (this->receiveStatus != ReceiveStatus::OK) {
+      this->warnReceiveFailure("part 2: data");
+      return { this->receiveStatus, EncodingMode{}, {} };
     }
 
-    ++this->numberOfMessagesReceivedSinceStart;
-    if (++this->numberOfMessagesReceived % 100 == 0) {
-      auto const [framerate, now] = this->getFramerateReceived();
-      spdlog::debug("Received message #{} of size {}; {}fps {}ms.",
-        numberOfMessagesReceivedSinceStart,
-        messageSize,
-        framerate,
-        1000 / framerate);
-
-      this->numberOfMessagesReceived = 0;
-      this->timeReceived = now;
-    } else {
-      spdlog::debug("Received message #{} of size {}.", numberOfMessagesReceivedSinceStart, messageSize);
-    }
+    auto const [encodingMode, message] = this->takeBufferedMessage().value();
+    return { ReceiveStatus::OK, encodingMode, message };
+  }
+
+  /// \return size of the message whose header is buffered at receiveBegin.
+  [[nodiscard]] auto bufferedMessageSize() const noexcept -> uint32_t {
+    // readBigEndian swaps in place; the header is read from a copy, as it is read again until the message is complete.
+    std::array<char, sizeof(uint32_t)> messageSizeChunk{};
+    std::memcpy(messageSizeChunk.data(), &this->receiveBuffer[this->receiveBegin], messageSizeChunk.size());
+    return core::readBigEndian<uint32_t>(messageSizeChunk.data());
+  }
+
+  /// Consume the next message if it is completely buffered.
+  /// \return encoding and payload of the message (see receiveMessage).
+  [[nodiscard]] auto takeBufferedMessage() const noexcept
+    -> std::optional<std::pair<EncodingMode, std::span<char const>>> {
+    auto message = this->takeBufferedFrame();
+    if (message.has_value()) { this->countReceivedMessage(message->second.size()); }
+    return message;
+  }
 
+  /// Consume the next message if it is completely buffered, without counting it as received.
+  [[nodiscard]] auto takeBufferedFrame() const noexcept
+    -> std::optional<std::pair<EncodingMode, std::span<char const>>> {
+    if (this->receiveEnd - this->receiveBegin < frameHeaderSize) { return std::nullopt; }
+    auto const messageSize = this->bufferedMessageSize();
+    auto const encodingMode = core::readBigEndian<uint8_t>(&this->receiveBuffer[this->receiveBegin + 4]);
+    if (this->receiveEnd - this->receiveBegin < frameHeaderSize + messageSize) { return std::nullopt; }
+
+    auto const message = std::span<char const>(&this->receiveBuffer[this->receiveBegin + frameHeaderSize], messageSize);
+    this->receiveBegin += frameHeaderSize + messageSize;
     return std::make_pair(static_cast<EncodingMode>(encodingMode), message);
   }
 
-  /// Read exact number of required bytes from socket.
-  [[nodiscard]] auto receiveNumberOfBytes(std::size_t const number_required_bytes) const noexcept
-    -> std::optional<std::vector<char>>;
+  /// Update the statistics of received messages.
+  auto countReceivedMessage(std::size_t size) const noexcept -> void;
+
+  /// Body of the background receiver (see setLatestMessagesOnly): read messages and keep the newest of them.
+  auto receiveLatestMessages() const noexcept -> void;
+
+  /// Take the oldest message that the background receiver kept; waits until #deadline for one.
+  /// \return see receiveMessage.
+  [[nodiscard]] auto takeLatestMessage(std::optional<std::chrono::steady_clock::time_point> deadline) const noexcept
+    -> std::tuple<ReceiveStatus, EncodingMode, std::span<char const>>;
+
+  auto startLatestMessagesReceiver() -> void;
+
+  /// Join the background receiver and drop the messages that it kept.
+  auto stopLatestMessagesReceiver() -> void;
+
+  inline auto warnReceiveFailure(std::string_view part) const -> void {
+    spdlog::warn("{} while receiving message ({}) for producer \"{}\".",
+      toString(this->receiveStatus),
+      part,
+      this->receiveProperties.getProducerName());
+  }
 
-  auto sendMessageItem(core::Item &messageItem) -> bool {
+  /// Read from the socket until the receive buffer holds at least #numberRequiredBytes unconsumed bytes. Every read
+  /// fills as much of the buffer as is available, such that a batch of small messages costs a single syscall.
+  /// Waits for data with poll, such that a closed connection is detected immediately.
+  /// \param deadline time at which TIMEOUT is returned; wait indefinitely if not set.
+  [[nodiscard]] auto fillReceiveBuffer(std::size_t numberRequiredBytes,
+    std::optional<std::chrono::steady_clock::time_point> deadline) const noexcept -> ReceiveStatus;
+
+  /// Make room for #numberRequiredBytes unconsumed bytes behind receiveBegin.
+  [[nodiscard]] auto reserveReceiveBuffer(std::size_t numberRequiredBytes) const noexcept -> bool;
+
+  auto sendMessageItem(core::Item messageItem) -> bool {
     if (!connected()) { return false; }
+    if (this->nonBlocking) { return this->queueMessageItem(std::move(messageItem)); }
+    if (this->producerWriter.joinable()) { return this->enqueueProducerMessage(std::move(messageItem)); }
+
+    auto const message =
+      encodeMessage(messageItem, this->receiveProperties.getEncodingMode(), "", this->encodeProperties);
+    return this->sendData(message.segments);
+  }
+
+  /// Send #items to #consumerName in batches (see sendItems).
+  auto sendItemBatches(std::span<core::Item const> items, std::string const &consumerName) -> bool;
+
+  /// Send the messages of #items to #consumerName, written together.
+  auto sendMessageItems(std::span<core::Item const> items, std::string const &consumerName) -> bool;
+
+  /// Send the frame header (size and encoding) and the #segments of a message with as few syscalls as possible
+  /// (usually one sendmsg / WSASend); partial writes are resumed at the first unsent byte.
+  auto sendData(std::span<std::span<char const> const> segments) const -> bool;
+
+  /// Encode #messageItem, append it to the send queue and send as much of the queue as possible.
+  auto queueMessageItem(core::Item &&messageItem) -> bool {
+    this->appendMessageItem(std::move(messageItem));
+    return this->flushSendQueue();
+  }
 
-    auto buffer = encodeItem(messageItem, this->receiveProperties.getEncodingMode());
-    return this->sendData(buffer.get(), buffer.size());
+  /// Encode #messageItem and append it to the send queue.
+  auto appendMessageItem(core::Item &&messageItem) -> void;
+
+  /// Size of the frame header: size of the message (unsigned int 4, big endian) and encoding (1 byte).
+  static constexpr std::size_t frameHeaderSize = 5;
+
+  /// Minimum capacity of the receive buffer.
+  static constexpr std::size_t minReceiveBufferSize = std::size_t{ 64 } << 10U;
+
+  [[nodiscard]] auto frameHeader(std::size_t messageSize) const -> std::array<char, frameHeaderSize>;
+
+  /// Update the statistics of sent messages.
+  auto countSentMessage(std::size_t size) const -> void;
+
+  /// Message that is sent in parts (in non-blocking mode, in batches and in multi-producer mode); it must stay in
+  /// place once it is encoded.
+  // NOLINTNEXTLINE(altera-struct-pack-align)
+  struct PendingMessage {
+    /// The encoded message may refer to the content of the item.
+    core::Item messageItem;
+    EncodedMessage message{};
+    std::size_t size{ 0 };
+    std::array<char, frameHeaderSize> header{};
+    /// Number of bytes (including the header) that were sent already.
+    std::size_t sent{ 0 };
+  };
+
+  /// Encode the item of #pending and derive the frame header.
+  auto encodePendingMessage(PendingMessage &pending) const -> void;
+
+  /// Message in the queue of the multi-producer mode.
+  // NOLINTNEXTLINE(altera-struct-pack-align)
+  struct ProducerMessage {
+    PendingMessage pending;
+    /// Message that was queued before.
+    ProducerMessage *next{ nullptr };
+    /// Marks the end of the queue (see stopProducerWriter).
+    bool last{ false };
+  };
+
+  /// Encode #messageItem on the calling thread and append it to the queue of the writer thread.
+  /// \return false if the writer failed to send earlier messages.
+  auto enqueueProducerMessage(core::Item &&messageItem) -> bool;
+
+  /// Append #message to the queue (lock-free).
+  auto pushProducerMessage(ProducerMessage *message) noexcept -> void;
+
+  /// Body of the writer thread: send the queued messages in batches until the end of the queue.
+  auto writeProducerMessages() -> void;
+
+  /// Wait up to the linger time until a full batch is queued (see BatchProperties).
+  auto lingerForProducerMessages() const -> void;
+
+  /// Send the frames of #messages in order, several per syscall (blocking).
+  auto sendPendingMessages(std::span<PendingMessage *const> messages) const -> bool;
+
+  auto startProducerWriter() -> void;
+
+  /// Send the queued messages and join the writer thread.
+  auto stopProducerWriter() -> void;
+
+  /// Create the rings of the io_uring mode (see setIoUring); without them, the portable paths are used.
+  auto startIoUring() -> void;
+
+  /// Release the rings; their system calls are added to numberOfSocketCalls.
+  auto stopIoUring() -> void;
+
+  /// \return deadline of a blocking send (see timeoutMs).
+  [[nodiscard]] inline auto sendDeadline() const noexcept -> std::optional<std::chrono::steady_clock::time_point> {
+    return this->timeoutMs > 0
+             ? std::optional(std::chrono::steady_clock::now() + std::chrono::milliseconds(this->timeoutMs))
+             : std::nullopt;
   }
 
-  auto sendData(char const *data, std::size_t size) const -> bool;
+  inline auto countSocketCall() const noexcept -> void {
+    this->numberOfSocketCalls.fetch_add(1, std::memory_order_relaxed);
+  }
 
   [[nodiscard]] auto socketConnected() const noexcept -> bool;
 
@@ -183,15 +522,72 @@ private:
   uint16_t remotePort;
   ReceiveProperties receiveProperties;
   std::size_t timeoutMs;
+  EncodeProperties encodeProperties{};
+  BatchProperties batchProperties{};
 
   SocketType fdSocket{invalidSocket};
   int fdClient{ -1 };
 
+  /// Received bytes; the unconsumed ones are [receiveBegin, receiveEnd).
+  mutable std::vector<char> receiveBuffer{};
+  mutable std::size_t receiveBegin{ 0 };
+  mutable std::size_t receiveEnd{ 0 };
+  mutable ReceiveStatus receiveStatus{ ReceiveStatus::OK };
+
+  bool nonBlocking{ false };
+  std::deque<PendingMessage> sendQueue{};
+
+  /// State that the background receiver shares with the receiving thread (see setLatestMessagesOnly).
+  // NOLINTNEXTLINE(altera-struct-pack-align)
+  struct LatestMessages {
+    std::mutex mutex{};
+    std::condition_variable received{};
+    /// Kept messages (encoding and payload), oldest first.
+    std::deque<std::pair<EncodingMode, std::vector<char>>> messages{};
+    /// Payload buffers of taken or dropped messages for reuse.
+    std::vector<std::vector<char>> spareBuffers{};
+    /// Status with which the receiver stopped; OK while it runs.
+    ReceiveStatus status{ ReceiveStatus::OK };
+    bool stopping{ false };
+    std::thread receiver{};
+  };
+
+  /// Interval at which the background receiver checks whether it stops.
+  static constexpr std::chrono::milliseconds latestMessagesPollInterval{ 100 };
+
+  std::size_t maxLatestMessages{ 0 };
+  mutable LatestMessages latestMessages{};
+  /// Payload of the message that was taken last (see receiveMessage).
+  mutable std::vector<char> latestMessage{};
+
+  std::size_t maxProducerMessages{ 0 };
+  /// Newest queued message of the multi-producer mode, which links to the older ones.
+  std::atomic<ProducerMessage *> producerMessages{ nullptr };
+  /// Number of queued messages that were not sent yet.
+  std::atomic<std::size_t> numberOfProducerMessages{ 0 };
+  std::atomic<bool> producerWriterFailed{ false };
+  std::thread producerWriter{};
+
+  /// Entries of the submission queue of the send ring; two per frame.
+  static constexpr unsigned ioUringSendEntries{ 256 };
+  /// Provided buffers of the receive ring (1 MiB).
+  static constexpr std::size_t ioUringReceiveBuffers{ 16 };
+  static constexpr std::size_t ioUringReceiveBufferSize{ std::size_t{ 64 } << 10U };
+
+  bool ioUring{ false };
+  /// Rings of the io_uring mode; nullptr if it is not used (or not available).
+  std::unique_ptr<IoUring> receiveRing{};
+  std::unique_ptr<IoUring> sendRing{};
+
   mutable std::size_t numberOfMessagesReceived = 0;
-  mutable std::size_t numberOfMessagesSent = 0;
+  /// Updated by the writer thread of the multi-producer mode and read by the producers.
+  mutable std::atomic<std::size_t> numberOfMessagesSent{ 0 };
   mutable std::size_t numberOfMessagesReceivedSinceStart = 0;
-  mutable std::size_t numberOfMessagesSentSinceStart = 0;
-  mutable std::chrono::steady_clock::time_point timeSent{};
+  mutable std::atomic<std::size_t> numberOfMessagesSentSinceStart{ 0 };
+  mutable std::atomic<std::size_t> numberOfMessagesDroppedSinceStart{ 0 };
+  mutable std::atomic<std::chrono::steady_clock::time_point> timeSent{};
+  /// System calls of the portable paths and of released rings (see getNumberOfSocketCalls).
+  mutable std::atomic<uint64_t> numberOfSocketCalls{ 0 };
   mutable std::chrono::steady_clock::time_point timeReceived{};
 };
 
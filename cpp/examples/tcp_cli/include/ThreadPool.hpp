@@ -0,0 +1,88 @@
+#ifndef DATASPREE_INFERENCE_THREAD_POOL_HPP
+#define DATASPREE_INFERENCE_THREAD_POOL_HPP
+
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+namespace dataspree::inference {
+
+/// Fixed-size set of worker threads that execute submitted tasks in submission order.
+// NOLINTNEXTLINE(altera-struct-pack-align)
+struct [[nodiscard]] ThreadPool final {
+
+  /// Start the workers.
+  /// \param numberOfThreads number of workers; at least one worker is started.
+  explicit ThreadPool(std::size_t numberOfThreads = std::thread::hardware_concurrency());
+
+  /// Finish all queued tasks and join the workers.
+  ~ThreadPool();
+
+  ThreadPool(ThreadPool const &) = delete;
+  ThreadPool(ThreadPool &&) = delete;
+  auto operator=(ThreadPool const &other) noexcept -> ThreadPool & = delete;
+  auto operator=(ThreadPool &&other) noexcept -> ThreadPool & = delete;
+
+  /// Queue a task for execution on one of the workers.
+  /// \return future that holds the result of the task (or the exception it threw).
+  template<typename Function> auto submit(Function &&function) -> std::future<std::invoke_result_t<Function>> {
+    using ResultType = std::invoke_result_t<Function>;
+
+    // std::function requires copyable targets; std::packaged_task is move-only.
+    auto task = std::make_shared<std::packaged_task<ResultType()>>(std::forward<Function>(function));
+    auto future = task->get_future();
+    {
+      std::scoped_lock const lock(this->mutex);
+      this->tasks.emplace_back([task]() { (*task)(); });
+    }
+    this->condition.notify_one();
+    return future;
+  }
+
+  /// \return number of workers.
+  [[nodiscard]] inline auto size() const noexcept -> std::size_t { return this->workers.size(); }
+
+private:
+  auto work() -> void;
+
+  std::mutex mutex{};
+  std::condition_variable condition{};
+  std::deque<std::function<void()>> tasks{};
+  bool stopping{ false };
+
+  std::vector<std::thread> workers{};
+};
+
+/// Waits for all #futures when it goes out of scope, such that tasks that reference local data never outlive it (f.i.,
+/// if a later ThreadPool::submit throws while the earlier tasks still run).
+// NOLINTNEXTLINE(altera-struct-pack-align)
+template<typename T> struct [[nodiscard]] WaitGuard final {
+
+  explicit WaitGuard(std::vector<std::future<T>> &futures) noexcept : futures(futures) {}
+
+  ~WaitGuard() {
+    // NOLINTNEXTLINE(altera-unroll-loops)
+    for (auto const &future : this->futures) {
+      if (future.valid()) { future.wait(); }
+    }
+  }
+
+  WaitGuard(WaitGuard const &) = delete;
+  WaitGuard(WaitGuard &&) = delete;
+  auto operator=(WaitGuard const &other) noexcept -> WaitGuard & = delete;
+  auto operator=(WaitGuard &&other) noexcept -> WaitGuard & = delete;
+
+private:
+  std::vector<std::future<T>> &futures;
+};
+
+}// namespace dataspree::inference
+
+#endif// DATASPREE_INFERENCE_THREAD_POOL_HPP
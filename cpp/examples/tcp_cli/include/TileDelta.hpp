@@ -0,0 +1,90 @@
+#ifndef DATASPREE_INFERENCE_TILE_DELTA_HPP
+#define DATASPREE_INFERENCE_TILE_DELTA_HPP
+
+#include <opencv2/core/mat.hpp>
+
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <mutex>
+#include <optional>
+#include <span>
+#include <string>
+#include <vector>
+
+namespace dataspree::inference {
+
+/// Parameters of the IMAGE_TILE_DELTA encoding.
+// NOLINTNEXTLINE(altera-struct-pack-align)
+struct TileDeltaProperties {
+
+  /// Edge length of the square tiles in pixels.
+  int tileSize = 64;
+
+  /// A tile is transmitted if any of its 8-bit values differs by more than this from the frame that the receiver
+  /// holds. 0 transmits every change (lossless). Images with a depth other than 8 bit are always compared exactly.
+  int threshold = 0;
+
+  /// Transmit all tiles every #keyframeInterval frames so that receivers (re-)synchronize; 0 disables periodic
+  /// keyframes (keyframes are still sent for the first frame and whenever size or type change).
+  std::size_t keyframeInterval = 30;
+};
+
+/// Sender side of the IMAGE_TILE_DELTA encoding.
+///
+/// Splits each frame into tiles and only transmits the tiles that changed compared to the frame the receiver
+/// reconstructed from the previously sent frame on the same path. The payload consists of a header followed by the
+/// raw content of each transmitted tile.
+// NOLINTNEXTLINE(altera-struct-pack-align)
+struct [[nodiscard]] TileDeltaEncoder final {
+
+  explicit TileDeltaEncoder(TileDeltaProperties properties = {}) : properties(properties) {}
+
+  /// Encode #image relative to the last frame encoded for #path.
+  /// \return payload; empty if the image could not be encoded.
+  [[nodiscard]] auto encode(std::string const &path, cv::Mat const &image) -> std::vector<unsigned char>;
+
+  /// Transmit full frames on every path next time (f.i., after a reconnect).
+  auto requestKeyframe() -> void;
+
+private:
+  // NOLINTNEXTLINE(altera-struct-pack-align)
+  struct Reference {
+    /// Frame as reconstructed by the receiver.
+    cv::Mat frame;
+    uint64_t sequence{ 0 };
+    std::size_t framesSinceKeyframe{ 0 };
+  };
+
+  TileDeltaProperties properties;
+
+  std::mutex mutex{};
+  std::map<std::string, Reference> references{};
+};
+
+/// Receiver side of the IMAGE_TILE_DELTA encoding; reconstructs full frames per path.
+// NOLINTNEXTLINE(altera-struct-pack-align)
+struct [[nodiscard]] TileDeltaDecoder final {
+
+  /// Apply the payload to the last frame decoded for #path.
+  /// \return the reconstructed frame, or std::nullopt if the payload is malformed or refers to a frame that was not
+  ///         received (decoding resumes with the next keyframe).
+  [[nodiscard]] auto decode(std::string const &path, std::span<unsigned char const> payload) -> std::optional<cv::Mat>;
+
+  /// Forget all reconstructed frames.
+  auto reset() -> void;
+
+private:
+  // NOLINTNEXTLINE(altera-struct-pack-align)
+  struct Reference {
+    cv::Mat frame;
+    uint64_t sequence{ 0 };
+  };
+
+  std::mutex mutex{};
+  std::map<std::string, Reference> references{};
+};
+
+}// namespace dataspree::inference
+
+#endif// DATASPREE_INFERENCE_TILE_DELTA_HPP
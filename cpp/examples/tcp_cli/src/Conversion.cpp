@@ -1,4 +1,6 @@
 #include <Conversion.hpp>
+#include <FrameBufferPool.hpp>
+#include <HalfFloat.hpp>
 
 #include <dataspree/inference/core/Utils.hpp>
 #include <dataspree/inference/core/Item.hpp>
@@ -13,6 +15,18 @@
 #include <opencv2/imgcodecs.hpp>
 #include <opencv2/imgproc.hpp>
 
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cmath>
+#include <deque>
+#include <future>
+#include <iterator>
+#include <memory>
+#include <optional>
+#include <span>
+#include <unordered_map>
+
 using json = nlohmann::json;
 
 template<typename T> struct TempAppend;
@@ -21,38 +35,63 @@ template<typename T> struct TempAppend;
   std::string const &encoding,
   dataspree::inference::EncodingMode encodingMode) -> dataspree::inference::core::Item;
 
-[[nodiscard]] auto item_to_msgpack(dataspree::inference::core::Item &item, std::string preferredImageEncoding)
-  -> msgpack::sbuffer;
+struct EncodeContext;
+
+/// Payloads that a segmented MSGPACK message refers to instead of copying them.
+// NOLINTNEXTLINE(altera-struct-pack-align)
+struct RetainedPayloads {
+  /// Payloads that were encoded for the message (and its images).
+  std::deque<dataspree::inference::core::Item> owned{};
+
+  /// Payloads that are shared with the image cache.
+  std::vector<std::shared_ptr<dataspree::inference::core::Item const>> shared{};
+};
+
+template<typename Stream>
+auto item_to_msgpack(dataspree::inference::core::Item const &item,
+  Stream &stream,
+  std::string preferredImageEncoding,
+  dataspree::inference::EncodeProperties const &encodeProperties,
+  RetainedPayloads *payloads = nullptr) -> void;
 
-auto item_to_msgpack(dataspree::inference::core::Item &item,
-  msgpack::packer<msgpack::sbuffer> &packer,
+template<typename Stream>
+auto item_to_msgpack(dataspree::inference::core::Item const &item,
+  msgpack::packer<Stream> &packer,
   TempAppend<std::string> const &path,
-  dataspree::inference::core::Item &rootItem,
-  std::string preferredImageEncoding) -> void;
-auto msgpack_to_item(dataspree::inference::core::Item &rootItem, msgpack::v3::object const &root_result) -> void;
+  EncodeContext &context) -> void;
+struct ParseContext;
 
-[[nodiscard]] auto item_to_json(dataspree::inference::core::Item &item, std::string preferredImageEncoding) -> json;
+auto msgpack_to_item(dataspree::inference::core::Item &rootItem,
+  msgpack::v3::object const &root_result,
+  ParseContext *context = nullptr) -> void;
 
-auto item_to_json(dataspree::inference::core::Item &item,
+[[nodiscard]] auto item_to_json(dataspree::inference::core::Item const &item,
+  std::string preferredImageEncoding,
+  dataspree::inference::EncodeProperties const &encodeProperties) -> json;
+
+auto item_to_json(dataspree::inference::core::Item const &item,
   json &json_object,
   TempAppend<std::string> const &path,
-  dataspree::inference::core::Item &rootItem,
-  std::string preferredImageEncoding) -> void;
-auto json_to_item(dataspree::inference::core::Item &rootItem, json const &root_result) -> void;
+  EncodeContext &context) -> void;
+auto json_to_item(dataspree::inference::core::Item &rootItem, json const &root_result, ParseContext *context = nullptr)
+  -> void;
 
 [[nodiscard]] auto base64_decode(std::string const &src) -> std::vector<char>;
 
 [[nodiscard]] auto base64_encode(std::vector<unsigned char> const &src) -> std::vector<char>;
 
-auto dataspree::inference::encodeItem(core::Item &item, EncodingMode encodingMode, std::string preferredImageEncoding)
-  -> Buffer {
+auto dataspree::inference::encodeItem(core::Item const &item,
+  EncodingMode encodingMode,
+  std::string preferredImageEncoding,
+  EncodeProperties const &encodeProperties) -> Buffer {
   switch (encodingMode) {
   case EncodingMode::MSGPACK: {
-    auto msg = item_to_msgpack(item, preferredImageEncoding);
+    msgpack::sbuffer msg;
+    item_to_msgpack(item, msg, std::move(preferredImageEncoding), encodeProperties);
     return Buffer{ std::move(msg) };
   }
   case EncodingMode::JSON: {
-    auto json_root = item_to_json(item, preferredImageEncoding);
+    auto json_root = item_to_json(item, preferredImageEncoding, encodeProperties);
     auto msg = json_root.dump();
     return Buffer{ std::move(msg) };
   }
@@ -62,6 +101,41 @@ auto dataspree::inference::encodeItem(core::Item &item, EncodingMode encodingMod
   }
 }
 
+/// Payloads of at least this size are referenced by segmented messages instead of being copied; smaller ones are
+/// gathered into chunks, which keeps the number of segments (and of iovecs) per message low.
+static constexpr std::size_t minReferencedSize = 4096;
+
+/// Memory of a segmented MSGPACK message.
+// NOLINTNEXTLINE(altera-struct-pack-align)
+struct SegmentedMessage {
+  msgpack::vrefbuffer buffer{ minReferencedSize };
+
+  /// Encoded payloads (and images) that the buffer refers to.
+  RetainedPayloads payloads{};
+};
+
+auto dataspree::inference::encodeMessage(core::Item const &item,
+  EncodingMode encodingMode,
+  std::string preferredImageEncoding,
+  EncodeProperties const &encodeProperties) -> EncodedMessage {
+  if (encodingMode != EncodingMode::MSGPACK) {
+    auto message =
+      std::make_shared<Buffer>(encodeItem(item, encodingMode, std::move(preferredImageEncoding), encodeProperties));
+    return { .storage = message, .segments = { std::span<char const>(message->get(), message->size()) } };
+  }
+
+  auto message = std::make_shared<SegmentedMessage>();
+  item_to_msgpack(item, message->buffer, std::move(preferredImageEncoding), encodeProperties, &message->payloads);
+
+  std::vector<std::span<char const>> segments{};
+  segments.reserve(message->buffer.vector_size());
+  // NOLINTNEXTLINE(altera-unroll-loops)
+  for (auto const &segment : std::span(message->buffer.vector(), message->buffer.vector_size())) {
+    segments.emplace_back(static_cast<char const *>(segment.iov_base), segment.iov_len);
+  }
+  return { .storage = std::move(message), .segments = std::move(segments) };
+}
+
 auto opencvToNumpy(int depth) -> char {
   switch (depth) {
   case CV_8U:
@@ -76,11 +150,11 @@ auto opencvToNumpy(int depth) -> char {
   case CV_32S:
     return 'i';
 
+  case CV_16F:
+    [[fallthrough]];
   case CV_32F:
     [[fallthrough]];
   case CV_64F:
-  //  [[fallthrough]];
-  //case CV_16F:
     return 'f';
 
   default:
@@ -118,8 +192,8 @@ auto numpyToOpencv(char kind, uint8_t size, uint64_t channels) -> std::pair<std:
 
   case 'f':
     switch (size) {
-    //case 2:
-    //  return { CV_MAKETYPE(cv::DataType<cv::float16_t>::type, channels), sizeof(float) };
+    case 2:
+      return { CV_MAKETYPE(CV_16F, channels), sizeof(uint16_t) };
     case 4:
       return { CV_MAKETYPE(cv::DataType<float>::type, channels), sizeof(float) };
     case 8:
@@ -133,23 +207,1236 @@ auto numpyToOpencv(char kind, uint8_t size, uint64_t channels) -> std::pair<std:
   }
 }
 
+// MAT_RAW payload layout (all integers little endian):
+//   numpy kind (char) | element size (u8) | rank (u64) | shape (rank x u64) | data (C order, little endian)
+// Mats are written with their sizes, followed by the number of channels (f.i., (rows, cols, channels) for 2-D
+// images). When decoding, rank 1 and 2 yield single-channel 2-D images and higher ranks yield mats of rank - 1
+// dimensions whose channels are the last axis; if that exceeds CV_CN_MAX, a single-channel N-D mat of all axes.
+
+/// Size of the MAT_RAW header up to (and including) the rank.
+static constexpr std::size_t matRawRankSize = 2 + sizeof(uint64_t);
+
+/// Size of the header that precedes the MAT_RAW payload of MAT_RAW_Q8 / MAT_RAW_Q16: scale and offset (f64), such
+/// that value = quantized * scale + offset.
+static constexpr std::size_t matRawQuantizedHeaderSize = sizeof(double) * 2;
+
+template<typename T> [[nodiscard]] static auto fromLittleEndian(unsigned char const *bytes) -> T {
+  std::array<unsigned char, sizeof(T)> memory{};
+  std::memcpy(memory.data(), bytes, sizeof(T));
+  if constexpr (dataspree::inference::core::isBigEndian) { std::ranges::reverse(memory); }
+  return std::bit_cast<T>(memory);
+}
+
+/// \return empty image whose buffer is allocated from the frame buffer pool.
+[[nodiscard]] auto pooledMat() -> cv::Mat { return dataspree::inference::FrameBufferPool::instance().mat(); }
+
+/// \return image with uninitialized content whose buffer is allocated from the frame buffer pool.
+[[nodiscard]] auto pooledMat(int dims, int const *sizes, int type) -> cv::Mat {
+  return dataspree::inference::FrameBufferPool::instance().mat(dims, sizes, type);
+}
+
+/// \return the conversion code that swaps the red and the blue channel of #image or std::nullopt if #image is no
+///         3- or 4-channel 2-D image.
+[[nodiscard]] auto swapRedBlueCode(cv::Mat const &image) -> std::optional<int> {
+  if (image.dims != 2) { return std::nullopt; }
+  switch (image.channels()) {
+  case 3:
+    return cv::COLOR_RGB2BGR;
+  case 4:
+    return cv::COLOR_RGBA2BGRA;
+  default:
+    return std::nullopt;
+  }
+}
+
+/// Swap the red and the blue channel of #image into #target (MAT_RAW payloads are RGB(A), images BGR(A)).
+/// \param target is written in place if it has the size and type of #image (f.i., a header over a payload).
+auto swapRedBlue(cv::Mat const &image, cv::Mat &target) -> void {
+  auto const code = swapRedBlueCode(image);
+  if (!code.has_value()) {
+    image.copyTo(target);
+
+  } else if (auto const depth = image.depth(); depth == CV_8U || depth == CV_16U || depth == CV_32F) {
+    cv::cvtColor(image, target, code.value());
+
+  } else {
+    // cvtColor does not support the remaining depths (f.i., CV_16F or CV_64F).
+    static constexpr std::array<int, 8> fromTo{ 0, 2, 1, 1, 2, 0, 3, 3 };
+    target.create(image.rows, image.cols, image.type());
+    cv::mixChannels(&image, 1, &target, 1, fromTo.data(), static_cast<std::size_t>(image.channels()));
+  }
+}
+
+/// \return #image with swapped red and blue channel; #image itself if it is no 3- or 4-channel 2-D image.
+[[nodiscard]] auto swapRedBlue(cv::Mat const &image) -> cv::Mat {
+  if (!swapRedBlueCode(image).has_value()) { return image; }
+
+  auto swapped = pooledMat();
+  swapRedBlue(image, swapped);
+  return swapped;
+}
+
+/// \return numpy shape of #image as written to MAT_RAW; empty if the image could not be serialized.
+[[nodiscard]] auto matRawShape(cv::Mat const &image) -> std::vector<uint64_t> {
+  if (opencvToNumpy(image.depth()) == 0) {
+    spdlog::error("Type {} not convertible to numpy yet.", image.type());
+    return {};
+  }
+  if (image.dims < 1) {
+    spdlog::error("Could not encode raw mat without dimensions.");
+    return {};
+  }
+
+  std::vector<uint64_t> shape{};
+  shape.reserve(static_cast<std::size_t>(image.dims) + 1);
+  // NOLINTNEXTLINE(altera-unroll-loops)
+  for (int dimension = 0; dimension < image.dims; ++dimension) {
+    shape.push_back(static_cast<uint64_t>(image.size[dimension]));
+  }
+  shape.push_back(static_cast<uint64_t>(image.channels()));
+  return shape;
+}
+
+/// \return size of the MAT_RAW header for an image of #shape.
+[[nodiscard]] constexpr auto matRawHeaderSize(std::span<uint64_t const> shape) noexcept -> std::size_t {
+  return matRawRankSize + sizeof(uint64_t) * shape.size();
+}
+
+/// Write the MAT_RAW header of #image with #shape (see matRawShape) to #header (matRawHeaderSize bytes).
+auto writeMatRawHeader(cv::Mat const &image, std::span<uint64_t const> shape, unsigned char *header) -> void {
+  header[0] = static_cast<unsigned char>(opencvToNumpy(image.depth()));
+  header[1] = static_cast<uint8_t>(image.elemSize1());
+
+  auto const rank = dataspree::inference::core::toLittleEndian<uint64_t, unsigned char>(shape.size());
+  std::memcpy(&header[2], rank.data(), sizeof(uint64_t));
+  // NOLINTNEXTLINE(altera-unroll-loops)
+  for (std::size_t i = 0; i < shape.size(); ++i) {
+    auto const value = dataspree::inference::core::toLittleEndian<uint64_t, unsigned char>(shape[i]);
+    std::memcpy(&header[matRawRankSize + sizeof(uint64_t) * i], value.data(), sizeof(uint64_t));
+  }
+}
+
+/// \return true if the data of #image is the MAT_RAW payload of #encoding as is, such that it can be sent without
+///         copying it: continuous, without channels to swap and in little endian byte order.
+[[nodiscard]] auto isMatRawAsIs(cv::Mat const &image, std::string const &encoding) -> bool {
+  return encoding == "MAT_RAW" && image.dims >= 1 && image.total() > 0 && image.isContinuous()
+         && opencvToNumpy(image.depth()) != 0 && !swapRedBlueCode(image).has_value()
+         && (!dataspree::inference::core::isBigEndian || image.elemSize1() == 1);
+}
+
+/// Serialize #image as MAT_RAW. The data is copied row by row (respecting the step of #image) directly into the
+/// payload.
+/// \param prefixSize number of zero bytes reserved in front of the payload (f.i., for the quantization header).
+/// \param toRgb swap the red and the blue channel of 3- and 4-channel images while copying.
+/// \return payload; empty if the image could not be serialized.
+[[nodiscard]] auto writeMatRaw(cv::Mat const &image, std::size_t prefixSize = 0, bool toRgb = false)
+  -> std::vector<unsigned char> {
+  auto const shape = matRawShape(image);
+  if (shape.empty()) { return {}; }
+
+  auto const dataTypeSize = image.elemSize1();
+  auto const imageDataSize = image.total() * image.elemSize();
+  auto const headerSize = matRawHeaderSize(shape);
+  std::vector<unsigned char> bytes(prefixSize + headerSize + imageDataSize);
+
+  auto *const header = &bytes[prefixSize];
+  writeMatRawHeader(image, shape, header);
+
+  if (imageDataSize == 0) { return bytes; }
+
+  // Header over the payload; copyTo / cvtColor write into it without reallocating since size and type match.
+  auto *const imageDataStart = &header[headerSize];
+  cv::Mat target(image.dims, image.size.p, image.type(), imageDataStart);
+  if (toRgb && dataTypeSize == 1) {
+    swapRedBlue(image, target);
+  } else if (toRgb) {
+    // The payload is not aligned for wider types; only copy (memcpy) into it.
+    swapRedBlue(image).copyTo(target);
+  } else {
+    image.copyTo(target);
+  }
+  assert(target.data == imageDataStart);
+
+  dataspree::inference::core::toLittleEndian(imageDataStart, imageDataSize, dataTypeSize);
+  return bytes;
+}
+
+/// Validated header of a MAT_RAW payload.
+// NOLINTNEXTLINE(altera-struct-pack-align)
+struct MatRawView {
+  /// numpy shape.
+  std::vector<uint64_t> shape;
+  /// Sizes of the corresponding cv::Mat.
+  std::vector<int> sizes;
+  int type;
+  uint8_t typeSize;
+  /// Little endian values, not necessarily aligned.
+  std::span<unsigned char const> data;
+};
+
+/// Parse the header of a MAT_RAW payload and validate the shape against the payload size.
+/// \return header or std::nullopt if the payload is malformed.
+[[nodiscard]] auto parseMatRaw(std::span<unsigned char const> bytes) -> std::optional<MatRawView> {
+  if (bytes.size() < matRawRankSize) {
+    spdlog::warn("Could not decode raw mat: payload of {} bytes too small.", bytes.size());
+    return std::nullopt;
+  }
+
+  auto const type = static_cast<char>(bytes[0]);
+  auto const type_size = bytes[1];
+  auto const rank = fromLittleEndian<uint64_t>(&bytes[2]);
+
+  if (rank == 0 || rank > CV_MAX_DIM || bytes.size() < matRawRankSize + sizeof(uint64_t) * rank) {
+    spdlog::warn("Could not decode raw mat: unsupported rank ({}) or truncated header.", rank);
+    return std::nullopt;
+  }
+
+  std::vector<uint64_t> shape(rank);
+  // NOLINTNEXTLINE(altera-unroll-loops)
+  for (std::size_t i = 0; i < shape.size(); ++i) {
+    shape[i] = fromLittleEndian<uint64_t>(&bytes[matRawRankSize + sizeof(uint64_t) * i]);
+  }
+  auto const headerSize = matRawRankSize + sizeof(uint64_t) * rank;
+
+  // Map the numpy shape onto sizes and channels of a cv::Mat.
+  std::vector<uint64_t> sizes = shape;
+  uint64_t channels = 1;
+  if (rank == 1) {
+    sizes.push_back(1);
+  } else if (rank >= 3 && shape.back() > 0 && shape.back() <= CV_CN_MAX) {
+    channels = shape.back();
+    sizes.pop_back();
+  }
+
+  auto const [cvType, size] = numpyToOpencv(type, type_size, channels);
+  if (size != type_size or size == 0 or cvType > std::numeric_limits<int>::max()) {
+    spdlog::warn("Could not decode raw mat: {} {} -> {} {}.", type, type_size, cvType, size);
+    return std::nullopt;
+  }
+
+  // Validate the shape against the payload without overflowing.
+  auto const imageDataSize = bytes.size() - headerSize;
+  uint64_t expectedSize = channels * type_size;
+  std::vector<int> matSizes{};
+  matSizes.reserve(sizes.size());
+  // NOLINTNEXTLINE(altera-unroll-loops)
+  for (auto const dimension : sizes) {
+    if (dimension > static_cast<uint64_t>(std::numeric_limits<int>::max())
+        || (dimension != 0 && expectedSize > imageDataSize / dimension)) {
+      spdlog::warn("Could not decode raw mat: shape ({}) exceeds the {} bytes of data.",
+        fmt::join(shape, ", "),
+        imageDataSize);
+      return std::nullopt;
+    }
+    expectedSize *= dimension;
+    matSizes.push_back(static_cast<int>(dimension));
+  }
+  if (expectedSize != imageDataSize) {
+    spdlog::warn(
+      "Could not decode raw mat: {} bytes of data do not match shape ({}).", imageDataSize, fmt::join(shape, ", "));
+    return std::nullopt;
+  }
+
+  return MatRawView{ .shape = std::move(shape),
+    .sizes = std::move(matSizes),
+    .type = static_cast<int>(cvType),
+    .typeSize = type_size,
+    .data = bytes.subspan(headerSize) };
+}
+
+/// Deserialize a MAT_RAW payload.
+/// \param toBgr swap the red and the blue channel of 3- and 4-channel images.
+/// \return image or std::nullopt if the payload is malformed.
+[[nodiscard]] auto readMatRaw(std::span<unsigned char const> bytes, bool toBgr = false) -> std::optional<cv::Mat> {
+  auto const view = parseMatRaw(bytes);
+  if (!view.has_value()) { return std::nullopt; }
+
+  auto mat = pooledMat(static_cast<int>(view->sizes.size()), view->sizes.data(), view->type);
+  if (view->data.empty()) { return mat; }
+
+  if (toBgr && view->typeSize == 1 && swapRedBlueCode(mat).has_value()) {
+    // Convert directly from the payload; single bytes need neither alignment nor byte swapping.
+    // NOLINTNEXTLINE(cppcoreguidelines-pro-type-const-cast)
+    auto const payload = cv::Mat(mat.dims, mat.size.p, mat.type(), const_cast<unsigned char *>(view->data.data()));
+    swapRedBlue(payload, mat);
+    return mat;
+  }
+
+  std::memcpy(mat.data, view->data.data(), view->data.size());
+  dataspree::inference::core::toLittleEndian(mat.data, view->data.size(), view->typeSize);
+  return toBgr ? swapRedBlue(mat) : mat;
+}
+
+/// Encode a floating point image as MAT_RAW with half precision values.
+[[nodiscard]] auto encodeMatRawF16(cv::Mat const &image) -> std::vector<unsigned char> {
+  if (image.depth() == CV_16F) { return writeMatRaw(image, 0, true); }
+
+  if (image.depth() != CV_32F && image.depth() != CV_64F) {
+    spdlog::error("MAT_RAW_F16 requires a floating point image; got type {}.", image.type());
+    return {};
+  }
+
+  cv::Mat source = image;
+  if (image.depth() == CV_64F) {
+    source = pooledMat();
+    image.convertTo(source, CV_32F);
+  }
+  source = swapRedBlue(source);
+  if (!source.isContinuous()) {
+    auto continuous = pooledMat();
+    source.copyTo(continuous);
+    source = continuous;
+  }
+
+  auto half = pooledMat(source.dims, source.size.p, CV_MAKETYPE(CV_16F, source.channels()));
+  auto const values = source.total() * static_cast<std::size_t>(source.channels());
+  dataspree::inference::floatToHalf(std::span(source.ptr<float>(), values),
+    // NOLINTNEXTLINE(cppcoreguidelines-pro-type-reinterpret-cast)
+    std::span(reinterpret_cast<uint16_t *>(half.data), values));
+  return writeMatRaw(half);
+}
+
+/// Decode a MAT_RAW payload with half precision values into a single precision image.
+[[nodiscard]] auto decodeMatRawF16(std::span<unsigned char const> bytes) -> std::optional<cv::Mat> {
+  auto half = readMatRaw(bytes);
+  if (!half.has_value() || half->depth() != CV_16F) {
+    if (half.has_value()) { spdlog::warn("Could not decode MAT_RAW_F16: payload of type {}.", half->type()); }
+    return std::nullopt;
+  }
+
+  auto image = pooledMat(half->dims, half->size.p, CV_MAKETYPE(CV_32F, half->channels()));
+  auto const values = image.total() * static_cast<std::size_t>(image.channels());
+  // NOLINTNEXTLINE(cppcoreguidelines-pro-type-reinterpret-cast)
+  dataspree::inference::halfToFloat(std::span(reinterpret_cast<uint16_t const *>(half->data), values),
+    std::span(image.ptr<float>(), values));
+  return swapRedBlue(image);
+}
+
+/// Linearly quantize #image to #depth (CV_8U or CV_16U) over its value range and encode it as MAT_RAW, preceded by
+/// the scale and offset that restore the values. The error is at most half of the scale.
+[[nodiscard]] auto encodeMatRawQuantized(cv::Mat const &image, int depth) -> std::vector<unsigned char> {
+  if (image.empty()) {
+    spdlog::error("Quantized MAT_RAW requires a non-empty image.");
+    return {};
+  }
+
+  double minimum{ 0 };
+  double maximum{ 0 };
+  cv::minMaxIdx(image, &minimum, &maximum);
+  if (!std::isfinite(minimum) || !std::isfinite(maximum)) {
+    spdlog::error("Quantized MAT_RAW requires finite values.");
+    return {};
+  }
+
+  auto const levels = depth == CV_8U ? double{ std::numeric_limits<uint8_t>::max() }
+                                     : double{ std::numeric_limits<uint16_t>::max() };
+  auto const scale = maximum > minimum ? (maximum - minimum) / levels : 1.0;
+
+  auto quantized = pooledMat();
+  image.convertTo(quantized, depth, 1.0 / scale, -minimum / scale);
+
+  auto bytes = writeMatRaw(quantized, matRawQuantizedHeaderSize, true);
+  if (!bytes.empty()) {
+    auto const convScale = dataspree::inference::core::toLittleEndian<double, unsigned char>(scale);
+    auto const convOffset = dataspree::inference::core::toLittleEndian<double, unsigned char>(minimum);
+    std::memcpy(&bytes[0], convScale.data(), sizeof(double));
+    std::memcpy(&bytes[sizeof(double)], convOffset.data(), sizeof(double));
+  }
+  return bytes;
+}
+
+/// Decode a MAT_RAW_Q8 / MAT_RAW_Q16 payload into a single precision image.
+[[nodiscard]] auto decodeMatRawQuantized(std::span<unsigned char const> bytes, int depth) -> std::optional<cv::Mat> {
+  if (bytes.size() < matRawQuantizedHeaderSize) {
+    spdlog::warn("Could not decode quantized raw mat: payload of {} bytes too small.", bytes.size());
+    return std::nullopt;
+  }
+
+  auto const scale = fromLittleEndian<double>(&bytes[0]);
+  auto const offset = fromLittleEndian<double>(&bytes[sizeof(double)]);
+  auto quantized = readMatRaw(bytes.subspan(matRawQuantizedHeaderSize));
+  if (!quantized.has_value() || quantized->depth() != depth) {
+    if (quantized.has_value()) { spdlog::warn("Could not decode quantized raw mat of type {}.", quantized->type()); }
+    return std::nullopt;
+  }
+
+  auto image = pooledMat();
+  quantized->convertTo(image, CV_32F, scale, offset);
+  return swapRedBlue(image);
+}
+
+// Point clouds (EncodingType.PointCloud) are transmitted as MAT_RAW payloads of shape (points, fields) or
+// (rows, cols, fields) in array-of-structures layout; the fields are x, y, z, followed by the intensity (4 or 7 fields)
+// and r, g, b (6 or 7 fields).
+
+/// \return whether a point with #numberOfFields fields has an intensity and a color or std::nullopt if the number
+///         of fields is not supported.
+[[nodiscard]] auto pointCloudFields(std::size_t numberOfFields) -> std::optional<std::pair<bool, bool>> {
+  switch (numberOfFields) {
+  case 3:
+    return std::pair{ false, false };
+  case 4:
+    return std::pair{ true, false };
+  case 6:
+    return std::pair{ false, true };
+  case 7:
+    return std::pair{ true, true };
+  default:
+    return std::nullopt;
+  }
+}
+
+/// Transpose #numberOfPoints points with #numberOfFields fields each (array of structures) into #pointCloud.
+/// \param value returns field #field of point #point.
+template<typename Value>
+auto transposePoints(dataspree::inference::core::PointCloud &pointCloud,
+  std::size_t numberOfPoints,
+  std::size_t numberOfFields,
+  Value &&value) -> void {
+  using Field = dataspree::inference::core::PointCloud::Field;
+
+  // Fields in the order of the payload.
+  std::array<std::span<float>, 7> fields{ pointCloud.x(), pointCloud.y(), pointCloud.z() };
+  std::size_t index = 3;
+  if (pointCloud.hasIntensity()) { fields.at(index++) = pointCloud.field(Field::INTENSITY); }
+  if (pointCloud.hasColor()) {
+    fields.at(index++) = pointCloud.field(Field::R);
+    fields.at(index++) = pointCloud.field(Field::G);
+    fields.at(index++) = pointCloud.field(Field::B);
+  }
+
+  // NOLINTBEGIN(altera-unroll-loops)
+  for (std::size_t field = 0; field < numberOfFields; ++field) {
+    auto target = fields.at(field);
+    for (std::size_t point = 0; point < numberOfPoints; ++point) { target[point] = value(point, field); }
+  }
+  // NOLINTEND(altera-unroll-loops)
+}
+
+auto dataspree::inference::decodePointCloud(std::span<unsigned char const> payload)
+  -> std::optional<core::PointCloud> {
+  auto const view = parseMatRaw(payload);
+  if (!view.has_value()) { return std::nullopt; }
+
+  // (points, fields) or (rows, cols, fields)
+  auto const numberOfFields = view->shape.back();
+  auto const layout = view->shape.size() >= 2 ? pointCloudFields(numberOfFields) : std::nullopt;
+  if (!layout.has_value() || view->shape.size() > 3) {
+    spdlog::warn("Could not decode point cloud of shape ({}).", fmt::join(view->shape, ", "));
+    return std::nullopt;
+  }
+
+  auto const numberOfPoints = numberOfFields == 0 ? 0 : view->data.size() / view->typeSize / numberOfFields;
+  core::PointCloud pointCloud(numberOfPoints, layout->first, layout->second);
+
+  if (CV_MAT_DEPTH(view->type) == CV_32F && core::isLittleEndian) {
+    // Read the values straight from the payload.
+    auto const *const data = view->data.data();
+    transposePoints(pointCloud, numberOfPoints, numberOfFields, [data, numberOfFields](auto point, auto field) {
+      float value{};
+      std::memcpy(&value, &data[(point * numberOfFields + field) * sizeof(float)], sizeof(float));
+      return value;
+    });
+    return pointCloud;
+  }
+
+  // Other depths (f.i., float16 or float64) are converted first.
+  auto mat = readMatRaw(payload);
+  if (!mat.has_value()) { return std::nullopt; }
+
+  auto values = pooledMat();
+  mat->convertTo(values, CV_MAKETYPE(CV_32F, mat->channels()));
+  auto const *const data = values.ptr<float>();
+  transposePoints(pointCloud, numberOfPoints, numberOfFields, [data, numberOfFields](auto point, auto field) {
+    return data[point * numberOfFields + field];
+  });
+  return pointCloud;
+}
+
+/// \return value of a numeric item or std::nullopt.
+[[nodiscard]] auto numericValue(dataspree::inference::core::Item const &item) -> std::optional<float> {
+  using ItemType = dataspree::inference::core::ItemType;
+  switch (item.getType()) {
+  case ItemType::F32:
+    return item.as<float>();
+  case ItemType::F64:
+    return static_cast<float>(item.as<double>());
+  case ItemType::UINT8:
+    return static_cast<float>(item.as<uint8_t>());
+  case ItemType::UINT16:
+    return static_cast<float>(item.as<uint16_t>());
+  case ItemType::UINT32:
+    return static_cast<float>(item.as<uint32_t>());
+  case ItemType::UINT64:
+    return static_cast<float>(item.as<uint64_t>());
+  case ItemType::INT8:
+    return static_cast<float>(item.as<int8_t>());
+  case ItemType::INT16:
+    return static_cast<float>(item.as<int16_t>());
+  case ItemType::INT32:
+    return static_cast<float>(item.as<int32_t>());
+  case ItemType::INT64:
+    return static_cast<float>(item.as<int64_t>());
+  default:
+    return std::nullopt;
+  }
+}
+
+auto dataspree::inference::decodePointCloud(core::Item const &points) -> std::optional<core::PointCloud> {
+  static constexpr std::array<char const *, 7> fieldNames{ "x", "y", "z", "intensity", "r", "g", "b" };
+
+  auto const *const list = points.find_at<std::vector<core::Item>>();
+  if (list == nullptr) {
+    spdlog::warn("Could not decode point cloud from item of type {}.", core::getUnderlyingValue(points.getType()));
+    return std::nullopt;
+  }
+  if (list->empty()) { return core::PointCloud(0, false, false); }
+
+  // Points are either arrays [x, y, z, (intensity), (r, g, b)] or objects with the keys in #fieldNames.
+  auto const &first = list->front();
+  std::optional<std::pair<bool, bool>> layout{};
+  std::size_t numberOfFields{ 0 };
+  if (auto const *array = first.find_at<std::vector<core::Item>>(); array != nullptr) {
+    numberOfFields = array->size();
+    layout = pointCloudFields(numberOfFields);
+  } else if (first.contains("x") && first.contains("y") && first.contains("z")) {
+    auto const color = first.contains("r") && first.contains("g") && first.contains("b");
+    layout = std::pair{ first.contains("intensity"), color };
+    numberOfFields = static_cast<std::size_t>(3 + (layout->first ? 1 : 0) + (layout->second ? 3 : 0));
+  }
+  if (!layout.has_value()) {
+    spdlog::warn("Could not decode point cloud; unsupported point layout.");
+    return std::nullopt;
+  }
+
+  core::PointCloud pointCloud(list->size(), layout->first, layout->second);
+  auto const arrays = first.find_at<std::vector<core::Item>>() != nullptr;
+  auto const hasIntensity = layout->first;
+  bool valid{ true };
+  transposePoints(pointCloud, list->size(), numberOfFields, [&](std::size_t point, std::size_t field) {
+    auto const &item = (*list)[point];
+    core::Item const *value{ nullptr };
+    if (arrays) {
+      auto const *array = item.find_at<std::vector<core::Item>>();
+      value = array != nullptr && array->size() == numberOfFields ? &(*array)[field] : nullptr;
+    } else {
+      // Object fields in payload order; skip the intensity name if there is none.
+      auto const nameIndex = field < 3 || hasIntensity ? field : field + 1;
+      value = item.find_at(std::string(fieldNames.at(nameIndex)));
+    }
+
+    auto const numeric = value != nullptr ? numericValue(*value) : std::nullopt;
+    valid = valid && numeric.has_value();
+    return numeric.value_or(0.0F);
+  });
+
+  if (!valid) {
+    spdlog::warn("Could not decode point cloud; points with missing or non-numeric fields.");
+    return std::nullopt;
+  }
+  return pointCloud;
+}
+
+auto dataspree::inference::encodePointCloud(core::PointCloud const &pointCloud) -> std::vector<unsigned char> {
+  using Field = core::PointCloud::Field;
+
+  std::vector<std::span<float const>> fields{ pointCloud.x(), pointCloud.y(), pointCloud.z() };
+  if (pointCloud.hasIntensity()) { fields.push_back(pointCloud.field(Field::INTENSITY)); }
+  if (pointCloud.hasColor()) {
+    fields.push_back(pointCloud.field(Field::R));
+    fields.push_back(pointCloud.field(Field::G));
+    fields.push_back(pointCloud.field(Field::B));
+  }
+
+  std::array<int, 2> const sizes{ static_cast<int>(pointCloud.size()), static_cast<int>(fields.size()) };
+  auto points = pooledMat(2, sizes.data(), CV_32FC1);
+  // NOLINTBEGIN(altera-unroll-loops)
+  for (std::size_t point = 0; point < pointCloud.size(); ++point) {
+    auto *const row = points.ptr<float>(static_cast<int>(point));
+    for (std::size_t field = 0; field < fields.size(); ++field) { row[field] = fields[field][point]; }
+  }
+  // NOLINTEND(altera-unroll-loops)
+
+  // (points, fields) instead of the (rows, cols, channels) of images.
+  auto payload = writeMatRaw(points);
+  if (payload.empty()) { return payload; }
+
+  static constexpr std::size_t rankTwoHeaderSize = matRawRankSize + sizeof(uint64_t) * 2;
+  auto const rank = core::toLittleEndian<uint64_t, unsigned char>(uint64_t{ 2 });
+  std::memcpy(&payload[2], rank.data(), sizeof(uint64_t));
+  payload.erase(payload.begin() + rankTwoHeaderSize, payload.begin() + rankTwoHeaderSize + sizeof(uint64_t));
+  return payload;
+}
+
+// Lossless "Quite OK Image" (QOI) codec for 8-bit RGB(A) images (https://qoiformat.org/qoi-specification.pdf).
+// Pixels are coded as runs, references into a table of recently seen pixels, or small differences to the previous
+// pixel, which makes it considerably faster than PNG at a comparable compression ratio for camera images.
+
+static constexpr std::array<unsigned char, 4> qoiMagic{ 'q', 'o', 'i', 'f' };
+static constexpr std::size_t qoiHeaderSize = 14;
+static constexpr std::array<unsigned char, 8> qoiPadding{ 0, 0, 0, 0, 0, 0, 0, 1 };
+
+static constexpr unsigned char qoiOpIndex = 0x00;
+static constexpr unsigned char qoiOpDiff = 0x40;
+static constexpr unsigned char qoiOpLuma = 0x80;
+static constexpr unsigned char qoiOpRun = 0xc0;
+static constexpr unsigned char qoiOpRgb = 0xfe;
+static constexpr unsigned char qoiOpRgba = 0xff;
+static constexpr unsigned char qoiMask = 0xc0;
+
+/// Upper bound for the number of pixels of a QOI image (as in the reference implementation).
+static constexpr uint64_t qoiMaxPixels = 400'000'000;
+
+// NOLINTNEXTLINE(altera-struct-pack-align)
+struct QoiPixel {
+  unsigned char r{ 0 };
+  unsigned char g{ 0 };
+  unsigned char b{ 0 };
+  unsigned char a{ 255 };
+
+  [[nodiscard]] constexpr auto operator==(QoiPixel const &other) const noexcept -> bool = default;
+
+  [[nodiscard]] constexpr auto hash() const noexcept -> std::size_t {
+    return (static_cast<std::size_t>(r) * 3 + static_cast<std::size_t>(g) * 5 + static_cast<std::size_t>(b) * 7
+             + static_cast<std::size_t>(a) * 11)
+           % 64;
+  }
+};
+
+/// \return index of previously seen pixels, which the specification initializes with zeros (transparent black).
+[[nodiscard]] constexpr auto qoiIndex() noexcept -> std::array<QoiPixel, 64> {
+  std::array<QoiPixel, 64> index{};
+  index.fill(QoiPixel{ .a = 0 });
+  return index;
+}
+
+/// Encode an 8-bit BGR or BGRA image as QOI (channels are stored as RGB(A)).
+/// \return encoded image, or an empty buffer if the image is not supported.
+[[nodiscard]] auto qoiEncode(cv::Mat const &image) -> std::vector<unsigned char> {
+  auto const channels = image.channels();
+  if (image.depth() != CV_8U || (channels != 3 && channels != 4) || image.dims != 2 || image.empty()) {
+    spdlog::error("QOI encoding requires an 8-bit 3 or 4 channel image, got type {}.", image.type());
+    return {};
+  }
+
+  auto const width = static_cast<uint32_t>(image.cols);
+  auto const height = static_cast<uint32_t>(image.rows);
+  if (static_cast<uint64_t>(width) * height >= qoiMaxPixels) {
+    spdlog::error("QOI encoding does not support images of size {}x{}.", width, height);
+    return {};
+  }
+
+  // Reserve the worst case without touching it; the pixels are encoded row by row into a small staging buffer.
+  auto const numberOfPixels = static_cast<std::size_t>(width) * height;
+  auto const maxPixelSize = static_cast<std::size_t>(channels) + 1;
+  std::vector<unsigned char> bytes{};
+  bytes.reserve(qoiHeaderSize + numberOfPixels * maxPixelSize + qoiPadding.size());
+
+  bytes.insert(bytes.end(), qoiMagic.begin(), qoiMagic.end());
+  auto const convWidth = dataspree::inference::core::toBigEndian(width);
+  bytes.insert(bytes.end(), convWidth.begin(), convWidth.end());
+  auto const convHeight = dataspree::inference::core::toBigEndian(height);
+  bytes.insert(bytes.end(), convHeight.begin(), convHeight.end());
+  bytes.push_back(static_cast<unsigned char>(channels));
+  bytes.push_back(0);// sRGB with linear alpha
+
+  std::vector<unsigned char> rowBytes(static_cast<std::size_t>(width) * maxPixelSize);
+  auto *const out = rowBytes.data();
+
+  auto index = qoiIndex();
+  QoiPixel previous{};
+  unsigned char run = 0;
+  std::size_t pixelNumber = 0;
+
+  // NOLINTBEGIN(altera-unroll-loops,cppcoreguidelines-pro-bounds-constant-array-index)
+  for (int row = 0; row < image.rows; ++row) {
+    auto const *pixels = image.ptr<unsigned char>(row);
+    std::size_t pos = 0;
+
+    for (int col = 0; col < image.cols; ++col, ++pixelNumber, pixels += channels) {
+      QoiPixel const pixel{ pixels[2], pixels[1], pixels[0], channels == 4 ? pixels[3] : previous.a };
+
+      if (pixel == previous) {
+        ++run;
+        if (run == 62 || pixelNumber + 1 == numberOfPixels) {
+          out[pos++] = static_cast<unsigned char>(qoiOpRun | (run - 1));
+          run = 0;
+        }
+        continue;
+      }
+
+      if (run > 0) {
+        out[pos++] = static_cast<unsigned char>(qoiOpRun | (run - 1));
+        run = 0;
+      }
+
+      auto const hash = pixel.hash();
+      if (index[hash] == pixel) {
+        out[pos++] = static_cast<unsigned char>(qoiOpIndex | hash);
+
+      } else {
+        index[hash] = pixel;
+
+        if (pixel.a == previous.a) {
+          auto const dr = static_cast<int8_t>(pixel.r - previous.r);
+          auto const dg = static_cast<int8_t>(pixel.g - previous.g);
+          auto const db = static_cast<int8_t>(pixel.b - previous.b);
+          auto const drdg = static_cast<int8_t>(dr - dg);
+          auto const dbdg = static_cast<int8_t>(db - dg);
+
+          if (dr > -3 && dr < 2 && dg > -3 && dg < 2 && db > -3 && db < 2) {
+            out[pos++] = static_cast<unsigned char>(qoiOpDiff | (dr + 2) << 4 | (dg + 2) << 2 | (db + 2));
+
+          } else if (drdg > -9 && drdg < 8 && dg > -33 && dg < 32 && dbdg > -9 && dbdg < 8) {
+            out[pos++] = static_cast<unsigned char>(qoiOpLuma | (dg + 32));
+            out[pos++] = static_cast<unsigned char>((drdg + 8) << 4 | (dbdg + 8));
+
+          } else {
+            out[pos++] = qoiOpRgb;
+            out[pos++] = pixel.r;
+            out[pos++] = pixel.g;
+            out[pos++] = pixel.b;
+          }
+
+        } else {
+          out[pos++] = qoiOpRgba;
+          out[pos++] = pixel.r;
+          out[pos++] = pixel.g;
+          out[pos++] = pixel.b;
+          out[pos++] = pixel.a;
+        }
+      }
+      previous = pixel;
+    }
+    bytes.insert(bytes.end(), out, out + pos);
+  }
+  // NOLINTEND(altera-unroll-loops,cppcoreguidelines-pro-bounds-constant-array-index)
+
+  bytes.insert(bytes.end(), qoiPadding.begin(), qoiPadding.end());
+  return bytes;
+}
+
+/// Decode a QOI image into an 8-bit BGR or BGRA image.
+/// \return decoded image or std::nullopt if the payload is malformed.
+[[nodiscard]] auto qoiDecode(std::span<unsigned char const> bytes) -> std::optional<cv::Mat> {
+  if (bytes.size() < qoiHeaderSize + qoiPadding.size()
+      || !std::equal(qoiMagic.begin(), qoiMagic.end(), bytes.begin())) {
+    spdlog::warn("Could not decode QOI image; invalid header.");
+    return std::nullopt;
+  }
+
+  auto const readUint32 = [&bytes](std::size_t offset) {
+    return static_cast<uint32_t>(bytes[offset]) << 24U | static_cast<uint32_t>(bytes[offset + 1]) << 16U
+           | static_cast<uint32_t>(bytes[offset + 2]) << 8U | static_cast<uint32_t>(bytes[offset + 3]);
+  };
+  auto const width = readUint32(4);
+  auto const height = readUint32(8);
+  auto const channels = static_cast<int>(bytes[12]);
+
+  if (width == 0 || height == 0 || static_cast<uint64_t>(width) * height >= qoiMaxPixels
+      || width > static_cast<uint32_t>(std::numeric_limits<int>::max())
+      || height > static_cast<uint32_t>(std::numeric_limits<int>::max()) || (channels != 3 && channels != 4)) {
+    spdlog::warn("Could not decode QOI image of size {}x{} with {} channels.", width, height, channels);
+    return std::nullopt;
+  }
+
+  std::array<int, 2> const sizes{ static_cast<int>(height), static_cast<int>(width) };
+  auto image = pooledMat(2, sizes.data(), CV_MAKETYPE(CV_8U, channels));
+
+  auto const truncated = []() -> std::optional<cv::Mat> {
+    spdlog::warn("Could not decode QOI image; payload truncated.");
+    return std::nullopt;
+  };
+
+  auto index = qoiIndex();
+  QoiPixel pixel{};
+  int run = 0;
+  std::size_t pos = qoiHeaderSize;
+  auto const chunksEnd = bytes.size() - qoiPadding.size();
+
+  // NOLINTBEGIN(altera-unroll-loops,cppcoreguidelines-pro-bounds-constant-array-index)
+  for (int row = 0; row < image.rows; ++row) {
+    auto *pixels = image.ptr<unsigned char>(row);
+
+    for (int col = 0; col < image.cols; ++col, pixels += channels) {
+      if (run > 0) {
+        --run;
+
+      } else if (pos < chunksEnd) {
+        auto const b1 = bytes[pos++];
+
+        if (b1 == qoiOpRgb) {
+          if (pos + 3 > chunksEnd) { return truncated(); }
+          pixel.r = bytes[pos++];
+          pixel.g = bytes[pos++];
+          pixel.b = bytes[pos++];
+
+        } else if (b1 == qoiOpRgba) {
+          if (pos + 4 > chunksEnd) { return truncated(); }
+          pixel.r = bytes[pos++];
+          pixel.g = bytes[pos++];
+          pixel.b = bytes[pos++];
+          pixel.a = bytes[pos++];
+
+        } else if ((b1 & qoiMask) == qoiOpIndex) {
+          pixel = index[b1];
+
+        } else if ((b1 & qoiMask) == qoiOpDiff) {
+          pixel.r = static_cast<unsigned char>(pixel.r + ((b1 >> 4U) & 0x03U) - 2);
+          pixel.g = static_cast<unsigned char>(pixel.g + ((b1 >> 2U) & 0x03U) - 2);
+          pixel.b = static_cast<unsigned char>(pixel.b + (b1 & 0x03U) - 2);
+
+        } else if ((b1 & qoiMask) == qoiOpLuma) {
+          if (pos + 1 > chunksEnd) { return truncated(); }
+          auto const b2 = bytes[pos++];
+          auto const dg = static_cast<int>(b1 & 0x3fU) - 32;
+          pixel.r = static_cast<unsigned char>(pixel.r + dg - 8 + static_cast<int>((b2 >> 4U) & 0x0fU));
+          pixel.g = static_cast<unsigned char>(pixel.g + dg);
+          pixel.b = static_cast<unsigned char>(pixel.b + dg - 8 + static_cast<int>(b2 & 0x0fU));
+
+        } else {
+          run = b1 & 0x3f;
+        }
+
+        index[pixel.hash()] = pixel;
+      }
+
+      pixels[0] = pixel.b;
+      pixels[1] = pixel.g;
+      pixels[2] = pixel.r;
+      if (channels == 4) { pixels[3] = pixel.a; }
+    }
+  }
+  // NOLINTEND(altera-unroll-loops,cppcoreguidelines-pro-bounds-constant-array-index)
+
+  return image;
+}
+
+auto dataspree::inference::decodeImage(Buffer &data, std::string const &encoding) -> std::optional<cv::Mat> {
+
+  // NOLINTNEXTLINE(cppcoreguidelines-pro-type-reinterpret-cast)
+  auto const bytes = std::span(reinterpret_cast<unsigned char const *>(data.get()), data.size());
+
+  if (encoding == "MAT_RAW") {
+    return readMatRaw(bytes, true);
+  }
+
+  if (encoding == "MAT_RAW_F16") { return decodeMatRawF16(bytes); }
+  if (encoding == "MAT_RAW_Q8") { return decodeMatRawQuantized(bytes, CV_8U); }
+  if (encoding == "MAT_RAW_Q16") { return decodeMatRawQuantized(bytes, CV_16U); }
+
+  if (encoding == "IMAGE_QOI") { return qoiDecode(bytes); }
+
+  if (encoding == "IMAGE_TILE_DELTA") {
+    spdlog::warn("Could not decode image; IMAGE_TILE_DELTA is stateful, use a TileDeltaDecoder.");
+    return std::nullopt;
+  }
+
+  auto image = pooledMat();
+  cv::imdecode(
+    cv::Mat(1, static_cast<int>(data.size()), CV_8UC1, static_cast<void *>(data.get())), cv::IMREAD_UNCHANGED, &image);
+  return image;
+}
+
+/// \return value of a numeric msgpack object or std::nullopt.
+[[nodiscard]] auto msgpackNumber(msgpack::v3::object const &value) -> std::optional<double> {
+  // NOLINTBEGIN(cppcoreguidelines-pro-type-union-access)
+  switch (value.type) {
+  case msgpack::v3::type::FLOAT32:
+    [[fallthrough]];
+  case msgpack::v3::type::FLOAT64:
+    return value.via.f64;
+  case msgpack::v3::type::POSITIVE_INTEGER:
+    return static_cast<double>(value.via.u64);
+  case msgpack::v3::type::NEGATIVE_INTEGER:
+    return static_cast<double>(value.via.i64);
+  default:
+    return std::nullopt;
+  }
+  // NOLINTEND(cppcoreguidelines-pro-type-union-access)
+}
+
+/// \return value of the numeric #field of the object #element or std::nullopt.
+[[nodiscard]] auto fieldNumber(json const &element, std::string_view field) -> std::optional<double> {
+  if (!element.is_object()) { return std::nullopt; }
+  auto const value = element.find(field);
+  if (value == element.end() || !value->is_number()) { return std::nullopt; }
+  return value->template get<double>();
+}
+
+/// \return value of the numeric #field of the map #element or std::nullopt.
+[[nodiscard]] auto fieldNumber(msgpack::v3::object const &element, std::string_view field) -> std::optional<double> {
+  if (element.type != msgpack::v3::type::MAP) { return std::nullopt; }
+
+  // NOLINTBEGIN(cppcoreguidelines-pro-type-union-access,altera-unroll-loops)
+  for (auto const &[key, value] : element.via.map) {
+    if (key.type == msgpack::v3::type::STR && std::string_view(key.via.str.ptr, key.via.str.size) == field) {
+      return msgpackNumber(value);
+    }
+  }
+  // NOLINTEND(cppcoreguidelines-pro-type-union-access,altera-unroll-loops)
+  return std::nullopt;
+}
+
+/// Path of the detections in received messages.
+static constexpr std::array<std::string_view, 3> detectionPath{ "item", "inference", "detection" };
+static constexpr std::span<std::string_view const> relativeDetectionPath = std::span(detectionPath).subspan<1>();
+
+/// Numeric fields of the detection schema; the first four are required.
+static constexpr std::array<std::pair<std::string_view, float dataspree::inference::core::Detection::*>, 6>
+  detectionFields{ { { "x", &dataspree::inference::core::Detection::x },
+    { "y", &dataspree::inference::core::Detection::y },
+    { "width", &dataspree::inference::core::Detection::width },
+    { "height", &dataspree::inference::core::Detection::height },
+    { "orientation", &dataspree::inference::core::Detection::orientation },
+    { "confidence", &dataspree::inference::core::Detection::confidence } } };
+static constexpr unsigned requiredDetectionFields = 0x0fU;
+
+/// Assign the numeric field #key of #detection.
+/// \return bit of the field in the mask of found fields; 0 if #key is not a numeric field of the schema.
+[[nodiscard]] auto setDetectionField(dataspree::inference::core::Detection &detection,
+  std::string_view key,
+  float value) -> unsigned {
+  // NOLINTNEXTLINE(altera-unroll-loops)
+  for (std::size_t i = 0; i < detectionFields.size(); ++i) {
+    if (detectionFields[i].first == key) {
+      detection.*detectionFields[i].second = value;
+      return 1U << i;
+    }
+  }
+  return 0;
+}
+
+/// \return node at #detectionPath or nullptr.
+[[nodiscard]] auto findDetections(json const &root) -> json const * {
+  json const *node = &root;
+  // NOLINTNEXTLINE(altera-unroll-loops)
+  for (auto const key : detectionPath) {
+    if (!node->is_object()) { return nullptr; }
+    auto const child = node->find(key);
+    if (child == node->end()) { return nullptr; }
+    node = &*child;
+  }
+  return node;
+}
+
+/// \return node at #detectionPath or nullptr.
+[[nodiscard]] auto findDetections(msgpack::v3::object const &root) -> msgpack::v3::object const * {
+  // NOLINTBEGIN(cppcoreguidelines-pro-type-union-access,altera-unroll-loops)
+  msgpack::v3::object const *node = &root;
+  for (auto const key : detectionPath) {
+    if (node->type != msgpack::v3::type::MAP) { return nullptr; }
+    msgpack::v3::object const *child{ nullptr };
+    for (auto const &[entryKey, value] : node->via.map) {
+      if (entryKey.type == msgpack::v3::type::STR
+          && std::string_view(entryKey.via.str.ptr, entryKey.via.str.size) == key) {
+        child = &value;
+        break;
+      }
+    }
+    if (child == nullptr) { return nullptr; }
+    node = child;
+  }
+  // NOLINTEND(cppcoreguidelines-pro-type-union-access,altera-unroll-loops)
+  return node;
+}
+
+/// \return detection #index of #detections for reuse; the labels of existing detections keep their capacity.
+[[nodiscard]] auto reuseDetection(std::vector<dataspree::inference::core::Detection> &detections, std::size_t index)
+  -> dataspree::inference::core::Detection & {
+  if (index == detections.size()) { return detections.emplace_back(); }
+
+  // x, y, width and height are always assigned.
+  auto &detection = detections[index];
+  detection.orientation = 0.0F;
+  detection.confidence = 0.0F;
+  detection.label.clear();
+  return detection;
+}
+
+/// Assign the numeric label #number to #label; integers are formatted without a fraction. Shared by both decoders, so
+/// that the label does not depend on the encoding of the message.
+template<typename Number> auto assignLabel(std::string &label, Number number) -> void {
+  label.clear();
+  fmt::format_to(std::back_inserter(label), "{}", number);
+}
+
+/// Decode detections in the standard schema in a single pass over the parsed message.
+/// \param detections overwritten with the decoded detections; its storage is reused.
+/// \return false if #node is not an array of detections in the standard schema.
+[[nodiscard]] auto decodeDetections(json const &node,
+  dataspree::inference::DecodeFilter const &filter,
+  std::vector<dataspree::inference::core::Detection> &detections) -> bool {
+  if (!node.is_array()) { return false; }
+
+  std::size_t count{ 0 };
+  // NOLINTBEGIN(altera-unroll-loops)
+  for (auto const &entry : node) {
+    if (!entry.is_object()) { return false; }
+    if (filter.rejects(relativeDetectionPath, [&entry](auto field) { return fieldNumber(entry, field); })) {
+      continue;
+    }
+
+    auto &detection = reuseDetection(detections, count++);
+    unsigned found{ 0 };
+    for (auto const &[key, value] : entry.items()) {
+      if (key == "label") {
+        // Labels that are neither strings nor numbers are skipped (as in the msgpack decoder).
+        if (value.is_string()) {
+          detection.label.assign(value.template get_ref<std::string const &>());
+        } else if (value.is_number_unsigned()) {
+          assignLabel(detection.label, value.template get<uint64_t>());
+        } else if (value.is_number_integer()) {
+          assignLabel(detection.label, value.template get<int64_t>());
+        } else if (value.is_number_float()) {
+          assignLabel(detection.label, value.template get<double>());
+        }
+      } else if (value.is_number()) {
+        found |= setDetectionField(detection, key, value.template get<float>());
+      }
+    }
+    if ((found & requiredDetectionFields) != requiredDetectionFields) { return false; }
+  }
+  // NOLINTEND(altera-unroll-loops)
+
+  detections.resize(count);
+  return true;
+}
+
+/// Decode detections in the standard schema in a single pass over the unpacked message.
+/// \param detections overwritten with the decoded detections; its storage is reused.
+/// \return false if #node is not an array of detections in the standard schema.
+[[nodiscard]] auto decodeDetections(msgpack::v3::object const &node,
+  dataspree::inference::DecodeFilter const &filter,
+  std::vector<dataspree::inference::core::Detection> &detections) -> bool {
+  if (node.type != msgpack::v3::type::ARRAY) { return false; }
+
+  std::size_t count{ 0 };
+  // NOLINTBEGIN(cppcoreguidelines-pro-type-union-access,altera-unroll-loops)
+  for (auto const &entry : node.via.array) {
+    if (entry.type != msgpack::v3::type::MAP) { return false; }
+    if (filter.rejects(relativeDetectionPath, [&entry](auto field) { return fieldNumber(entry, field); })) {
+      continue;
+    }
+
+    auto &detection = reuseDetection(detections, count++);
+    unsigned found{ 0 };
+    for (auto const &[key, value] : entry.via.map) {
+      if (key.type != msgpack::v3::type::STR) { continue; }
+      auto const keyString = std::string_view(key.via.str.ptr, key.via.str.size);
+
+      if (keyString == "label") {
+        // Labels that are neither strings nor numbers are skipped (as in the JSON decoder).
+        switch (value.type) {
+        case msgpack::v3::type::STR:
+          detection.label.assign(value.via.str.ptr, value.via.str.size);
+          break;
+        case msgpack::v3::type::POSITIVE_INTEGER:
+          assignLabel(detection.label, value.via.u64);
+          break;
+        case msgpack::v3::type::NEGATIVE_INTEGER:
+          assignLabel(detection.label, value.via.i64);
+          break;
+        case msgpack::v3::type::FLOAT32:
+        case msgpack::v3::type::FLOAT64:
+          assignLabel(detection.label, value.via.f64);
+          break;
+        default:
+          break;
+        }
+      } else if (auto const number = msgpackNumber(value); number.has_value()) {
+        found |= setDetectionField(detection, keyString, static_cast<float>(number.value()));
+      }
+    }
+    if ((found & requiredDetectionFields) != requiredDetectionFields) { return false; }
+  }
+  // NOLINTEND(cppcoreguidelines-pro-type-union-access,altera-unroll-loops)
+
+  detections.resize(count);
+  return true;
+}
+
+/// \return true if the msgpack map #map contains #key.
+[[nodiscard]] auto msgpackContains(msgpack::v3::object const &map, std::string_view key) -> bool {
+  // NOLINTBEGIN(cppcoreguidelines-pro-type-union-access,altera-unroll-loops)
+  for (auto const &[entryKey, value] : map.via.map) {
+    if (entryKey.type == msgpack::v3::type::STR
+        && std::string_view(entryKey.via.str.ptr, entryKey.via.str.size) == key) {
+      return true;
+    }
+  }
+  // NOLINTEND(cppcoreguidelines-pro-type-union-access,altera-unroll-loops)
+  return false;
+}
+
+// The conversion into items reuses the nodes of the item that is decoded into; only nodes whose type changed are
+// replaced.
+
+/// \return map of #item; other content is replaced by an empty map.
+[[nodiscard]] auto reuseMap(dataspree::inference::core::Item &item) -> dataspree::inference::core::ItemMap & {
+  if (item.getType() != dataspree::inference::core::ItemType::OBJECT) { item = dataspree::inference::core::Item{}; }
+  return item.items();
+}
+
+/// \return vector of #item; other content is replaced by an empty vector.
+[[nodiscard]] auto reuseVector(dataspree::inference::core::Item &item)
+  -> std::vector<dataspree::inference::core::Item> & {
+  if (item.getType() != dataspree::inference::core::ItemType::ARRAY) {
+    item = std::vector<dataspree::inference::core::Item>{};
+  }
+  return item.as<std::vector<dataspree::inference::core::Item>>();
+}
+
+/// Assign #value to #item; a string that #item already holds keeps its capacity.
+auto assignString(dataspree::inference::core::Item &item, std::string_view value) -> void {
+  if (item.getType() == dataspree::inference::core::ItemType::STRING) {
+    item.as<std::string>().assign(value);
+  } else {
+    item = std::string(value);
+  }
+}
+
+/// Position of json_to_item / msgpack_to_item in the message; decides which nodes are not converted into items.
+// NOLINTNEXTLINE(altera-struct-pack-align)
+struct ParseContext {
+
+  /// \param filter decode filter; nullptr if nothing is filtered.
+  /// \param skip node that is not converted (f.i., because it was decoded separately); may be nullptr.
+  /// \param path storage of the current path; cleared.
+  ParseContext(dataspree::inference::DecodeFilter const *filter,
+    void const *skip,
+    std::vector<std::string_view> &path)
+    : filter(filter), skip(skip),
+      depth(std::max(filter != nullptr ? filter->depth() + 1 : 0, skip != nullptr ? detectionPath.size() : 0)),
+      path(path) {
+    path.clear();
+  }
+
+  /// \return true if there is anything to skip.
+  [[nodiscard]] auto active() const noexcept -> bool { return depth > 0; }
+
+  /// Appends a key to the path of the context while in scope; a nullptr context is ignored.
+  // NOLINTNEXTLINE(altera-struct-pack-align)
+  struct [[nodiscard]] Scope final {
+    Scope(ParseContext *context, std::string_view key) : context(context) {
+      if (context != nullptr) { context->path.push_back(key); }
+    }
+    Scope(Scope const &) = delete;
+    Scope(Scope &&) = delete;
+    auto operator=(Scope const &) -> Scope & = delete;
+    auto operator=(Scope &&) -> Scope & = delete;
+    ~Scope() {
+      if (context != nullptr) { context->path.pop_back(); }
+    }
+
+    /// \return true if #node, the child at the key of this scope, is not converted.
+    [[nodiscard]] auto skips(void const *node) const -> bool { return context != nullptr && context->skips(node); }
+
+    /// \return true if #node is not converted because it was decoded separately; the existing item is kept.
+    [[nodiscard]] auto decodedSeparately(void const *node) const noexcept -> bool {
+      return context != nullptr && context->skip == node;
+    }
+
+    /// \return context for the conversion of the child or nullptr if nothing below it is skipped.
+    [[nodiscard]] auto children() const noexcept -> ParseContext * {
+      return context != nullptr && context->path.size() < context->depth ? context : nullptr;
+    }
+
+  private:
+    ParseContext *context;
+  };
+
+  /// \return true if #element of the array at the current path is dropped by a predicate.
+  template<typename Node> [[nodiscard]] auto rejects(Node const &element) const -> bool {
+    auto const relative = itemPath();
+    return relative.has_value()
+           && filter->rejects(*relative, [&element](std::string_view field) { return fieldNumber(element, field); });
+  }
+
+private:
+  [[nodiscard]] auto skips(void const *node) const -> bool {
+    if (node == skip) { return true; }
+
+    // The encoded elements are required to decode the images.
+    auto const relative = itemPath();
+    return relative.has_value() && !relative->empty() && relative->front() != "encoded_elements"
+           && filter->skips(*relative);
+  }
+
+  /// \return current path relative to the item or std::nullopt if the path is not inside of the item.
+  [[nodiscard]] auto itemPath() const noexcept -> std::optional<std::span<std::string_view const>> {
+    if (filter == nullptr || path.empty() || path.front() != detectionPath.front()) { return std::nullopt; }
+    return std::span(path).subspan(1);
+  }
+
+  dataspree::inference::DecodeFilter const *filter;
+  void const *skip;
+
+  /// Nodes below this depth are always converted.
+  std::size_t depth;
+
+  /// Keys from the root of the message to the current node; array elements are represented by "*".
+  std::vector<std::string_view> &path;
+};
+
+/// Convert the parsed message #root into #item, reusing the nodes of #item.
+/// \param toItem json_to_item or msgpack_to_item.
+template<typename Node, typename ToItem>
+auto messageToItem(dataspree::inference::core::Item &item,
+  Node const &root,
+  dataspree::inference::DecodeProperties const &decodeProperties,
+  ToItem &&toItem) -> void {
+
+  // Typed detections are not decoded if the filter skips them.
+  auto const &filter = decodeProperties.filter;
+  auto const *detectionNode = decodeProperties.typedDetections && !filter.skips(relativeDetectionPath)
+                                ? findDetections(root)
+                                : nullptr;
+
+  // Detections of the previous message are overwritten in place.
+  std::vector<dataspree::inference::core::Detection> newDetections{};
+  auto *const previousDetections =
+    item.find_at<std::vector<dataspree::inference::core::Detection>>("item", "inference", "detection");
+  auto &detections = previousDetections != nullptr ? *previousDetections : newDetections;
+  auto const typedDetections = detectionNode != nullptr && decodeDetections(*detectionNode, filter, detections);
+
+  // Reused across the messages decoded on this thread.
+  thread_local std::vector<std::string_view> path{};
+  ParseContext context(filter.empty() ? nullptr : &filter, typedDetections ? detectionNode : nullptr, path);
+  toItem(item, root, context.active() ? &context : nullptr);
+
+  if (typedDetections && previousDetections == nullptr) {
+    item["item"]["inference"]["detection"] = std::move(newDetections);
+  }
+}
+
 auto dataspree::inference::decodeItem(char const *const buffer,
   std::size_t const bufferSize,
-  EncodingMode const encodingMode) -> core::Item {
-
+  EncodingMode const encodingMode,
+  DecodeProperties const &decodeProperties) -> core::Item {
   core::Item item{};
+  decodeInto(item, buffer, bufferSize, encodingMode, decodeProperties);
+  return item;
+}
+
+auto dataspree::inference::decodeInto(core::Item &item,
+  char const *const buffer,
+  std::size_t const bufferSize,
+  EncodingMode const encodingMode,
+  DecodeProperties const &decodeProperties) -> void {
+
   if (encodingMode == EncodingMode::MSGPACK) {
     msgpack::unpacked upd{};
     msgpack::unpack(upd, buffer, bufferSize, nullptr);
 
-    msgpack_to_item(item, upd.get());
+    messageToItem(item, upd.get(), decodeProperties, [](auto &&...args) { msgpack_to_item(args...); });
 
   } else if (encodingMode == EncodingMode::JSON) {
     auto spannedSource = std::span(buffer, bufferSize);
     auto const parsed_result = json::parse(spannedSource.begin(), spannedSource.end());
 
     assert(parsed_result.is_object());
-    json_to_item(item, parsed_result);
+    messageToItem(item, parsed_result, decodeProperties, [](auto &&...args) { json_to_item(args...); });
 
   } else {
     throw std::runtime_error(
@@ -160,6 +1447,10 @@ auto dataspree::inference::decodeItem(char const *const buffer,
 
     auto &encodedElements = item.at<std::vector<dataspree::inference::core::Item>>("item", "encoded_elements");
 
+    // Images that are still to be decoded; the target item and the encoding of its payload.
+    std::vector<std::pair<core::Item *, std::string>> encodedImages{};
+    encodedImages.reserve(encodedElements.size());
+
     for (auto &&encodedElement : encodedElements) {
       auto const &encodedPath = encodedElement.at(0U);
       auto const encoding = encodedElement.at<std::string>(1U);
@@ -171,126 +1462,142 @@ auto dataspree::inference::decodeItem(char const *const buffer,
       }
 
       if (content != nullptr) {
-        try {
-          auto &image = *content;
-          auto &payload = image.as<std::string>();
-          Buffer data = encodingMode == EncodingMode::JSON ? Buffer(base64_decode(payload)) : Buffer(payload);
-
-          if (encoding == "MAT_RAW") {
-
-            auto const type = dataspree::inference::core::as<char>(data.get());
-            auto const type_size = dataspree::inference::core::as<uint8_t>(data.get(), 1);
-            auto const dimensions = dataspree::inference::core::as<uint64_t>(data.get(), 2);
-
-            if (dimensions == 3) {
-              auto const width = dataspree::inference::core::as<uint64_t>(data.get(), 2 + sizeof(uint64_t) * 1);
-              auto const height = dataspree::inference::core::as<uint64_t>(data.get(), 2 + sizeof(uint64_t) * 2);
-              auto const channels = dataspree::inference::core::as<uint64_t>(data.get(), 2 + sizeof(uint64_t) * 3);
-
-              auto const [cvType, size] = numpyToOpencv(type, type_size, channels);
-
-              if (size == type_size and size != 0 and cvType > 0 and cvType <= std::numeric_limits<int>::max()) {
-
-                if (width < std::numeric_limits<int>::max() && height < std::numeric_limits<int>::max()) {
-                  cv::Mat mat(static_cast<int>(width), static_cast<int>(height), static_cast<int>(cvType));
-                  memcpy(mat.data,
-                    &data.get()[2 + sizeof(uint64_t) * 4],
-                    static_cast<uint32_t>(width * height * channels * type_size));
-                  cv::cvtColor(mat, mat, cv::COLOR_RGB2BGR);
-                  image = mat;
-
-                } else {
-                  spdlog::warn("Could not decode image; width ({}) or height ({}) too large.", width, height);
-                }
-
-              } else {
-                spdlog::warn("Could not decode raw mat: {} {} -> {} {}.", type, type_size, cvType, size);
-              }
-            } else {
-              spdlog::warn("Could not decode raw mat: dimensions ({}) != 3.", dimensions);
-            }
+        if (content->find_at<std::string>() != nullptr && encoding == "IMAGE_TILE_DELTA") {
+          // Tile deltas depend on the previous frame of the same path; decode them eagerly and in order.
+          if (decodeProperties.tileDeltaDecoder == nullptr) {
+            spdlog::warn("Could not decode IMAGE_TILE_DELTA; no TileDeltaDecoder in the decode properties.");
+            continue;
+          }
 
+          std::vector<std::string> path;
+          for (auto &&p : encodedPath) { path.push_back(p.at<std::string>()); }
+          auto &encodedPayload = content->as<std::string>();
+          auto data =
+            encodingMode == EncodingMode::JSON ? Buffer(base64_decode(encodedPayload)) : Buffer(encodedPayload);
+          // NOLINTNEXTLINE(cppcoreguidelines-pro-type-reinterpret-cast)
+          auto const payload = std::span(reinterpret_cast<unsigned char const *>(data.get()), data.size());
+          if (auto mat = decodeProperties.tileDeltaDecoder->decode(fmt::format("{}", fmt::join(path, "/")), payload);
+              mat.has_value()) {
+            *content = std::move(mat.value());
+          }
 
+        } else if (encoding == "EncodingType.PointCloud") {
+          // Point clouds are transposed into their structure-of-arrays layout right away.
+          std::optional<core::PointCloud> pointCloud{};
+          if (auto *encodedPayload = content->find_at<std::string>(); encodedPayload != nullptr) {
+            auto data =
+              encodingMode == EncodingMode::JSON ? Buffer(base64_decode(*encodedPayload)) : Buffer(*encodedPayload);
+            // NOLINTNEXTLINE(cppcoreguidelines-pro-type-reinterpret-cast)
+            pointCloud = decodePointCloud(std::span(reinterpret_cast<unsigned char const *>(data.get()), data.size()));
           } else {
-
-            cv::Mat matImg;
-            matImg = cv::imdecode(cv::Mat(1, static_cast<int>(data.size()), CV_8UC1, static_cast<void *>(data.get())),
-              cv::IMREAD_UNCHANGED);
-            image = matImg;
+            pointCloud = decodePointCloud(*content);
           }
-        } catch (core::InvalidContent const &e) { spdlog::warn("Could not acquire image from payload {}.", e.what()); }
+          if (pointCloud.has_value()) { *content = std::move(pointCloud.value()); }
+
+        } else if (content->find_at<std::string>() != nullptr) {
+          encodedImages.emplace_back(content, encoding);
+        } else {
+          spdlog::warn(
+            "Could not acquire image from payload of type {}.", core::getUnderlyingValue(content->getType()));
+        }
       } else {
         std::vector<std::string> path;
         for (auto &&p : encodedPath) { path.push_back(p.at<std::string>()); }
-        spdlog::warn("Could not decode item {}", fmt::join(path, ", "));
+        if (std::vector<std::string_view> const keys(path.begin(), path.end()); !decodeProperties.filter.skips(keys)) {
+          spdlog::warn("Could not decode item {}", fmt::join(path, ", "));
+        }
+      }
+    }
+
+    auto decodePayload = [encodingMode](std::string &encodedPayload, std::string const &encoding) {
+      Buffer data = encodingMode == EncodingMode::JSON ? Buffer(base64_decode(encodedPayload)) : Buffer(encodedPayload);
+      return decodeImage(data, encoding);
+    };
+
+    if (decodeProperties.lazyImageDecoding) {
+      for (auto &&[image, encoding] : encodedImages) {
+        // Failures throw, such that accessing the image fails like the access of an image that could not be decoded
+        // eagerly (and the non-throwing accessors return nullptr) instead of yielding an empty image.
+        auto decoder = [decodePayload, encoding = std::move(encoding)](std::string &encodedPayload) {
+          auto decoded = decodePayload(encodedPayload, encoding);
+          if (!decoded.has_value()) {
+            throw std::runtime_error(fmt::format("Could not decode image with encoding {}.", encoding));
+          }
+          return std::move(decoded.value());
+        };
+        *image = core::LazyMat(std::move(image->as<std::string>()), std::move(decoder));
+      }
+
+    } else if (decodeProperties.decodePool != nullptr && encodedImages.size() > 1) {
+      // Payloads are only read by the workers; the items are replaced after all of them have finished.
+      std::vector<std::future<std::optional<cv::Mat>>> decodedImages{};
+      decodedImages.reserve(encodedImages.size());
+      WaitGuard const waitGuard(decodedImages);
+      for (auto &&[image, encoding] : encodedImages) {
+        decodedImages.push_back(decodeProperties.decodePool->submit(
+          [&decodePayload, &payload = image->as<std::string>(), &encoding = encoding]() {
+            return decodePayload(payload, encoding);
+          }));
+      }
+
+      // Join all workers before rethrowing any of their exceptions; they reference the payloads.
+      for (auto &&decodedImage : decodedImages) { decodedImage.wait(); }
+      for (std::size_t i = 0; i < encodedImages.size(); ++i) {
+        if (auto mat = decodedImages[i].get(); mat.has_value()) { *encodedImages[i].first = std::move(mat.value()); }
+      }
+
+    } else {
+      for (auto &&[image, encoding] : encodedImages) {
+        if (auto mat = decodePayload(image->as<std::string>(), encoding); mat.has_value()) {
+          *image = std::move(mat.value());
+        }
       }
     }
   }
 
-  return item;
 }
 
 
-auto encodeImage(cv::Mat const &image, std::string const &encoding, dataspree::inference::EncodingMode encodingMode)
-  -> dataspree::inference::core::Item {
+auto dataspree::inference::encodeImage(cv::Mat const &image, std::string const &encoding)
+  -> std::vector<unsigned char> {
 
   std::vector<unsigned char> image_bytes{};
   if (encoding == "IMAGE_PNG" or encoding == "IMAGE_JSON") {
-    cv::Mat dest{};
-    cv::cvtColor(image, dest, cv::COLOR_BGR2RGB);
-
     cv::imencode(encoding == "IMAGE_PNG" ? ".png" : ".jpg", image, image_bytes);
 
   } else if (encoding == "MAT_RAW") {
-    auto const width = image.rows;
-    auto const height = image.cols;
-    auto const channels = image.channels();
-    auto const dataTypeSize = image.elemSize1();
-
-    if (width < 0 || height < 0 || channels < 0 || dataTypeSize > std::numeric_limits<uint8_t>::max()) {
-      return dataspree::inference::core::Item{};
-    }
-    cv::Mat transformedImage;
-    cv::cvtColor(image, transformedImage, cv::COLOR_RGB2BGR);
-
-    auto const imageDataSize =
-      static_cast<uint64_t>(width) * static_cast<uint64_t>(height) * static_cast<uint64_t>(channels) * dataTypeSize;
-    auto const dataSize = 2 + 8 * 4 + imageDataSize;
-    image_bytes = std::vector<unsigned char>(dataSize);
-    assert(image_bytes.size() == dataSize);
-
-    if (auto const numpyType = opencvToNumpy(image.depth()); numpyType != 0) {
-      image_bytes[0] = static_cast<unsigned char>(numpyType);
-
-      image_bytes[1] = static_cast<uint8_t>(dataTypeSize);
+    image_bytes = writeMatRaw(image, 0, true);
 
-      auto const lenShape = dataspree::inference::core::toLittleEndian(3);
-      std::memcpy(&(image_bytes[2]), &lenShape, 8);
+  } else if (encoding == "MAT_RAW_F16") {
+    image_bytes = encodeMatRawF16(image);
 
-      auto const convWidth = dataspree::inference::core::toLittleEndian(width);
-      std::memcpy(&(image_bytes[2 + 8]), &convWidth, 8);
+  } else if (encoding == "MAT_RAW_Q8") {
+    image_bytes = encodeMatRawQuantized(image, CV_8U);
 
-      auto const convHeight = dataspree::inference::core::toLittleEndian(height);
-      std::memcpy(&(image_bytes[2 + 8 * 2]), &convHeight, 8);
+  } else if (encoding == "MAT_RAW_Q16") {
+    image_bytes = encodeMatRawQuantized(image, CV_16U);
 
-      auto const convChannels = dataspree::inference::core::toLittleEndian(channels);
-      std::memcpy(&(image_bytes[2 + 8 * 3]), &convChannels, 8);
+  } else if (encoding == "IMAGE_QOI") {
+    image_bytes = qoiEncode(image);
 
-      auto imageDataStart = &(image_bytes[2 + 8 * 4]);
-      std::memcpy(imageDataStart, transformedImage.data, imageDataSize);
-      dataspree::inference::core::toLittleEndian(imageDataStart, imageDataSize, dataTypeSize);
-
-    } else {
-      spdlog::error("Type {} not convertible to numpy yet.", image.type());
-      return dataspree::inference::core::Item{};
-    }
+  } else if (encoding == "IMAGE_TILE_DELTA") {
+    spdlog::error("Encoding IMAGE_TILE_DELTA is stateful; use a TileDeltaEncoder.");
+    return {};
 
   } else {
 
     spdlog::error("Encoding {} not implemented yet.", encoding);
-    return dataspree::inference::core::Item{};
+    return {};
   }
 
+  return image_bytes;
+}
+
+/// Wrap an encoded image payload into an item (base64-encoded for JSON).
+[[nodiscard]] auto payloadToItem(std::vector<unsigned char> const &image_bytes,
+  dataspree::inference::EncodingMode encodingMode) -> dataspree::inference::core::Item {
+  if (image_bytes.empty()) { return dataspree::inference::core::Item{}; }
+
   dataspree::inference::core::Item item;
   if (encodingMode == dataspree::inference::EncodingMode::JSON) {
     auto encoded = base64_encode(image_bytes);
@@ -301,24 +1608,91 @@ auto encodeImage(cv::Mat const &image, std::string const &encoding, dataspree::i
   return item;
 }
 
+auto encodeImage(cv::Mat const &image, std::string const &encoding, dataspree::inference::EncodingMode encodingMode)
+  -> dataspree::inference::core::Item {
+  return payloadToItem(dataspree::inference::encodeImage(image, encoding), encodingMode);
+}
+
+/// Encode the image at #path according to #encodeProperties: IMAGE_TILE_DELTA is encoded relative to the frame
+/// previously sent on the same path; other payloads are reused from the image cache if the same image has been
+/// encoded before.
+/// \return the payload, which is shared with the image cache.
+[[nodiscard]] auto encodeImage(cv::Mat const &image,
+  std::string const &encoding,
+  dataspree::inference::EncodingMode encodingMode,
+  std::vector<std::string> const &path,
+  dataspree::inference::EncodeProperties const &encodeProperties)
+  -> std::shared_ptr<dataspree::inference::core::Item const> {
+
+  if (encoding == "IMAGE_TILE_DELTA") {
+    // The payload depends on the previously sent frame; caching it would desynchronize the receiver.
+    if (encodeProperties.tileDeltaEncoder == nullptr) {
+      spdlog::error("Encoding IMAGE_TILE_DELTA requires a TileDeltaEncoder in the encode properties.");
+      return std::make_shared<dataspree::inference::core::Item const>();
+    }
+    return std::make_shared<dataspree::inference::core::Item const>(payloadToItem(
+      encodeProperties.tileDeltaEncoder->encode(fmt::format("{}", fmt::join(path, "/")), image), encodingMode));
+  }
+
+  auto *const imageCache = encodeProperties.imageCache.get();
+  if (imageCache == nullptr) {
+    return std::make_shared<dataspree::inference::core::Item const>(encodeImage(image, encoding, encodingMode));
+  }
+
+  auto key = imageCache->key(
+    image, fmt::format("{}/{}", encoding, dataspree::inference::core::getUnderlyingValue(encodingMode)));
+  if (auto cached = imageCache->find(key); cached != nullptr) { return cached; }
+
+  auto encoded = std::make_shared<dataspree::inference::core::Item const>(encodeImage(image, encoding, encodingMode));
+  if (auto const *encodedString = encoded->find_at<std::string>(); encodedString != nullptr) {
+    imageCache->insert(std::move(key), encoded, encodedString->size());
+  } else if (auto const *encodedBytes = encoded->find_at<std::vector<unsigned char>>(); encodedBytes != nullptr) {
+    imageCache->insert(std::move(key), encoded, encodedBytes->size());
+  }
+  return encoded;
+}
+
 // Structures for transforming data from json and msgpack representation into internal Item representation.
 
 /// @dev: transform to iterative call.
 // NOLINTNEXTLINE(misc-no-recursion)
-auto json_to_item(dataspree::inference::core::Item &rootItem, json const &root_result) -> void {
+auto json_to_item(dataspree::inference::core::Item &rootItem, json const &root_result, ParseContext *context) -> void {
 
   if (root_result.is_object()) {
+    auto &map = reuseMap(rootItem);
+    std::size_t present{ 0 };
+
 #pragma unroll 10
-    for (auto const &[key, value] : root_result.items()) { json_to_item(rootItem[key], value); }
+    for (auto const &[key, value] : root_result.items()) {
+      ParseContext::Scope const scope(context, key);
+      if (scope.decodedSeparately(&value)) {
+        present += static_cast<std::size_t>(map.contains(key) ? 1 : 0);
+      } else if (scope.skips(&value)) {
+        map.erase(key);
+      } else {
+        json_to_item(map[key], value, scope.children());
+        ++present;
+      }
+    }
+
+    // Keys of the previous message that are not part of this one.
+    if (map.size() > present) {
+      std::erase_if(map, [&root_result](auto const &entry) { return !root_result.contains(entry.first); });
+    }
+
   } else if (root_result.is_array()) {
-    auto vec_item = std::vector<dataspree::inference::core::Item>{};
+    auto &vec_item = reuseVector(rootItem);
+    std::size_t count{ 0 };
 
 #pragma unroll 10
     for (auto const &value : root_result) {
-      vec_item.emplace_back();
-      json_to_item(vec_item[vec_item.size() - 1], value);
+      if (context != nullptr && context->rejects(value)) { continue; }
+      ParseContext::Scope const scope(context, "*");
+      if (count == vec_item.size()) { vec_item.emplace_back(); }
+      json_to_item(vec_item[count++], value, scope.children());
     }
-    rootItem = vec_item;
+    vec_item.resize(count);
+
   } else {
 
     if (root_result.is_number_float()) {
@@ -334,7 +1708,7 @@ auto json_to_item(dataspree::inference::core::Item &rootItem, json const &root_r
       rootItem = nullptr;
 
     } else if (root_result.is_string()) {
-      rootItem = root_result.template get<std::string>();
+      assignString(rootItem, root_result.template get_ref<std::string const &>());
 
     } else if (root_result.is_boolean()) {
       rootItem = root_result.template get<bool>();
@@ -395,22 +1769,203 @@ template<typename T = std::string> struct [[nodiscard]] TempAppend final {
   bool const start = false;
 };
 
+/// State of a single encodeItem call. The encoded item is left untouched, such that the same item can be encoded
+/// concurrently (f.i., for several consumers or encoding modes).
+// NOLINTNEXTLINE(altera-struct-pack-align)
+struct [[nodiscard]] EncodeContext final {
+
+  /// \return encoding of the element at #path; registers #encoding for #path if no encoding is declared for it.
+  [[nodiscard]] auto encodingOf(std::vector<std::string> const &path, std::string encoding) -> std::string {
+    auto const matches = [&path](auto const &encodedElement) { return encodedElement.at(0U) == path; };
+
+    if (this->declaredElements != nullptr) {
+      if (auto const declared = std::ranges::find_if(*this->declaredElements, matches);
+          declared != this->declaredElements->end()) {
+        return declared->template at<std::string>(1U);
+      }
+    }
+    if (auto const added = std::ranges::find_if(this->addedElements, matches); added != this->addedElements.end()) {
+      return added->template at<std::string>(1U);
+    }
+
+    this->addedElements.emplace_back(std::vector<dataspree::inference::core::Item>{
+      dataspree::inference::core::Item{ path }, dataspree::inference::core::Item{ encoding } });
+    return encoding;
+  }
+
+  /// \return number of encoded elements of the message.
+  [[nodiscard]] auto numberOfElements() const noexcept -> std::size_t {
+    return (this->declaredElements != nullptr ? this->declaredElements->size() : 0) + this->addedElements.size();
+  }
+
+  /// Invoke #function for all encoded elements of the message; declared encodings first.
+  template<typename Function> auto forEachElement(Function &&function) const -> void {
+    // NOLINTBEGIN(altera-unroll-loops)
+    if (this->declaredElements != nullptr) {
+      for (auto const &element : *this->declaredElements) { function(element); }
+    }
+    for (auto const &element : this->addedElements) { function(element); }
+    // NOLINTEND(altera-unroll-loops)
+  }
+
+  /// \return true if #image is sent from its own data rather than from an encoded payload (see isMatRawAsIs).
+  [[nodiscard]] auto referencesImage(cv::Mat const &image, std::string const &encoding) const -> bool {
+    return this->payloads != nullptr && isMatRawAsIs(image, encoding);
+  }
+
+  /// \return #payload itself, which must then be packed within the calling expression, or, if the message refers to
+  ///         its payloads, the payload moved into #payloads, where it is kept alive until the message is sent.
+  [[nodiscard]] auto retain(dataspree::inference::core::Item &&payload) -> dataspree::inference::core::Item const & {
+    if (this->payloads == nullptr) { return payload; }
+    return this->payloads->owned.emplace_back(std::move(payload));
+  }
+
+  /// \return the shared #payload, which is kept alive until the message is sent if the message refers to its
+  ///         payloads.
+  [[nodiscard]] auto retain(std::shared_ptr<dataspree::inference::core::Item const> const &payload)
+    -> dataspree::inference::core::Item const & {
+    if (this->payloads != nullptr) { this->payloads->shared.push_back(payload); }
+    return *payload;
+  }
+
+  std::string preferredImageEncoding;
+
+  dataspree::inference::EncodeProperties const &encodeProperties;
+
+  /// Payloads are base64 strings in JSON and binary in MSGPACK.
+  dataspree::inference::EncodingMode encodingMode{ dataspree::inference::EncodingMode::JSON };
+
+  /// The "item" of the message; its key "encoded_elements" is written after all of its content is encoded.
+  dataspree::inference::core::Item const *messageItem{ nullptr };
+
+  /// Encodings declared in the message; may be nullptr.
+  std::vector<dataspree::inference::core::Item> const *declaredElements{ nullptr };
+
+  /// Elements without declared encoding, in order of their appearance.
+  std::vector<dataspree::inference::core::Item> addedElements{};
+
+  /// Payloads of images that were encoded ahead of the tree walk, by image item.
+  std::unordered_map<dataspree::inference::core::Item const *,
+    std::shared_ptr<dataspree::inference::core::Item const>>
+    encodedImages{};
+
+  /// Payloads that the message refers to instead of copying them; nullptr if the message copies all payloads.
+  RetainedPayloads *payloads{ nullptr };
+};
+
+/// Image of a message that is encoded ahead of the tree walk.
+// NOLINTNEXTLINE(altera-struct-pack-align)
+struct PendingImage {
+  dataspree::inference::core::Item const *item;
+  std::vector<std::string> path;
+  std::string encoding;
+};
+
+/// Collect the images below #item and register the encodings of all encoded elements in the order of the tree walk.
 // NOLINTNEXTLINE(misc-no-recursion)
-auto item_to_json(dataspree::inference::core::Item &item,
+auto collectImages(dataspree::inference::core::Item const &item,
+  TempAppend<std::string> const &path,
+  EncodeContext &context,
+  std::vector<PendingImage> &images) -> void {
+
+  // NOLINTBEGIN(altera-unroll-loops)
+  switch (item.getType()) {
+  case dataspree::inference::core::ItemType::OBJECT:
+    for (auto const &[key, value] : item.items()) {
+      if (std::addressof(item) != context.messageItem || key != "encoded_elements") {
+        TempAppend<std::string> const tap{ path, key };
+        collectImages(value, tap, context, images);
+      }
+    }
+    break;
+
+  case dataspree::inference::core::ItemType::ARRAY:
+    for (auto const &value : item) { collectImages(value, path, context, images); }
+    break;
+
+  case dataspree::inference::core::ItemType::LAZY_MAT:
+    [[fallthrough]];
+  case dataspree::inference::core::ItemType::MAT: {
+    auto encoding = context.encodingOf(
+      *path.data, context.preferredImageEncoding.empty() ? "MAT_RAW" : context.preferredImageEncoding);
+    if (!context.referencesImage(item.at<cv::Mat>(), encoding)) {
+      images.push_back({ .item = &item, .path = *path.data, .encoding = std::move(encoding) });
+    }
+    break;
+  }
+
+  case dataspree::inference::core::ItemType::POINT_CLOUD:
+    (void)context.encodingOf(*path.data, "EncodingType.PointCloud");
+    break;
+
+  default:
+    break;
+  }
+  // NOLINTEND(altera-unroll-loops)
+}
+
+/// Encode the images below #roots concurrently on the encode pool; the tree walk then emits the precomputed payloads.
+/// Messages with less than two images are left to the tree walk.
+/// \param roots items in the order in which they are serialized.
+auto encodeImagesAhead(std::span<dataspree::inference::core::Item const *const> roots, EncodeContext &context)
+  -> void {
+  auto *const pool = context.encodeProperties.encodePool.get();
+  if (pool == nullptr) { return; }
+
+  std::vector<std::string> path;
+  auto tap = TempAppend(&path);
+  std::vector<PendingImage> images{};
+  // NOLINTNEXTLINE(altera-unroll-loops)
+  for (auto const *root : roots) { collectImages(*root, tap, context, images); }
+  if (images.size() < 2) { return; }
+
+  std::vector<std::future<std::shared_ptr<dataspree::inference::core::Item const>>> encodedImages{};
+  encodedImages.reserve(images.size());
+  dataspree::inference::WaitGuard const waitGuard(encodedImages);
+  // NOLINTBEGIN(altera-unroll-loops)
+  for (auto const &image : images) {
+    encodedImages.push_back(
+      pool->submit([&image, &encodeProperties = context.encodeProperties, encodingMode = context.encodingMode]() {
+        return encodeImage(image.item->at<cv::Mat>(), image.encoding, encodingMode, image.path, encodeProperties);
+      }));
+  }
+
+  // Join all workers before rethrowing any of their exceptions; they reference the images.
+  for (auto &&encodedImage : encodedImages) { encodedImage.wait(); }
+  for (std::size_t i = 0; i < images.size(); ++i) {
+    context.encodedImages.emplace(images[i].item, encodedImages[i].get());
+  }
+  // NOLINTEND(altera-unroll-loops)
+}
+
+/// \return payload of the image #item, encoded ahead of the tree walk if possible.
+[[nodiscard]] auto encodeImageAt(dataspree::inference::core::Item const &item,
+  std::vector<std::string> const &path,
+  EncodeContext &context) -> std::shared_ptr<dataspree::inference::core::Item const> {
+  auto const encoding =
+    context.encodingOf(path, context.preferredImageEncoding.empty() ? "MAT_RAW" : context.preferredImageEncoding);
+
+  if (auto encoded = context.encodedImages.find(std::addressof(item)); encoded != context.encodedImages.end()) {
+    return std::move(encoded->second);
+  }
+  return encodeImage(item.at<cv::Mat>(), encoding, context.encodingMode, path, context.encodeProperties);
+}
+
+// NOLINTNEXTLINE(misc-no-recursion)
+auto item_to_json(dataspree::inference::core::Item const &item,
   json &json_object,
   TempAppend<std::string> const &path,
-  dataspree::inference::core::Item &rootItem,
-  std::string preferredImageEncoding) -> void {
+  EncodeContext &context) -> void {
 
   // NOLINTBEGIN(altera-unroll-loops)
   switch (item.getType()) {
   case dataspree::inference::core::ItemType::OBJECT:
     json_object = json::object();
-    for (auto &[key, value] : item.items()) {
+    for (auto const &[key, value] : item.items()) {
 
-      if (std::addressof(item) != std::addressof(rootItem) || key != "encoded_elements") {
+      if (std::addressof(item) != context.messageItem || key != "encoded_elements") {
         TempAppend<std::string> const tap{ path, key };
-        item_to_json(value, json_object[key.c_str()], tap, rootItem, preferredImageEncoding);
+        item_to_json(value, json_object[key.c_str()], tap, context);
       }
     }
     break;
@@ -418,9 +1973,9 @@ auto item_to_json(dataspree::inference::core::Item &item,
   case dataspree::inference::core::ItemType::ARRAY:
 
     json_object = json::array();
-    for (auto &value : item) {
+    for (auto const &value : item) {
       json_object.push_back("");
-      item_to_json(value, json_object[json_object.size() - 1], path, rootItem, preferredImageEncoding);
+      item_to_json(value, json_object[json_object.size() - 1], path, context);
     }
     break;
 
@@ -483,31 +2038,31 @@ auto item_to_json(dataspree::inference::core::Item &item,
     json_object = item.template at<std::vector<unsigned char>>();
     break;
 
+  case dataspree::inference::core::ItemType::LAZY_MAT:
+    [[fallthrough]];
   case dataspree::inference::core::ItemType::MAT: {
-    auto const &mat = item.template at<cv::Mat>();
-
-    auto &encodedElements = rootItem.at<std::vector<dataspree::inference::core::Item>>("encoded_elements");
-
-    bool found{ false };
-    std::string encoding = preferredImageEncoding.empty() ? "MAT_RAW" : preferredImageEncoding;
-    for (auto &&encodedElement : encodedElements) {
-      auto const &encodedPath = encodedElement.at(0U);
+    auto const encoded_item = encodeImageAt(item, *path.data, context);
+    item_to_json(*encoded_item, json_object, path, context);
 
-      if (encodedPath == *(path.data)) {
-        encoding = encodedElement.at<std::string>(1U);
-        found = true;
-        break;
-      }
+    break;
+  }
+  case dataspree::inference::core::ItemType::DETECTIONS:
+    json_object = json::array();
+    for (auto const &detection : item.template at<std::vector<dataspree::inference::core::Detection>>()) {
+      json entry = json::object();
+      for (auto const &[key, field] : detectionFields) { entry[key] = detection.*field; }
+      entry["label"] = detection.label;
+      json_object.push_back(std::move(entry));
     }
+    break;
 
-    // Write encoding into the item if not already there
-    if (!found) {
-      encodedElements.emplace_back(std::vector<dataspree::inference::core::Item>{
-        dataspree::inference::core::Item{ *path.data }, dataspree::inference::core::Item{ encoding } });
-    }
-    dataspree::inference::core::Item encoded_item =
-      encodeImage(mat, encoding, dataspree::inference::EncodingMode::JSON);
-    item_to_json(encoded_item, json_object, path, encoded_item, preferredImageEncoding);
+  case dataspree::inference::core::ItemType::POINT_CLOUD: {
+    (void)context.encodingOf(*path.data, "EncodingType.PointCloud");
+
+    dataspree::inference::core::Item const encoded_item = payloadToItem(
+      dataspree::inference::encodePointCloud(item.template at<dataspree::inference::core::PointCloud>()),
+      dataspree::inference::EncodingMode::JSON);
+    item_to_json(encoded_item, json_object, path, context);
 
     break;
   }
@@ -521,48 +2076,94 @@ auto item_to_json(dataspree::inference::core::Item &item,
   // NOLINTEND(altera-unroll-loops)
 }
 
-auto item_to_json(dataspree::inference::core::Item &item, std::string preferredImageEncoding) -> json {
+auto item_to_json(dataspree::inference::core::Item const &item,
+  std::string preferredImageEncoding,
+  dataspree::inference::EncodeProperties const &encodeProperties) -> json {
   json json_root{};
   std::vector<std::string> path;
   auto tap = TempAppend(&path);
 
-  for (auto &[key, value] : item.items()) {
-    item_to_json(value, json_root[key.c_str()], tap, value, preferredImageEncoding);
+  auto const *const messageItem = item.find_at("item");
+  EncodeContext context{ .preferredImageEncoding = std::move(preferredImageEncoding),
+    .encodeProperties = encodeProperties,
+    .messageItem = messageItem,
+    .declaredElements =
+      messageItem != nullptr ? messageItem->find_at<std::vector<dataspree::inference::core::Item>>("encoded_elements")
+                             : nullptr };
+
+  if (context.encodeProperties.encodePool != nullptr) {
+    std::vector<dataspree::inference::core::Item const *> roots{};
+    // NOLINTNEXTLINE(altera-unroll-loops)
+    for (auto const &[key, value] : item.items()) { roots.push_back(&value); }
+    encodeImagesAhead(roots, context);
   }
 
-  (void)item.at<std::vector<dataspree::inference::core::Item>>("item", "encoded_elements");
-  item_to_json(
-    item["item"]["encoded_elements"], json_root["item"]["encoded_elements"], tap, item, preferredImageEncoding);
+  for (auto const &[key, value] : item.items()) { item_to_json(value, json_root[key.c_str()], tap, context); }
+
+  // Encodings of all encoded elements, including the ones that were not declared.
+  if (messageItem != nullptr && messageItem->getType() == dataspree::inference::core::ItemType::OBJECT) {
+    auto &encodedElements = json_root["item"]["encoded_elements"];
+    encodedElements = json::array();
+    context.forEachElement([&encodedElements, &tap, &context](auto const &element) {
+      encodedElements.push_back("");
+      item_to_json(element, encodedElements[encodedElements.size() - 1], tap, context);
+    });
+  }
 
   return json_root;
 }
 
 
 // NOLINTNEXTLINE(misc-no-recursion)
-auto msgpack_to_item(dataspree::inference::core::Item &rootItem, msgpack::v3::object const &root_result) -> void {
+auto msgpack_to_item(dataspree::inference::core::Item &rootItem,
+  msgpack::v3::object const &root_result,
+  ParseContext *context) -> void {
   // xx NOLINTBEGIN(cppcoreguidelines-pro-type-union-access,altera-unroll-loops)
 
   switch (root_result.type) {
-  case msgpack::v3::type::MAP:
+  case msgpack::v3::type::MAP: {
+    auto &map = reuseMap(rootItem);
+    std::size_t present{ 0 };
 
     for (auto const &[key, value] : root_result.via.map) {
-      auto const keyString = std::string(key.via.str.ptr, key.via.str.size);
-      msgpack_to_item(rootItem[keyString], value);
+      // Keys are looked up in place; only new keys are copied into the map.
+      auto const keyView = std::string_view(key.via.str.ptr, key.via.str.size);
+      ParseContext::Scope const scope(context, keyView);
+      auto entry = map.lower_bound(keyView);
+      auto const found = entry != map.end() && entry->first == keyView;
+      if (scope.decodedSeparately(&value)) {
+        present += static_cast<std::size_t>(found ? 1 : 0);
+      } else if (scope.skips(&value)) {
+        if (found) { map.erase(entry); }
+      } else {
+        if (!found) { entry = map.emplace_hint(entry, keyView, dataspree::inference::core::Item{}); }
+        msgpack_to_item(entry->second, value, scope.children());
+        ++present;
+      }
+    }
+
+    // Keys of the previous message that are not part of this one.
+    if (map.size() > present) {
+      std::erase_if(map, [&root_result](auto const &entry) { return !msgpackContains(root_result, entry.first); });
     }
     break;
+  }
 
   case msgpack::v3::type::ARRAY: {
-    auto vec_item = std::vector<dataspree::inference::core::Item>{};
+    auto &vec_item = reuseVector(rootItem);
+    std::size_t count{ 0 };
     for (const auto &value : root_result.via.array) {
-      vec_item.emplace_back();
-      msgpack_to_item(vec_item[vec_item.size() - 1], value);
+      if (context != nullptr && context->rejects(value)) { continue; }
+      ParseContext::Scope const scope(context, "*");
+      if (count == vec_item.size()) { vec_item.emplace_back(); }
+      msgpack_to_item(vec_item[count++], value, scope.children());
     }
-    rootItem = vec_item;
+    vec_item.resize(count);
     break;
   }
 
   case msgpack::v3::type::BIN:
-    rootItem = std::string(root_result.via.bin.ptr, root_result.via.bin.size);
+    assignString(rootItem, std::string_view(root_result.via.bin.ptr, root_result.via.bin.size));
     break;
 
   case msgpack::v3::type::BOOLEAN:
@@ -594,7 +2195,7 @@ auto msgpack_to_item(dataspree::inference::core::Item &rootItem, msgpack::v3::ob
     break;
 
   case msgpack::v3::type::STR:
-    rootItem = std::string(root_result.via.str.ptr, root_result.via.str.size);
+    assignString(rootItem, std::string_view(root_result.via.str.ptr, root_result.via.str.size));
     break;
 
   default:
@@ -605,23 +2206,26 @@ auto msgpack_to_item(dataspree::inference::core::Item &rootItem, msgpack::v3::ob
   // xx NOLINTEND(cppcoreguidelines-pro-type-union-access,altera-unroll-loops)
 }
 
+template<typename Stream>
 // NOLINTNEXTLINE(altera-unroll-loops, misc-no-recursion)
-auto item_to_msgpack(dataspree::inference::core::Item &item,
-  msgpack::packer<msgpack::sbuffer> &packer,
+auto item_to_msgpack(dataspree::inference::core::Item const &item,
+  msgpack::packer<Stream> &packer,
   TempAppend<std::string> const &path,
-  dataspree::inference::core::Item &rootItem,
-  std::string preferredImageEncoding) -> void {
+  EncodeContext &context) -> void {
 
   // NOLINTBEGIN(altera-unroll-loops)
   switch (item.getType()) {
-  case dataspree::inference::core::ItemType::OBJECT:
-    if (auto const mapSize = item.items().size(); mapSize < std::numeric_limits<uint32_t>::max()) {
+  case dataspree::inference::core::ItemType::OBJECT: {
+    // The encoded elements of the message item are packed as its last entry once all of its content is encoded.
+    auto const appendsElements = std::addressof(item) == context.messageItem && !item.contains("encoded_elements");
+    if (auto const mapSize = item.items().size() + (appendsElements ? 1 : 0);
+        mapSize < std::numeric_limits<uint32_t>::max()) {
       packer.pack_map(static_cast<uint32_t>(mapSize));
-      for (auto &[key, value] : item.items()) {
+      for (auto const &[key, value] : item.items()) {
 
-        if (std::addressof(item) != std::addressof(rootItem) || key != "encoded_elements") {
+        if (std::addressof(item) != context.messageItem || key != "encoded_elements") {
           packer.pack(key);
-          item_to_msgpack(value, packer, TempAppend<std::string>(path, key), rootItem, preferredImageEncoding);
+          item_to_msgpack(value, packer, TempAppend<std::string>(path, key), context);
         }
       }
     } else {
@@ -631,12 +2235,13 @@ auto item_to_msgpack(dataspree::inference::core::Item &item,
       packer.pack_str_body(str.data(), static_cast<uint32_t>(str.size()));
     }
     break;
+  }
 
   case dataspree::inference::core::ItemType::ARRAY:
 
     if (auto const vecSize = item.size(); vecSize < std::numeric_limits<uint32_t>::max()) {
       packer.pack_array(static_cast<uint32_t>(vecSize));
-      for (auto &value : item) { item_to_msgpack(value, packer, path, rootItem, preferredImageEncoding); }
+      for (auto const &value : item) { item_to_msgpack(value, packer, path, context); }
     } else {
       constexpr std::string_view str = "[n/a] (Too large vector)";
       static_assert(str.size() <= std::numeric_limits<uint32_t>::max());
@@ -697,7 +2302,7 @@ auto item_to_msgpack(dataspree::inference::core::Item &item,
     break;
 
   case dataspree::inference::core::ItemType::STRING:
-    if (auto const content = item.template at<std::string>(); content.size() < std::numeric_limits<uint32_t>::max()) {
+    if (auto const &content = item.template at<std::string>(); content.size() < std::numeric_limits<uint32_t>::max()) {
       auto const stringSize = static_cast<uint32_t>(content.size());
       packer.pack_str(stringSize);
       packer.pack_str_body(content.c_str(), stringSize);
@@ -723,9 +2328,10 @@ auto item_to_msgpack(dataspree::inference::core::Item &item,
     break;
   }
   case dataspree::inference::core::ItemType::BYTE_ARRAY:
-    if (auto const content = item.template at<std::vector<unsigned char>>();
+    if (auto const &content = item.template at<std::vector<unsigned char>>();
         content.size() < std::numeric_limits<uint32_t>::max()) {
       auto const contentSize = static_cast<uint32_t>(content.size());
+      packer.pack_bin(contentSize);
       // NOLINTNEXTLINE(cppcoreguidelines-pro-type-reinterpret-cast)
       packer.pack_bin_body(reinterpret_cast<char const *>(content.data()), contentSize);
     } else {
@@ -736,33 +2342,57 @@ auto item_to_msgpack(dataspree::inference::core::Item &item,
     }
     break;
 
+  case dataspree::inference::core::ItemType::LAZY_MAT:
+    [[fallthrough]];
   case dataspree::inference::core::ItemType::MAT: {
-    auto const &mat = item.template at<cv::Mat>();
-
-    bool found{ false };
-    std::string encoding = preferredImageEncoding.empty() ? "MAT_RAW" : preferredImageEncoding;
-    auto &encodedElements = rootItem.at<std::vector<dataspree::inference::core::Item>>("encoded_elements");
-
-    /// NOLINTNEXTLINE(altera-unroll-loops)
-    for (auto &&encodedElement : encodedElements) {
-      auto const &encodedPath = encodedElement.at(0U);
+    auto const &image = item.template at<cv::Mat>();
+    auto const encoding = context.encodingOf(
+      *path.data, context.preferredImageEncoding.empty() ? "MAT_RAW" : context.preferredImageEncoding);
+    if (auto const dataSize = image.total() * image.elemSize();
+        context.referencesImage(image, encoding) && dataSize < std::numeric_limits<uint32_t>::max() - 1024) {
+      // The header is copied into the message, the data is sent from the image.
+      auto const shape = matRawShape(image);
+      std::array<unsigned char, matRawRankSize + sizeof(uint64_t) * (CV_MAX_DIM + 1)> header{};
+      static_assert(header.size() < minReferencedSize);
+      auto const headerSize = matRawHeaderSize(shape);
+      writeMatRawHeader(image, shape, header.data());
+
+      packer.pack_bin(static_cast<uint32_t>(headerSize + dataSize));
+      // NOLINTBEGIN(cppcoreguidelines-pro-type-reinterpret-cast)
+      packer.pack_bin_body(reinterpret_cast<char const *>(header.data()), static_cast<uint32_t>(headerSize));
+      packer.pack_bin_body(reinterpret_cast<char const *>(image.data), static_cast<uint32_t>(dataSize));
+      // NOLINTEND(cppcoreguidelines-pro-type-reinterpret-cast)
+      (void)context.retain(dataspree::inference::core::Item{ image });
+      break;
+    }
 
-      if (encodedPath == *(path.data)) {
-        encoding = encodedElement.at<std::string>(1U);
-        found = true;
-        break;
+    item_to_msgpack(context.retain(encodeImageAt(item, *path.data, context)), packer, path, context);
+    break;
+  }
+  case dataspree::inference::core::ItemType::DETECTIONS: {
+    auto const &detections = item.template at<std::vector<dataspree::inference::core::Detection>>();
+    packer.pack_array(static_cast<uint32_t>(detections.size()));
+    for (auto const &detection : detections) {
+      packer.pack_map(static_cast<uint32_t>(detectionFields.size() + 1));
+      for (auto const &[key, field] : detectionFields) {
+        packer.pack_str(static_cast<uint32_t>(key.size()));
+        packer.pack_str_body(key.data(), static_cast<uint32_t>(key.size()));
+        packer.pack_float(detection.*field);
       }
+      packer.pack_str(5);
+      packer.pack_str_body("label", 5);
+      packer.pack_str(static_cast<uint32_t>(detection.label.size()));
+      packer.pack_str_body(detection.label.data(), static_cast<uint32_t>(detection.label.size()));
     }
+    break;
+  }
 
-    // Write encoding into the item if not already there
-    if (!found) {
-      encodedElements.emplace_back(std::vector<dataspree::inference::core::Item>{
-        dataspree::inference::core::Item{ *path.data }, dataspree::inference::core::Item{ encoding } });
-    }
+  case dataspree::inference::core::ItemType::POINT_CLOUD: {
+    (void)context.encodingOf(*path.data, "EncodingType.PointCloud");
 
-    dataspree::inference::core::Item encoded_item =
-      encodeImage(mat, encoding, dataspree::inference::EncodingMode::JSON);
-    item_to_msgpack(encoded_item, packer, path, encoded_item, preferredImageEncoding);
+    auto const &pointCloud = item.template at<dataspree::inference::core::PointCloud>();
+    auto encoded_item = payloadToItem(dataspree::inference::encodePointCloud(pointCloud), context.encodingMode);
+    item_to_msgpack(context.retain(std::move(encoded_item)), packer, path, context);
 
     break;
   }
@@ -780,39 +2410,69 @@ auto item_to_msgpack(dataspree::inference::core::Item &item,
   // NOLINTEND(altera-unroll-loops)
 }
 
-auto item_to_msgpack(dataspree::inference::core::Item &item, std::string preferredImageEncoding) -> msgpack::sbuffer {
-  msgpack::sbuffer sbuf;
-  msgpack::packer<msgpack::sbuffer> packer(sbuf);
+template<typename Stream>
+auto item_to_msgpack(dataspree::inference::core::Item const &item,
+  Stream &stream,
+  std::string preferredImageEncoding,
+  dataspree::inference::EncodeProperties const &encodeProperties,
+  RetainedPayloads *payloads) -> void {
+  msgpack::packer<Stream> packer(stream);
 
   std::vector<std::string> path;
+  auto const *const messageItem = item.find_at("item");
+  auto const messageObject =
+    messageItem != nullptr && messageItem->getType() == dataspree::inference::core::ItemType::OBJECT;
+  EncodeContext context{ .preferredImageEncoding = std::move(preferredImageEncoding),
+    .encodeProperties = encodeProperties,
+    .encodingMode = dataspree::inference::EncodingMode::MSGPACK,
+    .messageItem = messageObject ? messageItem : nullptr,
+    .declaredElements = messageObject
+                          ? messageItem->find_at<std::vector<dataspree::inference::core::Item>>("encoded_elements")
+                          : nullptr,
+    .payloads = payloads };
+
+  if (encodeProperties.encodePool != nullptr) {
+    std::vector<dataspree::inference::core::Item const *> roots{};
+    // NOLINTNEXTLINE(altera-unroll-loops)
+    for (auto const &[key, value] : item.items()) {
+      if (key != "item") { roots.push_back(&value); }
+    }
+    if (messageItem != nullptr) { roots.push_back(messageItem); }
+    encodeImagesAhead(roots, context);
+  }
+
   packer.pack_map(static_cast<uint32_t>(item.items().size()));
-  for (auto &[key, value] : item.items()) {
+  for (auto const &[key, value] : item.items()) {
     if (key != "item") {
       packer.pack(key);
-      item_to_msgpack(value, packer, TempAppend(&path), value, preferredImageEncoding);
+      item_to_msgpack(value, packer, TempAppend(&path), context);
     }
   }
 
-  if (item.contains("item")) {
-    (void)item.at<std::vector<dataspree::inference::core::Item>>("item", "encoded_elements");
-    assert(item["item"].contains("encoded_elements"));
-
+  if (messageItem != nullptr) {
     packer.pack("item");
-    item_to_msgpack(item["item"], packer, TempAppend(&path), item["item"], preferredImageEncoding);
+    item_to_msgpack(*messageItem, packer, TempAppend(&path), context);
+    if (!messageObject) { return; }
 
+    // Last entry of the message item; encodings of all encoded elements, including the ones that were not declared.
     packer.pack("encoded_elements");
-    item_to_msgpack(item["item"]["encoded_elements"], packer, TempAppend(&path), item["item"], preferredImageEncoding);
+    packer.pack_array(static_cast<uint32_t>(context.numberOfElements()));
+    context.forEachElement([&packer, &path, &context](auto const &element) {
+      item_to_msgpack(element, packer, TempAppend(&path), context);
+    });
+    if (payloads != nullptr) { payloads->owned.emplace_back(std::move(context.addedElements)); }
   }
-
-  return sbuf;
 }
 
 [[nodiscard]] auto base64_decode(std::string const &src) -> std::vector<char> {
   auto const targetSize = boost::beast::detail::base64::decoded_size(src.size());
   auto vec = std::vector<char>(targetSize);
   assert(vec.size() == targetSize);
-  boost::beast::detail::base64::decode(static_cast<void *>(vec.data()), src.data(), src.size());
-  assert(vec.size() == targetSize);
+
+  // decoded_size is an upper bound; padding characters do not produce bytes.
+  auto const [written, read] =
+    boost::beast::detail::base64::decode(static_cast<void *>(vec.data()), src.data(), src.size());
+  vec.resize(written);
   return vec;
 }
 
@@ -0,0 +1,167 @@
+#include <EncodedImageCache.hpp>
+
+#include <array>
+#include <atomic>
+#include <cstring>
+#include <functional>
+#include <optional>
+#include <span>
+
+auto dataspree::inference::EncodedImageCache::setGeneration(cv::Mat const &image, uint64_t const generation) -> void {
+  std::scoped_lock const lock(this->mutex);
+  this->dropReleasedGenerations();
+
+  auto const *const buffer = bufferOf(image);
+  if (auto declared = this->generations.find(buffer); declared != this->generations.end()) {
+    declared->second.generation = generation;
+    return;
+  }
+
+  // Declarations that are still in use are dropped at random; their images are hashed again.
+  if (this->generations.size() >= this->maxEntries && !this->generations.empty()) {
+    this->generations.erase(this->generations.begin());
+  }
+  if (this->maxEntries > 0) {
+    this->generations.emplace(
+      buffer, Declaration{ .buffer = image.u != nullptr ? image : cv::Mat{}, .generation = generation });
+  }
+}
+
+auto dataspree::inference::EncodedImageCache::clearGeneration(cv::Mat const &image) -> void {
+  std::scoped_lock const lock(this->mutex);
+  this->generations.erase(bufferOf(image));
+}
+
+auto dataspree::inference::EncodedImageCache::key(cv::Mat const &image, std::string encoding) -> Key {
+  std::optional<uint64_t> generation{};
+  {
+    std::scoped_lock const lock(this->mutex);
+    this->dropReleasedGenerations();
+    if (auto const declared = this->generations.find(bufferOf(image)); declared != this->generations.end()) {
+      generation = declared->second.generation;
+    }
+  }
+
+  return Key{ .data = image.data,
+    .rows = image.rows,
+    .cols = image.cols,
+    .type = image.type(),
+    .step = image.step[0],
+    .generation = generation.has_value() ? generation.value() : hashContent(image),
+    .encoding = std::move(encoding) };
+}
+
+auto dataspree::inference::EncodedImageCache::find(Key const &key) -> Payload {
+  std::scoped_lock const lock(this->mutex);
+  if (auto const entry = this->index.find(key); entry != this->index.end()) {
+    this->entries.splice(this->entries.begin(), this->entries, entry->second);
+    this->hits.fetch_add(1, std::memory_order_relaxed);
+    return entry->second->payload;
+  }
+
+  this->misses.fetch_add(1, std::memory_order_relaxed);
+  return nullptr;
+}
+
+auto dataspree::inference::EncodedImageCache::insert(Key key, Payload payload, std::size_t const size) -> void {
+  if (size > this->maxBytes || this->maxEntries == 0) { return; }
+
+  std::scoped_lock const lock(this->mutex);
+  if (auto const entry = this->index.find(key); entry != this->index.end()) {
+    this->cachedBytes -= entry->second->size;
+    this->entries.erase(entry->second);
+    this->index.erase(entry);
+  }
+
+  this->entries.push_front(Entry{ .key = key, .payload = std::move(payload), .size = size });
+  this->index.emplace(std::move(key), this->entries.begin());
+  this->cachedBytes += size;
+  this->evict();
+}
+
+auto dataspree::inference::EncodedImageCache::clear() -> void {
+  std::scoped_lock const lock(this->mutex);
+  this->index.clear();
+  this->entries.clear();
+  this->generations.clear();
+  this->cachedBytes = 0;
+}
+
+auto dataspree::inference::EncodedImageCache::evict() -> void {
+  // NOLINTNEXTLINE(altera-unroll-loops)
+  while (!this->entries.empty()
+         && (this->entries.size() > this->maxEntries || this->cachedBytes > this->maxBytes)) {
+    auto const &last = this->entries.back();
+    this->cachedBytes -= last.size;
+    this->index.erase(last.key);
+    this->entries.pop_back();
+  }
+}
+
+auto dataspree::inference::EncodedImageCache::dropReleasedGenerations() -> void {
+  // Only the reference of the declaration is left.
+  std::erase_if(this->generations, [](auto &declared) {
+    auto &buffer = declared.second.buffer;
+    return buffer.u != nullptr && std::atomic_ref(buffer.u->refcount).load(std::memory_order_acquire) == 1;
+  });
+}
+
+auto dataspree::inference::EncodedImageCache::bufferOf(cv::Mat const &image) noexcept -> void const * {
+  return image.u != nullptr ? static_cast<void const *>(image.u) : static_cast<void const *>(image.data);
+}
+
+auto dataspree::inference::EncodedImageCache::KeyHash::operator()(Key const &key) const noexcept -> std::size_t {
+  auto hash = std::hash<void const *>{}(key.data);
+  auto const combine = [&hash](std::size_t value) {
+    hash ^= value + 0x9e3779b97f4a7c15ULL + (hash << 6U) + (hash >> 2U);
+  };
+  combine(std::hash<int>{}(key.rows));
+  combine(std::hash<int>{}(key.cols));
+  combine(std::hash<int>{}(key.type));
+  combine(std::hash<std::size_t>{}(key.step));
+  combine(std::hash<uint64_t>{}(key.generation));
+  combine(std::hash<std::string>{}(key.encoding));
+  return hash;
+}
+
+auto dataspree::inference::EncodedImageCache::hashContent(cv::Mat const &image) -> uint64_t {
+  static constexpr uint64_t multiplier = 0x9e3779b97f4a7c15ULL;
+
+  uint64_t hash = 0xcbf29ce484222325ULL;
+  auto const hashBytes = [&hash](std::span<unsigned char const> bytes) {
+    std::size_t pos = 0;
+
+    // NOLINTNEXTLINE(altera-unroll-loops)
+    for (; pos + sizeof(uint64_t) <= bytes.size(); pos += sizeof(uint64_t)) {
+      uint64_t word{};
+      std::memcpy(&word, &bytes[pos], sizeof(uint64_t));
+      hash = (hash ^ word) * multiplier;
+      hash ^= hash >> 32U;
+    }
+
+    // NOLINTNEXTLINE(altera-unroll-loops)
+    for (; pos < bytes.size(); ++pos) { hash = (hash ^ bytes[pos]) * multiplier; }
+  };
+
+  if (image.empty()) { return hash; }
+
+  auto const rowSize = static_cast<std::size_t>(image.cols) * image.elemSize();
+  if (image.isContinuous()) {
+    hashBytes(std::span(image.data, image.total() * image.elemSize()));
+
+  } else if (image.dims <= 2) {
+    // NOLINTNEXTLINE(altera-unroll-loops)
+    for (int row = 0; row < image.rows; ++row) { hashBytes(std::span(image.ptr(row), rowSize)); }
+
+  } else {
+    // The planes of an N-dimensional image are continuous.
+    std::array<cv::Mat const *, 2> images{ &image, nullptr };
+    cv::Mat plane{};
+    cv::NAryMatIterator iterator(images.data(), &plane, 1);
+    // NOLINTNEXTLINE(altera-unroll-loops)
+    for (std::size_t index = 0; index < iterator.nplanes; ++index, ++iterator) {
+      hashBytes(std::span(plane.data, plane.total() * plane.elemSize()));
+    }
+  }
+  return hash;
+}
@@ -0,0 +1,433 @@
+#include <EventLoop.hpp>
+
+#include <spdlog/spdlog.h>
+
+#include <algorithm>
+#include <array>
+#include <cerrno>
+#include <cstdint>
+#include <exception>
+#include <limits>
+#include <span>
+#include <stdexcept>
+#include <utility>
+
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <unistd.h>
+
+/// Maximum number of events that are fetched per epoll_wait.
+static constexpr std::size_t maxEvents = 256;
+
+/// Coroutine that runs a spawned task and destroys itself once the task finished.
+// NOLINTNEXTLINE(altera-struct-pack-align)
+struct SpawnedTask {
+  struct promise_type {
+    promise_type(dataspree::inference::Task<void> const & /*task*/,
+      std::unordered_set<void *> &spawned) noexcept
+      : spawned(&spawned) {}
+
+    struct FinalAwaiter {
+      [[nodiscard]] static constexpr auto await_ready() noexcept -> bool { return false; }
+
+      static auto await_suspend(std::coroutine_handle<promise_type> handle) noexcept -> void {
+        handle.promise().spawned->erase(handle.address());
+        handle.destroy();
+      }
+
+      static constexpr auto await_resume() noexcept -> void {}
+    };
+
+    [[nodiscard]] auto get_return_object() noexcept -> SpawnedTask {
+      return SpawnedTask{ std::coroutine_handle<promise_type>::from_promise(*this) };
+    }
+
+    /// Started by EventLoop::spawn once it is tracked.
+    [[nodiscard]] static constexpr auto initial_suspend() noexcept -> std::suspend_always { return {}; }
+
+    [[nodiscard]] static constexpr auto final_suspend() noexcept -> FinalAwaiter { return {}; }
+
+    static constexpr auto return_void() noexcept -> void {}
+
+    static auto unhandled_exception() noexcept -> void { spdlog::error("Spawned coroutine failed."); }
+
+    std::unordered_set<void *> *spawned;
+  };
+
+  std::coroutine_handle<promise_type> handle;
+};
+
+auto runSpawned(dataspree::inference::Task<void> task, std::unordered_set<void *> & /*spawned*/)
+  -> SpawnedTask {
+  try {
+    co_await task;
+  } catch (std::exception const &exception) {
+    spdlog::error("Spawned coroutine failed: {}.", exception.what());
+  }
+}
+
+dataspree::inference::EventLoop::EventLoop()
+  : epollFd(epoll_create1(EPOLL_CLOEXEC)), wakeFd(eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK)) {
+  // The wake up event is identified by a null registration.
+  epoll_event event{ .events = EPOLLIN, .data = { .ptr = nullptr } };
+  if (this->epollFd < 0 || this->wakeFd < 0
+      || epoll_ctl(this->epollFd, EPOLL_CTL_ADD, this->wakeFd, &event) != 0) {
+    auto const error = errno;
+    if (this->wakeFd >= 0) { ::close(this->wakeFd); }
+    if (this->epollFd >= 0) { ::close(this->epollFd); }
+    throw std::runtime_error(fmt::format("Could not create the event loop: {}.", error));
+  }
+}
+
+dataspree::inference::EventLoop::~EventLoop() {
+  // Destroying a coroutine destroys the tasks that it awaits, whose awaitables leave the loop.
+  // NOLINTNEXTLINE(altera-unroll-loops)
+  for (auto *const frame : std::exchange(this->spawned, {})) { std::coroutine_handle<>::from_address(frame).destroy(); }
+
+  ::close(this->wakeFd);
+  ::close(this->epollFd);
+}
+
+auto dataspree::inference::EventLoop::add(TcpConnection &connection, ItemCallback onItem, CloseCallback onClose)
+  -> bool {
+  if (this->registrations.contains(&connection) || !connection.setNonBlocking(true)) { return false; }
+
+  auto registration = std::make_unique<Registration>(
+    Registration{ .connection = &connection, .onItem = std::move(onItem), .onClose = std::move(onClose) });
+
+  // Level triggered: data that is left in the socket (f.i., after a large message) is reported again. Errors and
+  // hang ups are reported without interest.
+  epoll_event event{ .events = 0, .data = { .ptr = registration.get() } };
+  if (epoll_ctl(this->epollFd, EPOLL_CTL_ADD, connection.getSocket(), &event) != 0) {
+    spdlog::warn("Could not add connection to the event loop: {}.", errno);
+    return false;
+  }
+
+  auto &added = *this->registrations.emplace(&connection, std::move(registration)).first->second;
+
+  // Messages that were queued before (f.i., the handshake) are sent once the socket is writable.
+  return this->updateInterest(added);
+}
+
+auto dataspree::inference::EventLoop::remove(TcpConnection &connection) -> void {
+  if (auto const registration = this->registrations.find(&connection); registration != this->registrations.end()) {
+    this->detach(*registration->second, ReceiveStatus::CANCELLED);
+  }
+}
+
+auto dataspree::inference::EventLoop::sendItem(TcpConnection &connection,
+  core::Item const &item,
+  std::string const &consumerName) -> bool {
+  auto const registration = this->registrations.find(&connection);
+  if (!connection.sendItem(item, consumerName)) {
+    if (registration != this->registrations.end()) { this->close(*registration->second, ReceiveStatus::FAILED); }
+    return false;
+  }
+  return registration == this->registrations.end() || this->updateInterest(*registration->second);
+}
+
+auto dataspree::inference::EventLoop::receiveItemAsync(TcpConnection &connection,
+  core::Item &item,
+  std::size_t const timeoutMs,
+  std::stop_token stopToken) -> ReceiveItemAwaitable {
+  return ReceiveItemAwaitable{ *this, connection, item, timeoutMs, std::move(stopToken) };
+}
+
+auto dataspree::inference::EventLoop::sendItemAsync(TcpConnection &connection,
+  core::Item const &item,
+  std::string const &consumerName,
+  std::size_t const timeoutMs,
+  std::stop_token stopToken) -> SendItemAwaitable {
+  return SendItemAwaitable{ *this, connection, item, consumerName, timeoutMs, std::move(stopToken) };
+}
+
+auto dataspree::inference::EventLoop::spawn(Task<void> task) -> void {
+  auto const coroutine = runSpawned(std::move(task), this->spawned).handle;
+  this->spawned.insert(coroutine.address());
+  coroutine.resume();
+}
+
+auto dataspree::inference::EventLoop::post(std::function<void()> function) -> void {
+  {
+    std::scoped_lock const lock(this->postMutex);
+    this->posted.push_back(std::move(function));
+  }
+  this->wake();
+}
+
+auto dataspree::inference::EventLoop::runOnce(int timeoutMs) -> std::size_t {
+  // Wake up for the next deadline.
+  if (!this->timers.empty()) {
+    auto const untilDeadline =
+      std::chrono::ceil<std::chrono::milliseconds>(this->timers.begin()->first - Clock::now()).count();
+    auto const deadlineMs =
+      static_cast<int>(std::clamp<decltype(untilDeadline)>(untilDeadline, 0, std::numeric_limits<int>::max()));
+    timeoutMs = timeoutMs < 0 ? deadlineMs : std::min(timeoutMs, deadlineMs);
+  }
+
+  std::array<epoll_event, maxEvents> events{};
+  auto numberOfEvents = epoll_wait(this->epollFd, events.data(), static_cast<int>(events.size()), timeoutMs);
+  if (numberOfEvents < 0) {
+    if (errno != EINTR) { spdlog::warn("Waiting for events failed: {}.", errno); }
+    numberOfEvents = 0;
+  }
+
+  std::size_t numberOfMessages{ 0 };
+  // NOLINTBEGIN(altera-unroll-loops)
+  for (auto const &event : std::span(events.data(), static_cast<std::size_t>(numberOfEvents))) {
+    auto *const registration = static_cast<Registration *>(event.data.ptr);
+    if (registration == nullptr) {
+      uint64_t wakeUps{ 0 };
+      (void)::read(this->wakeFd, &wakeUps, sizeof(wakeUps));
+      continue;
+    }
+
+    // Skip connections that were removed by the callbacks (or coroutines) of previous events.
+    if (registration->connection == nullptr) { continue; }
+    auto &connection = *registration->connection;
+
+    if ((event.events & (EPOLLIN | EPOLLRDHUP | EPOLLHUP | EPOLLERR)) != 0) {
+      auto const status = connection.receiveAvailable();
+
+      // Messages that arrived before the connection was closed are still delivered.
+      numberOfMessages += this->deliver(*registration);
+      if (registration->connection == nullptr) { continue; }
+
+      if (status != ReceiveStatus::OK) {
+        this->close(*registration, status);
+        continue;
+      }
+    }
+
+    if ((event.events & EPOLLOUT) != 0) {
+      if (!connection.flushSendQueue()) {
+        this->close(*registration, ReceiveStatus::FAILED);
+        continue;
+      }
+      this->resumeSenders(*registration);
+      if (registration->connection == nullptr) { continue; }
+    }
+
+    // The callbacks and coroutines may have queued messages.
+    if (!this->updateInterest(*registration)) { this->close(*registration, ReceiveStatus::FAILED); }
+  }
+
+  std::vector<std::function<void()>> functions{};
+  {
+    std::scoped_lock const lock(this->postMutex);
+    functions.swap(this->posted);
+  }
+  for (auto const &function : functions) { function(); }
+
+  for (auto const now = Clock::now(); !this->timers.empty() && this->timers.begin()->first <= now;) {
+    complete(*this->timers.begin()->second, ReceiveStatus::TIMEOUT);
+  }
+  // NOLINTEND(altera-unroll-loops)
+
+  this->removedRegistrations.clear();
+  return numberOfMessages;
+}
+
+auto dataspree::inference::EventLoop::run() -> void {
+  // NOLINTNEXTLINE(altera-unroll-loops)
+  while (!this->stopping.exchange(false)) { (void)this->runOnce(); }
+}
+
+auto dataspree::inference::EventLoop::stop() noexcept -> void {
+  this->stopping = true;
+  this->wake();
+}
+
+auto dataspree::inference::EventLoop::wake() const noexcept -> void {
+  uint64_t const wakeUp{ 1 };
+  (void)::write(this->wakeFd, &wakeUp, sizeof(wakeUp));
+}
+
+auto dataspree::inference::EventLoop::registrationOf(TcpConnection &connection) -> Registration * {
+  auto registration = this->registrations.find(&connection);
+  if (registration == this->registrations.end()) {
+    if (!this->add(connection)) { return nullptr; }
+    registration = this->registrations.find(&connection);
+  }
+  return registration->second.get();
+}
+
+auto dataspree::inference::EventLoop::updateInterest(Registration &registration) -> bool {
+  if (registration.connection == nullptr) { return true; }
+
+  // Without receivers, messages stay in the socket, which throttles the peer.
+  uint32_t events{ 0 };
+  if (registration.onItem || !registration.receivers.empty()) { events |= EPOLLIN | EPOLLRDHUP; }
+  // Senders are resumed once the socket is writable, also if another send flushed their messages.
+  if (registration.connection->hasPendingSends() || !registration.senders.empty()) { events |= EPOLLOUT; }
+  if (events == registration.events) { return true; }
+
+  epoll_event event{ .events = events, .data = { .ptr = &registration } };
+  if (epoll_ctl(this->epollFd, EPOLL_CTL_MOD, registration.connection->getSocket(), &event) != 0) {
+    spdlog::warn("Could not update the events of a connection: {}.", errno);
+    return false;
+  }
+  registration.events = events;
+  return true;
+}
+
+auto dataspree::inference::EventLoop::deliver(Registration &registration) -> std::size_t {
+  std::size_t numberOfMessages{ 0 };
+  // NOLINTNEXTLINE(altera-unroll-loops)
+  while (registration.connection != nullptr) {
+    auto &connection = *registration.connection;
+    if (!registration.receivers.empty()) {
+      auto &receiver = *static_cast<ReceiveItemAwaitable *>(registration.receivers.front());
+      if (!connection.receiveBufferedItemInto(*receiver.item)) { break; }
+      ++numberOfMessages;
+      complete(receiver, ReceiveStatus::OK);
+    } else if (registration.onItem && connection.receiveBufferedItemInto(registration.item)) {
+      ++numberOfMessages;
+      registration.onItem(connection, registration.item);
+    } else {
+      break;
+    }
+  }
+  return numberOfMessages;
+}
+
+auto dataspree::inference::EventLoop::resumeSenders(Registration &registration) -> void {
+  // NOLINTNEXTLINE(altera-unroll-loops)
+  while (registration.connection != nullptr && !registration.senders.empty()) {
+    auto &sender = *static_cast<SendItemAwaitable *>(registration.senders.front());
+    if (registration.connection->getNumberOfMessagesSent() < sender.sentTarget) { break; }
+    complete(sender, ReceiveStatus::OK);
+  }
+}
+
+auto dataspree::inference::EventLoop::complete(Waiter &waiter, ReceiveStatus const status) -> void {
+  waiter.status = status;
+  if (auto const coroutine = waiter.unregister(); coroutine) { coroutine.resume(); }
+}
+
+auto dataspree::inference::EventLoop::detach(Registration &registration, ReceiveStatus const status) -> void {
+  auto *const connection = std::exchange(registration.connection, nullptr);
+  epoll_ctl(this->epollFd, EPOLL_CTL_DEL, connection->getSocket(), nullptr);
+
+  // The registration is kept until all events are handled.
+  auto const entry = this->registrations.find(connection);
+  this->removedRegistrations.push_back(std::move(entry->second));
+  this->registrations.erase(entry);
+
+  // Coroutines that wait again are queued at a new registration.
+  // NOLINTBEGIN(altera-unroll-loops)
+  while (!registration.receivers.empty()) { complete(*registration.receivers.front(), status); }
+  while (!registration.senders.empty()) { complete(*registration.senders.front(), status); }
+  // NOLINTEND(altera-unroll-loops)
+}
+
+auto dataspree::inference::EventLoop::close(Registration &registration, ReceiveStatus const status) -> void {
+  auto &connection = *registration.connection;
+  this->detach(registration, status);
+
+  // The callback may add the connection again.
+  if (registration.onClose) { registration.onClose(connection, status); }
+}
+
+dataspree::inference::EventLoop::Waiter::Waiter(EventLoop &loop,
+  TcpConnection &connection,
+  std::size_t const timeoutMs,
+  std::stop_token stopToken)
+  : loop(&loop), connection(&connection), id(loop.nextWaiterId++), stopToken(std::move(stopToken)) {
+  if (timeoutMs > 0) { this->deadline = Clock::now() + std::chrono::milliseconds(timeoutMs); }
+  if (this->stopToken.stop_requested()) { this->status = ReceiveStatus::CANCELLED; }
+}
+
+auto dataspree::inference::EventLoop::Waiter::suspend(std::coroutine_handle<> coroutine, std::deque<Waiter *> &queue)
+  -> void {
+  this->coroutine = coroutine;
+  this->queue = &queue;
+  queue.push_back(this);
+  this->loop->waiters.emplace(this->id, this);
+  if (this->deadline.has_value()) { this->timer = this->loop->timers.emplace(this->deadline.value(), this); }
+
+  // Cancellation may be requested from any thread; the waiter is looked up on the loop, as it may have completed.
+  if (this->stopToken.stop_possible()) {
+    this->stopCallback.emplace(this->stopToken, [loop = this->loop, id = this->id]() {
+      loop->post([loop, id]() {
+        if (auto const waiter = loop->waiters.find(id); waiter != loop->waiters.end()) {
+          complete(*waiter->second, ReceiveStatus::CANCELLED);
+        }
+      });
+    });
+  }
+}
+
+auto dataspree::inference::EventLoop::Waiter::unregister() -> std::coroutine_handle<> {
+  if (!this->coroutine) { return {}; }
+
+  std::erase(*this->queue, this);
+  this->queue = nullptr;
+  this->loop->waiters.erase(this->id);
+  if (this->deadline.has_value()) { this->loop->timers.erase(this->timer); }
+
+  // Waits for a concurrent stop request to post the cancellation, which is ignored then.
+  this->stopCallback.reset();
+  return std::exchange(this->coroutine, {});
+}
+
+auto dataspree::inference::EventLoop::ReceiveItemAwaitable::await_ready() -> bool {
+  if (this->status != ReceiveStatus::OK) { return true; }
+
+  auto *const registration = this->loop->registrationOf(*this->connection);
+  if (registration == nullptr) {
+    this->status = ReceiveStatus::FAILED;
+    return true;
+  }
+
+  // Earlier receivers get the buffered messages first.
+  return registration->receivers.empty() && this->connection->receiveBufferedItemInto(*this->item);
+}
+
+auto dataspree::inference::EventLoop::ReceiveItemAwaitable::await_suspend(std::coroutine_handle<> coroutine) -> bool {
+  auto &registration = *this->loop->registrations.at(this->connection);
+  this->suspend(coroutine, registration.receivers);
+  if (!this->loop->updateInterest(registration)) {
+    (void)this->unregister();
+    this->status = ReceiveStatus::FAILED;
+    return false;
+  }
+  return true;
+}
+
+dataspree::inference::EventLoop::SendItemAwaitable::SendItemAwaitable(EventLoop &loop,
+  TcpConnection &connection,
+  core::Item const &item,
+  std::string const &consumerName,
+  std::size_t const timeoutMs,
+  std::stop_token stopToken)
+  : Waiter(loop, connection, timeoutMs, std::move(stopToken)) {
+  if (loop.registrationOf(connection) == nullptr || !loop.sendItem(connection, item, consumerName)) {
+    this->status = ReceiveStatus::FAILED;
+    return;
+  }
+
+  // Queued messages are sent in order.
+  this->sentTarget = connection.getNumberOfMessagesSent() + connection.getNumberOfPendingSends();
+}
+
+auto dataspree::inference::EventLoop::SendItemAwaitable::await_ready() const noexcept -> bool {
+  return this->status != ReceiveStatus::OK || this->connection->getNumberOfMessagesSent() >= this->sentTarget;
+}
+
+auto dataspree::inference::EventLoop::SendItemAwaitable::await_suspend(std::coroutine_handle<> coroutine) -> bool {
+  // The connection may have been closed since the message was queued.
+  auto const registration = this->loop->registrations.find(this->connection);
+  if (registration == this->loop->registrations.end()) {
+    this->status = ReceiveStatus::FAILED;
+    return false;
+  }
+
+  this->suspend(coroutine, registration->second->senders);
+  if (!this->loop->updateInterest(*registration->second)) {
+    (void)this->unregister();
+    this->status = ReceiveStatus::FAILED;
+    return false;
+  }
+  return true;
+}
@@ -0,0 +1,210 @@
+#include <FrameBufferPool.hpp>
+
+#include <cassert>
+#include <new>
+
+#ifdef __linux__
+#include <sys/mman.h>
+#define DATASPREE_INFERENCE_HUGE_PAGE_SLABS 1
+#endif
+
+dataspree::inference::FrameBufferPool::~FrameBufferPool() { this->trim(); }
+
+auto dataspree::inference::FrameBufferPool::instance() -> FrameBufferPool & {
+  // Never destroyed; images allocated by the pool may still be released during static destruction.
+  // NOLINTNEXTLINE(cppcoreguidelines-owning-memory)
+  static auto *const pool = new FrameBufferPool();
+  return *pool;
+}
+
+auto dataspree::inference::FrameBufferPool::configure(std::size_t const newMaxRetainedBytes,
+  std::size_t const newMaxBuffersPerSize) -> void {
+  std::scoped_lock const lock(this->mutex);
+  this->maxRetainedBytes = newMaxRetainedBytes;
+  this->maxBuffersPerSize = newMaxBuffersPerSize;
+
+  // NOLINTBEGIN(altera-unroll-loops)
+  for (auto &&[size, pooled] : this->buffers) {
+    while (!pooled.empty()
+           && (pooled.size() > this->maxBuffersPerSize || this->retainedBytes > this->maxRetainedBytes)) {
+      freeBuffer(pooled.back(), size);
+      pooled.pop_back();
+      this->retainedBytes -= size;
+    }
+  }
+  // NOLINTEND(altera-unroll-loops)
+}
+
+auto dataspree::inference::FrameBufferPool::mat() -> cv::Mat {
+  cv::Mat image{};
+  image.allocator = this;
+  return image;
+}
+
+auto dataspree::inference::FrameBufferPool::mat(int const dims, int const *const sizes, int const type) -> cv::Mat {
+  auto image = this->mat();
+  image.create(dims, sizes, type);
+  return image;
+}
+
+auto dataspree::inference::FrameBufferPool::trim() -> void {
+  std::scoped_lock const lock(this->mutex);
+
+  // NOLINTBEGIN(altera-unroll-loops)
+  for (auto &&[size, pooled] : this->buffers) {
+    for (auto *buffer : pooled) { freeBuffer(buffer, size); }
+  }
+  // NOLINTEND(altera-unroll-loops)
+  this->buffers.clear();
+  this->retainedBytes = 0;
+}
+
+auto dataspree::inference::FrameBufferPool::getRetainedBytes() const -> std::size_t {
+  std::scoped_lock const lock(this->mutex);
+  return this->retainedBytes;
+}
+
+auto dataspree::inference::FrameBufferPool::allocate(int const dims,
+  int const *const sizes,
+  int const type,
+  void *const data,
+  std::size_t *const step,
+  AccessFlags const flags,
+  cv::UMatUsageFlags const usageFlags) const -> cv::UMatData * {
+
+  // Headers around user memory own nothing that could be pooled.
+  if (data != nullptr) {
+    return cv::Mat::getStdAllocator()->allocate(dims, sizes, type, data, step, flags, usageFlags);
+  }
+
+  auto total = static_cast<std::size_t>(CV_ELEM_SIZE(type));
+  // NOLINTNEXTLINE(altera-unroll-loops)
+  for (int i = dims - 1; i >= 0; --i) {
+    // NOLINTNEXTLINE(cppcoreguidelines-pro-bounds-pointer-arithmetic)
+    if (step != nullptr) { step[i] = total; }
+    // NOLINTNEXTLINE(cppcoreguidelines-pro-bounds-pointer-arithmetic)
+    total *= static_cast<std::size_t>(sizes[i]);
+  }
+
+  auto *const buffer = this->acquire(capacity(total));
+  // NOLINTNEXTLINE(cppcoreguidelines-owning-memory)
+  auto *const matData = new cv::UMatData(this);
+  matData->data = buffer;
+  matData->origdata = buffer;
+  matData->size = total;
+  return matData;
+}
+
+auto dataspree::inference::FrameBufferPool::allocate(cv::UMatData *const data,
+  AccessFlags /*accessFlags*/,
+  cv::UMatUsageFlags /*usageFlags*/) const -> bool {
+  return data != nullptr;
+}
+
+auto dataspree::inference::FrameBufferPool::deallocate(cv::UMatData *const data) const -> void {
+  if (data == nullptr) { return; }
+  assert(data->urefcount == 0 && data->refcount == 0);
+
+  if ((data->flags & cv::UMatData::USER_ALLOCATED) == 0) {
+    this->release(data->origdata, capacity(data->size));
+    data->origdata = nullptr;
+  }
+  // NOLINTNEXTLINE(cppcoreguidelines-owning-memory)
+  delete data;
+}
+
+auto dataspree::inference::FrameBufferPool::capacity(std::size_t const size) noexcept -> std::size_t {
+  constexpr std::size_t pageSize{ 4096 };
+  if (size < minPooledSize) { return size; }
+
+  // Similar sizes share a pool; large buffers are whole huge pages.
+  auto const granularity = size < hugePageSize ? pageSize : hugePageSize;
+  return (size + granularity - 1) / granularity * granularity;
+}
+
+auto dataspree::inference::FrameBufferPool::acquire(std::size_t const capacity) const -> unsigned char * {
+  if (capacity >= minPooledSize) {
+    {
+      std::scoped_lock const lock(this->mutex);
+      if (auto pooled = this->buffers.find(capacity); pooled != this->buffers.end() && !pooled->second.empty()) {
+        auto *const buffer = pooled->second.back();
+        pooled->second.pop_back();
+        this->retainedBytes -= capacity;
+        this->hits.fetch_add(1, std::memory_order_relaxed);
+        return buffer;
+      }
+    }
+    this->misses.fetch_add(1, std::memory_order_relaxed);
+  }
+  return allocateBuffer(capacity);
+}
+
+auto dataspree::inference::FrameBufferPool::release(unsigned char *const buffer, std::size_t const capacity) const
+  -> void {
+  if (capacity >= minPooledSize) {
+    std::scoped_lock const lock(this->mutex);
+    if (capacity <= this->maxRetainedBytes) {
+      auto &pooled = this->buffers[capacity];
+      if (pooled.size() < this->maxBuffersPerSize) {
+        this->makeRoom(capacity, capacity);
+        if (this->retainedBytes + capacity <= this->maxRetainedBytes) {
+          pooled.push_back(buffer);
+          this->retainedBytes += capacity;
+          return;
+        }
+      }
+    }
+  }
+  freeBuffer(buffer, capacity);
+}
+
+auto dataspree::inference::FrameBufferPool::makeRoom(std::size_t const bytes, std::size_t const keep) const -> void {
+  // Buffers of other sizes are likely left over from a previous resolution.
+  // NOLINTBEGIN(altera-unroll-loops)
+  for (auto &&[size, pooled] : this->buffers) {
+    if (size == keep) { continue; }
+    while (!pooled.empty() && this->retainedBytes + bytes > this->maxRetainedBytes) {
+      freeBuffer(pooled.back(), size);
+      pooled.pop_back();
+      this->retainedBytes -= size;
+    }
+  }
+  // NOLINTEND(altera-unroll-loops)
+}
+
+auto dataspree::inference::FrameBufferPool::allocateBuffer(std::size_t const capacity) -> unsigned char * {
+#ifdef DATASPREE_INFERENCE_HUGE_PAGE_SLABS
+  if (capacity >= hugePageSize) {
+    // Over-allocate by one huge page and unmap the unaligned head and tail.
+    auto const mappedSize = capacity + hugePageSize;
+    auto *const mapped = mmap(nullptr, mappedSize, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    // NOLINTNEXTLINE(cppcoreguidelines-pro-type-cstyle-cast,performance-no-int-to-ptr)
+    if (mapped == MAP_FAILED) { throw std::bad_alloc(); }
+
+    // NOLINTBEGIN(cppcoreguidelines-pro-type-reinterpret-cast,performance-no-int-to-ptr)
+    auto const address = reinterpret_cast<uintptr_t>(mapped);
+    auto const aligned = (address + hugePageSize - 1) & ~(uintptr_t{ hugePageSize } - 1);
+    if (aligned > address) { munmap(mapped, aligned - address); }
+    if (auto const tail = address + mappedSize - (aligned + capacity); tail > 0) {
+      munmap(reinterpret_cast<void *>(aligned + capacity), tail);
+    }
+
+    // Only a hint; the slab works with regular pages if transparent huge pages are disabled.
+    madvise(reinterpret_cast<void *>(aligned), capacity, MADV_HUGEPAGE);
+    return reinterpret_cast<unsigned char *>(aligned);
+    // NOLINTEND(cppcoreguidelines-pro-type-reinterpret-cast,performance-no-int-to-ptr)
+  }
+#endif
+  return static_cast<unsigned char *>(cv::fastMalloc(capacity));
+}
+
+auto dataspree::inference::FrameBufferPool::freeBuffer(unsigned char *const buffer, std::size_t const capacity) noexcept
+  -> void {
+#ifdef DATASPREE_INFERENCE_HUGE_PAGE_SLABS
+  if (capacity >= hugePageSize) {
+    munmap(buffer, capacity);
+    return;
+  }
+#endif
+  cv::fastFree(buffer);
+}
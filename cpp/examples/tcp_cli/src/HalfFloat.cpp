@@ -0,0 +1,148 @@
+#include <HalfFloat.hpp>
+
+#include <bit>
+#include <cassert>
+#include <cstddef>
+
+#if defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__))
+#include <immintrin.h>
+#define DATASPREE_INFERENCE_F16C_DISPATCH 1
+#endif
+
+auto dataspree::inference::floatToHalf(float const value) noexcept -> uint16_t {
+  auto const bits = std::bit_cast<uint32_t>(value);
+  auto const sign = (bits >> 16U) & 0x8000U;
+  auto const exponent = static_cast<int32_t>((bits >> 23U) & 0xffU);
+  auto mantissa = bits & 0x7fffffU;
+
+  // Infinity and NaN (quiet, keeping the upper payload bits).
+  if (exponent == 0xff) {
+    return static_cast<uint16_t>(sign | 0x7c00U | (mantissa != 0 ? 0x200U | (mantissa >> 13U) : 0U));
+  }
+
+  auto const halfExponent = exponent - 127 + 15;
+  if (halfExponent >= 0x1f) { return static_cast<uint16_t>(sign | 0x7c00U); }
+
+  if (halfExponent <= 0) {
+    // Subnormal half (or zero); values below half of the smallest subnormal round to zero.
+    if (halfExponent < -10) { return static_cast<uint16_t>(sign); }
+
+    mantissa |= 0x800000U;
+    auto const shift = static_cast<uint32_t>(14 - halfExponent);
+    auto half = mantissa >> shift;
+    auto const remainder = mantissa & ((1U << shift) - 1U);
+    auto const halfway = 1U << (shift - 1U);
+    if (remainder > halfway || (remainder == halfway && (half & 1U) != 0)) { ++half; }
+    return static_cast<uint16_t>(sign | half);
+  }
+
+  // A carry out of the mantissa correctly increments the exponent (up to infinity).
+  auto half = (static_cast<uint32_t>(halfExponent) << 10U) | (mantissa >> 13U);
+  auto const remainder = mantissa & 0x1fffU;
+  if (remainder > 0x1000U || (remainder == 0x1000U && (half & 1U) != 0)) { ++half; }
+  return static_cast<uint16_t>(sign | half);
+}
+
+auto dataspree::inference::halfToFloat(uint16_t const value) noexcept -> float {
+  auto const sign = (value & 0x8000U) << 16U;
+  auto exponent = static_cast<int32_t>((value >> 10U) & 0x1fU);
+  auto mantissa = value & 0x3ffU;
+
+  // Infinity and NaN (quiet, as converted by F16C).
+  if (exponent == 0x1f) {
+    return std::bit_cast<float>(sign | 0x7f800000U | (mantissa != 0 ? 0x400000U | (mantissa << 13U) : 0U));
+  }
+
+  if (exponent == 0) {
+    if (mantissa == 0) { return std::bit_cast<float>(sign); }
+
+    // Subnormal half; normalize since all of them are normal single precision values.
+    exponent = 1;
+    // NOLINTNEXTLINE(altera-unroll-loops)
+    while ((mantissa & 0x400U) == 0) {
+      mantissa <<= 1U;
+      --exponent;
+    }
+    mantissa &= 0x3ffU;
+  }
+
+  return std::bit_cast<float>(sign | (static_cast<uint32_t>(exponent + 127 - 15) << 23U) | (mantissa << 13U));
+}
+
+#ifdef DATASPREE_INFERENCE_F16C_DISPATCH
+
+/// \return true if the CPU supports the F16C conversion instructions.
+[[nodiscard]] static auto hasF16c() noexcept -> bool {
+  static bool const supported = __builtin_cpu_supports("avx") != 0 && __builtin_cpu_supports("f16c") != 0;
+  return supported;
+}
+
+__attribute__((target("avx,f16c"))) static auto floatToHalfF16c(std::span<float const> source,
+  std::span<uint16_t> destination) noexcept -> void {
+  std::size_t i = 0;
+
+  // NOLINTBEGIN(altera-unroll-loops,cppcoreguidelines-pro-type-reinterpret-cast)
+  for (; i + 8 <= source.size(); i += 8) {
+    auto const values = _mm256_loadu_ps(&source[i]);
+    _mm_storeu_si128(
+      reinterpret_cast<__m128i *>(&destination[i]), _mm256_cvtps_ph(values, _MM_FROUND_TO_NEAREST_INT));
+  }
+  // NOLINTEND(altera-unroll-loops,cppcoreguidelines-pro-type-reinterpret-cast)
+
+  // NOLINTNEXTLINE(altera-unroll-loops)
+  for (; i < source.size(); ++i) { destination[i] = dataspree::inference::floatToHalf(source[i]); }
+}
+
+__attribute__((target("avx,f16c"))) static auto halfToFloatF16c(std::span<uint16_t const> source,
+  std::span<float> destination) noexcept -> void {
+  std::size_t i = 0;
+
+  // NOLINTBEGIN(altera-unroll-loops,cppcoreguidelines-pro-type-reinterpret-cast)
+  for (; i + 8 <= source.size(); i += 8) {
+    auto const values = _mm_loadu_si128(reinterpret_cast<__m128i const *>(&source[i]));
+    _mm256_storeu_ps(&destination[i], _mm256_cvtph_ps(values));
+  }
+  // NOLINTEND(altera-unroll-loops,cppcoreguidelines-pro-type-reinterpret-cast)
+
+  // NOLINTNEXTLINE(altera-unroll-loops)
+  for (; i < source.size(); ++i) { destination[i] = dataspree::inference::halfToFloat(source[i]); }
+}
+
+#endif
+
+auto dataspree::inference::floatToHalf(std::span<float const> source, std::span<uint16_t> destination) noexcept
+  -> void {
+  assert(destination.size() >= source.size());
+
+#ifdef DATASPREE_INFERENCE_F16C_DISPATCH
+  if (hasF16c()) {
+    floatToHalfF16c(source, destination);
+    return;
+  }
+#endif
+
+  // NOLINTNEXTLINE(altera-unroll-loops)
+  for (std::size_t i = 0; i < source.size(); ++i) { destination[i] = floatToHalf(source[i]); }
+}
+
+auto dataspree::inference::halfToFloat(std::span<uint16_t const> source, std::span<float> destination) noexcept
+  -> void {
+  assert(destination.size() >= source.size());
+
+#ifdef DATASPREE_INFERENCE_F16C_DISPATCH
+  if (hasF16c()) {
+    halfToFloatF16c(source, destination);
+    return;
+  }
+#endif
+
+  // NOLINTNEXTLINE(altera-unroll-loops)
+  for (std::size_t i = 0; i < source.size(); ++i) { destination[i] = halfToFloat(source[i]); }
+}
+
+auto dataspree::inference::halfFloatKernel() noexcept -> std::string_view {
+#ifdef DATASPREE_INFERENCE_F16C_DISPATCH
+  if (hasF16c()) { return "F16C"; }
+#endif
+  return "scalar";
+}
@@ -0,0 +1,417 @@
+#include <IoUring.hpp>
+
+#ifdef __linux__
+
+#include <linux/io_uring.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <sys/syscall.h>
+#include <sys/uio.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <bit>
+#include <cerrno>
+#include <csignal>
+#include <cstring>
+#include <limits>
+
+/// User data of the receive operation and of cancellations; send operations are numbered from 0.
+static constexpr uint64_t receiveUserData = std::numeric_limits<uint64_t>::max();
+static constexpr uint64_t cancelUserData = receiveUserData - 1;
+
+/// Flags of the send operations: fail instead of raising SIGPIPE, and let the kernel retry short sends.
+static constexpr uint32_t sendFlags = MSG_NOSIGNAL | MSG_WAITALL;
+
+/// \return member of the shared queues at #offset (see io_uring_params).
+template<typename Member> auto queueMember(void *queues, uint32_t const offset) -> Member * {
+  // NOLINTNEXTLINE(cppcoreguidelines-pro-type-reinterpret-cast)
+  return reinterpret_cast<Member *>(static_cast<char *>(queues) + offset);
+}
+
+auto dataspree::inference::IoUring::create(unsigned const entries,
+  std::size_t const numberReceiveBuffers,
+  std::size_t const receiveBufferSize) -> std::unique_ptr<IoUring> {
+  io_uring_params params{};
+  if (numberReceiveBuffers > 0) {
+    // Every filled buffer completes separately; room for all of them avoids the overflow list of the kernel.
+    params.flags |= IORING_SETUP_CQSIZE;
+    params.cq_entries = static_cast<uint32_t>(std::max<std::size_t>(2 * entries, 2 * numberReceiveBuffers));
+  }
+
+  auto const ringFd = static_cast<int>(syscall(__NR_io_uring_setup, entries, &params));
+  if (ringFd < 0) { return nullptr; }
+
+  std::unique_ptr<IoUring> ring(new IoUring());
+  ring->ringFd = ringFd;
+  ring->numberOfSyscalls = 1;
+
+  // A single mapping of both queues (Linux 5.4) and timeouts of io_uring_enter (Linux 5.11).
+  if ((params.features & IORING_FEAT_SINGLE_MMAP) == 0 || (params.features & IORING_FEAT_EXT_ARG) == 0) {
+    return nullptr;
+  }
+
+  ring->queuesSize = std::max(params.sq_off.array + params.sq_entries * sizeof(unsigned),
+    params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe));
+  auto *queues =
+    mmap(nullptr, ring->queuesSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ringFd, IORING_OFF_SQ_RING);
+  if (queues == MAP_FAILED) { return nullptr; }
+  ring->queues = queues;
+
+  ring->submissionsSize = params.sq_entries * sizeof(io_uring_sqe);
+  auto *submissions =
+    mmap(nullptr, ring->submissionsSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ringFd, IORING_OFF_SQES);
+  if (submissions == MAP_FAILED) { return nullptr; }
+  ring->submissions = static_cast<io_uring_sqe *>(submissions);
+
+  ring->submissionHead = queueMember<unsigned>(queues, params.sq_off.head);
+  ring->submissionTail = queueMember<unsigned>(queues, params.sq_off.tail);
+  ring->submissionArray = queueMember<unsigned>(queues, params.sq_off.array);
+  ring->submissionMask = *queueMember<unsigned>(queues, params.sq_off.ring_mask);
+  ring->numberSubmissionEntries = params.sq_entries;
+  ring->preparedTail = *ring->submissionTail;
+
+  ring->completionHead = queueMember<unsigned>(queues, params.cq_off.head);
+  ring->completionTail = queueMember<unsigned>(queues, params.cq_off.tail);
+  ring->completions = queueMember<io_uring_cqe>(queues, params.cq_off.cqes);
+  ring->completionMask = *queueMember<unsigned>(queues, params.cq_off.ring_mask);
+
+  if (numberReceiveBuffers > 0 && !ring->provideReceiveBuffers(numberReceiveBuffers, receiveBufferSize)) {
+    return nullptr;
+  }
+  return ring;
+}
+
+dataspree::inference::IoUring::~IoUring() {
+  // The kernel must not write into the receive buffers once they are released.
+  if (this->receiveArmed && this->cancel(receiveUserData)) {
+    auto const deadline = Clock::now() + std::chrono::milliseconds(100);
+    // NOLINTNEXTLINE(altera-unroll-loops)
+    while (this->receiveArmed) {
+      io_uring_cqe completion{};
+      if (this->takeCompletion(completion)) {
+        if (completion.user_data == receiveUserData && (completion.flags & IORING_CQE_F_MORE) == 0) {
+          this->receiveArmed = false;
+        }
+      } else if (auto const entered = this->enter(1, deadline); entered < 0 && entered != -EINTR) {
+        break;
+      }
+    }
+  }
+
+  if (this->ringFd >= 0) { close(this->ringFd); }
+  if (this->queues != nullptr) { munmap(this->queues, this->queuesSize); }
+  if (this->submissions != nullptr) { munmap(this->submissions, this->submissionsSize); }
+  if (this->bufferRing != nullptr) { munmap(this->bufferRing, this->bufferRingSize); }
+}
+
+auto dataspree::inference::IoUring::provideReceiveBuffers(std::size_t const count, std::size_t const size) -> bool {
+  auto const numberBuffers = std::bit_ceil(count);
+  if (numberBuffers > (std::size_t{ 1 } << 15U) || size == 0 || size > std::numeric_limits<uint32_t>::max()) {
+    return false;
+  }
+
+  // The descriptors are shared with the kernel and must be page aligned.
+  this->bufferRingSize = numberBuffers * sizeof(io_uring_buf);
+  auto *mapping = mmap(nullptr, this->bufferRingSize, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+  if (mapping == MAP_FAILED) { return false; }
+  this->bufferRing = static_cast<io_uring_buf_ring *>(mapping);
+
+  io_uring_buf_reg registration{};
+  registration.ring_addr = reinterpret_cast<uint64_t>(mapping);// NOLINT(cppcoreguidelines-pro-type-reinterpret-cast)
+  registration.ring_entries = static_cast<uint32_t>(numberBuffers);
+  registration.bgid = 0;
+  ++this->numberOfSyscalls;
+  if (syscall(__NR_io_uring_register, this->ringFd, IORING_REGISTER_PBUF_RING, &registration, 1) < 0) {
+    return false;
+  }
+
+  this->receiveBuffers.resize(numberBuffers * size);
+  this->receiveBufferSize = size;
+  this->bufferRingMask = static_cast<uint16_t>(numberBuffers - 1);
+  // NOLINTNEXTLINE(altera-unroll-loops)
+  for (std::size_t id = 0; id < numberBuffers; ++id) { this->recycleReceiveBuffer(static_cast<uint16_t>(id)); }
+  return true;
+}
+
+auto dataspree::inference::IoUring::recycleReceiveBuffer(uint16_t const id) noexcept -> void {
+  // The descriptors start at the ring (the tail overlaps the first one); io_uring_buf_ring::bufs is misplaced in C++,
+  // where the empty struct of __DECLARE_FLEX_ARRAY takes a byte.
+  // NOLINTNEXTLINE(cppcoreguidelines-pro-type-reinterpret-cast)
+  auto *descriptors = reinterpret_cast<io_uring_buf *>(this->bufferRing);
+  auto &descriptor = descriptors[this->bufferRingTail & this->bufferRingMask];
+  // NOLINTNEXTLINE(cppcoreguidelines-pro-type-reinterpret-cast)
+  descriptor.addr = reinterpret_cast<uint64_t>(&this->receiveBuffers[id * this->receiveBufferSize]);
+  descriptor.len = static_cast<uint32_t>(this->receiveBufferSize);
+  descriptor.bid = id;
+  ++this->bufferRingTail;
+  std::atomic_ref(this->bufferRing->tail).store(this->bufferRingTail, std::memory_order_release);
+}
+
+auto dataspree::inference::IoUring::nextSubmission() noexcept -> io_uring_sqe * {
+  auto const head = std::atomic_ref(*this->submissionHead).load(std::memory_order_acquire);
+  if (this->preparedTail - head >= this->numberSubmissionEntries) { return nullptr; }
+
+  auto const index = this->preparedTail & this->submissionMask;
+  auto *entry = &this->submissions[index];
+  std::memset(entry, 0, sizeof(io_uring_sqe));
+  this->submissionArray[index] = index;
+  ++this->preparedTail;
+  ++this->unsubmitted;
+  return entry;
+}
+
+auto dataspree::inference::IoUring::takeCompletion(io_uring_cqe &completion) noexcept -> bool {
+  auto const head = *this->completionHead;
+  if (head == std::atomic_ref(*this->completionTail).load(std::memory_order_acquire)) { return false; }
+
+  std::memcpy(&completion, &this->completions[head & this->completionMask], sizeof(io_uring_cqe));
+  std::atomic_ref(*this->completionHead).store(head + 1, std::memory_order_release);
+  return true;
+}
+
+auto dataspree::inference::IoUring::enter(unsigned const minComplete,
+  std::optional<Clock::time_point> const deadline) noexcept -> int {
+  std::atomic_ref(*this->submissionTail).store(this->preparedTail, std::memory_order_release);
+
+  // The timeout is passed with the extended argument (IORING_FEAT_EXT_ARG) instead of a timeout operation.
+  __kernel_timespec timeout{};
+  io_uring_getevents_arg argument{};
+  argument.sigmask_sz = _NSIG / 8;
+  if (deadline.has_value()) {
+    auto const remaining = std::max(
+      std::chrono::duration_cast<std::chrono::nanoseconds>(deadline.value() - Clock::now()).count(), int64_t{ 0 });
+    timeout.tv_sec = remaining / 1'000'000'000;
+    timeout.tv_nsec = remaining % 1'000'000'000;
+    argument.ts = reinterpret_cast<uint64_t>(&timeout);// NOLINT(cppcoreguidelines-pro-type-reinterpret-cast)
+  }
+
+  auto const wait = minComplete > 0;
+  ++this->numberOfSyscalls;
+  auto const result = syscall(__NR_io_uring_enter,
+    this->ringFd,
+    this->unsubmitted,
+    minComplete,
+    wait ? IORING_ENTER_GETEVENTS | IORING_ENTER_EXT_ARG : 0U,
+    wait ? &argument : nullptr,
+    wait ? sizeof(argument) : 0);
+  if (result < 0) { return -errno; }
+
+  this->unsubmitted -= std::min(static_cast<unsigned>(result), this->unsubmitted);
+  return static_cast<int>(result);
+}
+
+auto dataspree::inference::IoUring::discardSubmission() noexcept -> void {
+  --this->preparedTail;
+  --this->unsubmitted;
+}
+
+auto dataspree::inference::IoUring::cancel(uint64_t const userData) noexcept -> bool {
+  auto *entry = this->nextSubmission();
+  if (entry == nullptr) { return false; }
+
+  // Matched by user data, which is supported since Linux 5.5 (unlike IORING_ASYNC_CANCEL_ANY).
+  entry->opcode = IORING_OP_ASYNC_CANCEL;
+  entry->fd = -1;
+  entry->addr = userData;
+  entry->user_data = cancelUserData;
+  auto const entered = this->enter(0, std::nullopt);
+  return entered >= 0 || entered == -EINTR;
+}
+
+auto dataspree::inference::IoUring::receive(int const fd,
+  std::span<char> const buffer,
+  std::optional<Clock::time_point> const deadline) -> int64_t {
+  // NOLINTNEXTLINE(altera-unroll-loops)
+  while (true) {
+    if (this->pendingSize > 0) {
+      auto const size = std::min(this->pendingSize, buffer.size());
+      std::memcpy(buffer.data(),
+        &this->receiveBuffers[this->pendingBuffer * this->receiveBufferSize + this->pendingOffset],
+        size);
+      this->pendingOffset += size;
+      this->pendingSize -= size;
+      if (this->pendingSize == 0) { this->recycleReceiveBuffer(this->pendingBuffer); }
+      return static_cast<int64_t>(size);
+    }
+
+    if (io_uring_cqe completion{}; this->takeCompletion(completion)) {
+      if (completion.user_data != receiveUserData) { continue; }
+      if ((completion.flags & IORING_CQE_F_MORE) == 0) { this->receiveArmed = false; }
+
+      if (completion.res > 0) {
+        this->pendingBuffer = static_cast<uint16_t>(completion.flags >> IORING_CQE_BUFFER_SHIFT);
+        this->pendingOffset = 0;
+        this->pendingSize = static_cast<std::size_t>(completion.res);
+        continue;
+      }
+      if (completion.res == 0) { return 0; }
+      if (completion.res == -EINVAL && this->multishot) {
+        // Kernels before 6.0 only receive once per submission.
+        this->multishot = false;
+        continue;
+      }
+      // All buffers were filled before they were taken; the receive is armed again below.
+      if (completion.res == -ENOBUFS || completion.res == -EINTR || completion.res == -EAGAIN) { continue; }
+      return failed;
+    }
+
+    if (!this->receiveArmed) {
+      auto *entry = this->nextSubmission();
+      if (entry == nullptr) { return failed; }
+      entry->opcode = IORING_OP_RECV;
+      entry->fd = fd;
+      entry->ioprio = this->multishot ? IORING_RECV_MULTISHOT : 0;
+      entry->flags = IOSQE_BUFFER_SELECT;
+      entry->buf_group = 0;
+      entry->user_data = receiveUserData;
+      this->receiveArmed = true;
+    } else if (deadline.has_value() && Clock::now() >= deadline.value()) {
+      return timedOut;
+    }
+
+    if (auto const entered = this->enter(1, deadline); entered == -ETIME) {
+      return timedOut;
+    } else if (entered < 0 && entered != -EINTR && entered != -EAGAIN && entered != -EBUSY) {
+      return failed;
+    }
+  }
+}
+
+auto dataspree::inference::IoUring::send(int const fd,
+  std::span<std::span<iovec const> const> frames,
+  std::optional<Clock::time_point> const deadline) -> std::size_t {
+  if (this->sendFailed) { return 0; }
+
+  std::size_t sent{ 0 };
+  std::vector<std::size_t> expected{};
+  std::vector<std::optional<int32_t>> results{};
+
+  // NOLINTBEGIN(altera-unroll-loops)
+  while (!frames.empty()) {
+    // Up to two entries per frame; the kernel takes them all with a single system call.
+    auto const chunk = frames.first(std::min<std::size_t>(frames.size(), this->numberSubmissionEntries / 2));
+    this->sendBodies.assign(chunk.size(), msghdr{});
+    expected.clear();
+
+    // Header and body of a frame are linked, and so are the frames, such that they are sent in order and a short
+    // send cancels the rest. Frames for which the submission queue has no room are sent with the next chunk.
+    io_uring_sqe *last{ nullptr };
+    std::size_t prepared{ 0 };
+    for (; prepared < chunk.size(); ++prepared) {
+      auto const &frame = chunk[prepared];
+      if (frame.empty()) { continue; }
+
+      auto const body = frame.subspan(1);
+      auto *header = this->nextSubmission();
+      if (header == nullptr) { break; }
+      auto *bodyEntry = body.empty() ? nullptr : this->nextSubmission();
+      if (!body.empty() && bodyEntry == nullptr) {
+        this->discardSubmission();
+        break;
+      }
+
+      header->opcode = IORING_OP_SEND;
+      header->fd = fd;
+      // NOLINTNEXTLINE(cppcoreguidelines-pro-type-reinterpret-cast)
+      header->addr = reinterpret_cast<uint64_t>(frame.front().iov_base);
+      header->len = static_cast<uint32_t>(frame.front().iov_len);
+      header->msg_flags = sendFlags;
+      header->flags = IOSQE_IO_LINK;
+      header->user_data = expected.size();
+      expected.push_back(frame.front().iov_len);
+      last = header;
+      if (bodyEntry == nullptr) { continue; }
+
+      std::size_t bodySize{ 0 };
+      for (auto const &segment : body) { bodySize += segment.iov_len; }
+      auto &message = this->sendBodies[prepared];
+      // NOLINTNEXTLINE(cppcoreguidelines-pro-type-const-cast)
+      message.msg_iov = const_cast<iovec *>(body.data());
+      message.msg_iovlen = body.size();
+
+      bodyEntry->opcode = IORING_OP_SENDMSG;
+      bodyEntry->fd = fd;
+      bodyEntry->addr = reinterpret_cast<uint64_t>(&message);// NOLINT(cppcoreguidelines-pro-type-reinterpret-cast)
+      bodyEntry->len = 1;
+      bodyEntry->msg_flags = sendFlags;
+      bodyEntry->flags = IOSQE_IO_LINK;
+      bodyEntry->user_data = expected.size();
+      expected.push_back(bodySize);
+      last = bodyEntry;
+    }
+    if (prepared == 0) { return sent; }
+    frames = frames.subspan(prepared);
+    if (last == nullptr) { continue; }
+    last->flags = 0;
+
+    // Wait for all operations, also if the ring stops early: they refer to the frames and to #sendBodies. At the
+    // deadline, the operation in flight is cancelled, which fails the ones that are linked to it.
+    results.assign(expected.size(), std::nullopt);
+    auto outstanding = expected.size();
+    auto cancelling = false;
+    auto cancelPending = false;
+    while (outstanding > 0) {
+      if (io_uring_cqe completion{}; this->takeCompletion(completion)) {
+        if (completion.user_data == cancelUserData) {
+          // The operation may have completed before it was cancelled; the next one is cancelled then.
+          cancelPending = false;
+        } else if (completion.user_data < results.size() && !results[completion.user_data].has_value()) {
+          results[completion.user_data] = completion.res;
+          --outstanding;
+        }
+        continue;
+      }
+
+      if (cancelling && !cancelPending) {
+        auto const inFlight = static_cast<uint64_t>(
+          std::find(results.begin(), results.end(), std::nullopt) - results.begin());
+        cancelPending = this->cancel(inFlight);
+      }
+
+      auto const entered = this->enter(1, cancelling ? std::nullopt : deadline);
+      if (entered >= 0 || entered == -EINTR || entered == -EAGAIN || entered == -EBUSY) { continue; }
+      if (cancelling && !cancelPending) {
+        // The ring is unusable; #sendBodies stays in place in case the kernel still sends.
+        this->sendFailed = true;
+        return sent;
+      }
+      cancelling = true;
+    }
+
+    for (std::size_t index = 0; index < results.size(); ++index) {
+      auto const result = results[index].value();
+      if (result > 0) { sent += static_cast<std::size_t>(result); }
+      if (result < 0 || static_cast<std::size_t>(result) != expected[index]) { return sent; }
+    }
+  }
+  // NOLINTEND(altera-unroll-loops)
+
+  return sent;
+}
+
+#else
+
+// io_uring is only available on Linux; the connections use their portable paths.
+
+auto dataspree::inference::IoUring::create(unsigned /*entries*/,
+  std::size_t /*numberReceiveBuffers*/,
+  std::size_t /*receiveBufferSize*/) -> std::unique_ptr<IoUring> {
+  return nullptr;
+}
+
+dataspree::inference::IoUring::~IoUring() = default;
+
+auto dataspree::inference::IoUring::receive(int /*fd*/,
+  std::span<char> /*buffer*/,
+  std::optional<Clock::time_point> /*deadline*/) -> int64_t {
+  return failed;
+}
+
+auto dataspree::inference::IoUring::send(int /*fd*/,
+  std::span<std::span<iovec const> const> /*frames*/,
+  std::optional<Clock::time_point> /*deadline*/) -> std::size_t {
+  return 0;
+}
+
+#endif
@@ -0,0 +1,201 @@
+#include <PipelinedConnection.hpp>
+
+#include <utility>
+
+auto dataspree::inference::PipelinedConnection::start() -> void {
+  this->stop();
+  {
+    std::scoped_lock const lock(this->mutex);
+    this->running = true;
+    this->receiving = this->connection.isReceiveConfigured();
+    this->stopping = false;
+    this->status = ReceiveStatus::OK;
+    this->statistics = PipelineStatistics{};
+    this->applicationActive = false;
+  }
+
+  if (this->receiving) { this->receiveThread = std::thread([this]() { this->receiveLoop(); }); }
+  this->sendThread = std::thread([this]() { this->sendLoop(); });
+}
+
+auto dataspree::inference::PipelinedConnection::stop() -> void {
+  {
+    std::scoped_lock const lock(this->mutex);
+    this->stopping = true;
+  }
+  this->receiveQueueFilled.notify_all();
+  this->receiveQueueDrained.notify_all();
+  this->sendQueueFilled.notify_all();
+  this->sendQueueDrained.notify_all();
+
+  if (this->receiveThread.joinable()) { this->receiveThread.join(); }
+  if (this->sendThread.joinable()) { this->sendThread.join(); }
+
+  std::scoped_lock const lock(this->mutex);
+  this->running = false;
+  // NOLINTNEXTLINE(altera-unroll-loops)
+  for (auto &item : this->receiveQueue) { this->spareItems.push_back(std::move(item)); }
+  this->receiveQueue.clear();
+  this->sendQueue.clear();
+}
+
+auto dataspree::inference::PipelinedConnection::receive(core::Item &item, std::size_t const timeoutMs)
+  -> ReceiveStatus {
+  std::unique_lock lock(this->mutex);
+  if (!this->running || !this->receiving) { return ReceiveStatus::CANCELLED; }
+
+  auto const called = Clock::now();
+  this->enterApplicationCall(called);
+
+  auto const ready = [this]() {
+    return !this->receiveQueue.empty() || this->status != ReceiveStatus::OK || this->stopping;
+  };
+  if (timeoutMs > 0) {
+    this->receiveQueueFilled.wait_until(lock, called + std::chrono::milliseconds(timeoutMs), ready);
+  } else {
+    this->receiveQueueFilled.wait(lock, ready);
+  }
+
+  auto const returned = Clock::now();
+  this->statistics.application.stalled += returned - called;
+  this->applicationReturned = returned;
+
+  // Messages that were received before the connection failed are delivered first.
+  if (this->receiveQueue.empty()) {
+    if (this->status != ReceiveStatus::OK) { return this->status; }
+    return this->stopping ? ReceiveStatus::CANCELLED : ReceiveStatus::TIMEOUT;
+  }
+
+  std::swap(item, this->receiveQueue.front());
+  this->spareItems.push_back(std::move(this->receiveQueue.front()));
+  this->receiveQueue.pop_front();
+  ++this->statistics.application.messages;
+  this->receiveQueueDrained.notify_one();
+  return ReceiveStatus::OK;
+}
+
+auto dataspree::inference::PipelinedConnection::send(core::Item item, std::string consumerName) -> bool {
+  std::unique_lock lock(this->mutex);
+  if (!this->running || this->status != ReceiveStatus::OK) { return false; }
+
+  auto const called = Clock::now();
+  this->enterApplicationCall(called);
+
+  this->sendQueueDrained.wait(lock, [this]() {
+    return this->sendQueue.size() < this->sendQueueSize || this->status != ReceiveStatus::OK || this->stopping;
+  });
+
+  auto const returned = Clock::now();
+  this->statistics.application.stalled += returned - called;
+  this->applicationReturned = returned;
+
+  if (this->status != ReceiveStatus::OK || this->stopping) { return false; }
+
+  this->sendQueue.push_back(OutgoingMessage{ std::move(item), std::move(consumerName) });
+  this->statistics.maxSendQueueDepth = std::max(this->statistics.maxSendQueueDepth, this->sendQueue.size());
+  this->sendQueueFilled.notify_one();
+  return true;
+}
+
+auto dataspree::inference::PipelinedConnection::isRunning() const -> bool {
+  std::scoped_lock const lock(this->mutex);
+  return this->running && !this->stopping && this->status == ReceiveStatus::OK;
+}
+
+auto dataspree::inference::PipelinedConnection::getStatistics() const -> PipelineStatistics {
+  std::scoped_lock const lock(this->mutex);
+  auto statistics = this->statistics;
+  statistics.receiveQueueDepth = this->receiveQueue.size();
+  statistics.sendQueueDepth = this->sendQueue.size();
+  return statistics;
+}
+
+auto dataspree::inference::PipelinedConnection::receiveLoop() -> void {
+  std::size_t timeouts{ 0 };
+
+  // NOLINTNEXTLINE(altera-unroll-loops)
+  while (true) {
+    core::Item item{};
+    {
+      std::scoped_lock const lock(this->mutex);
+      if (this->stopping || this->status != ReceiveStatus::OK) { return; }
+      if (!this->spareItems.empty()) {
+        item = std::move(this->spareItems.back());
+        this->spareItems.pop_back();
+      }
+    }
+
+    auto const begin = Clock::now();
+    auto const receiveStatus = this->connection.receiveItemInto(item);
+    auto const received = Clock::now();
+
+    std::unique_lock lock(this->mutex);
+    if (receiveStatus == ReceiveStatus::TIMEOUT) {
+      // The producer is idle; check whether the pipeline stops.
+      this->spareItems.push_back(std::move(item));
+      if (this->maxTimeouts == 0 || ++timeouts < this->maxTimeouts) { continue; }
+    }
+    if (receiveStatus != ReceiveStatus::OK) {
+      this->fail(receiveStatus);
+      return;
+    }
+    timeouts = 0;
+    this->statistics.receive.busy += received - begin;
+    ++this->statistics.receive.messages;
+
+    this->receiveQueueDrained.wait(lock, [this]() {
+      return this->receiveQueue.size() < this->receiveQueueSize || this->status != ReceiveStatus::OK || this->stopping;
+    });
+    this->statistics.receive.stalled += Clock::now() - received;
+    if (this->status != ReceiveStatus::OK || this->stopping) { return; }
+
+    this->receiveQueue.push_back(std::move(item));
+    this->statistics.maxReceiveQueueDepth = std::max(this->statistics.maxReceiveQueueDepth, this->receiveQueue.size());
+    this->receiveQueueFilled.notify_one();
+  }
+}
+
+auto dataspree::inference::PipelinedConnection::sendLoop() -> void {
+  // NOLINTNEXTLINE(altera-unroll-loops)
+  while (true) {
+    OutgoingMessage message{};
+    {
+      std::unique_lock lock(this->mutex);
+      auto const idle = Clock::now();
+      this->sendQueueFilled.wait(lock, [this]() {
+        return !this->sendQueue.empty() || this->status != ReceiveStatus::OK || this->stopping;
+      });
+      this->statistics.send.stalled += Clock::now() - idle;
+      if (this->status != ReceiveStatus::OK || this->stopping) { return; }
+
+      message = std::move(this->sendQueue.front());
+      this->sendQueue.pop_front();
+      this->sendQueueDrained.notify_one();
+    }
+
+    auto const begin = Clock::now();
+    auto const sent = this->connection.sendItem(message.item, message.consumerName);
+    auto const end = Clock::now();
+
+    std::scoped_lock const lock(this->mutex);
+    if (!sent) {
+      this->fail(ReceiveStatus::FAILED);
+      return;
+    }
+    this->statistics.send.busy += end - begin;
+    ++this->statistics.send.messages;
+  }
+}
+
+auto dataspree::inference::PipelinedConnection::fail(ReceiveStatus const failure) -> void {
+  if (this->status == ReceiveStatus::OK) { this->status = failure; }
+  this->receiveQueueFilled.notify_all();
+  this->receiveQueueDrained.notify_all();
+  this->sendQueueFilled.notify_all();
+  this->sendQueueDrained.notify_all();
+}
+
+auto dataspree::inference::PipelinedConnection::enterApplicationCall(Clock::time_point const now) -> void {
+  if (this->applicationActive) { this->statistics.application.busy += now - this->applicationReturned; }
+  this->applicationActive = true;
+}
@@ -14,122 +14,853 @@ template<typename... T> auto socket_read(SOCKET fd, char *buf, std::size_t count
   return recv(fd, buf, static_cast<int>(count), 0);
 }
 
-auto socket_send(SOCKET fd, void const *buf, std::size_t count) {
-  assert(count < std::numeric_limits<int>::max());
-  return send(fd, static_cast<char const *>(buf), static_cast<int>(count), 0);
+/// Send #segments with a single WSASend.
+/// \return number of bytes sent; negative on error.
+auto socket_sendv(SOCKET fd, WSABUF *segments, std::size_t count) -> int64_t {
+  DWORD sent{ 0 };
+  if (WSASend(fd, segments, static_cast<DWORD>(count), &sent, 0, nullptr, nullptr) != 0) { return -1; }
+  return static_cast<int64_t>(sent);
+}
+
+using IoSegment = WSABUF;
+
+auto makeIoSegment(char const *data, std::size_t size) -> WSABUF {
+  assert(size <= std::numeric_limits<ULONG>::max());
+  // NOLINTNEXTLINE(cppcoreguidelines-pro-type-const-cast)
+  return { .len = static_cast<ULONG>(size), .buf = const_cast<char *>(data) };
+}
+
+auto ioSegmentSize(WSABUF const &segment) -> std::size_t { return segment.len; }
+
+auto advanceIoSegment(WSABUF &segment, std::size_t count) -> void {
+  segment.buf += count;
+  segment.len -= static_cast<ULONG>(count);
+}
+
+/// Maximum number of segments per call.
+static constexpr std::size_t maxIoSegments = 1024;
+
+/// Wait until #fd is readable (or closed).
+/// \param timeoutMs -1 to wait indefinitely.
+/// \return positive if readable, 0 on timeout and negative on error.
+auto socket_poll(SOCKET fd, int timeoutMs) -> int {
+  WSAPOLLFD descriptor{ .fd = fd, .events = POLLRDNORM, .revents = 0 };
+  return WSAPoll(&descriptor, 1, timeoutMs);
+}
+
+/// \return true if the last socket call failed without affecting the connection and may be repeated.
+auto socketInterrupted() -> bool {
+  auto const error = WSAGetLastError();
+  return error == WSAEINTR || error == WSAEWOULDBLOCK;
+}
+
+auto socketSetNonBlocking(SOCKET fd, bool enable) -> bool {
+  u_long mode = enable ? 1 : 0;
+  return ioctlsocket(fd, FIONBIO, &mode) == 0;
 }
 
 auto socketClose(SOCKET fd) { return closesocket(fd); }
 
+/// io_uring is not available on Windows (see IoUring::create); nothing is sent.
+auto ring_sendv(dataspree::inference::IoUring & /*ring*/,
+  SOCKET /*fd*/,
+  std::span<std::span<WSABUF const> const> /*frames*/,
+  std::optional<std::chrono::steady_clock::time_point> /*deadline*/) -> std::size_t {
+  return 0;
+}
+
 #else
 
 #include <arpa/inet.h>
 #include <bits/socket.h>
+#include <cerrno>
+#include <climits>
+#include <fcntl.h>
 #include <netinet/in.h>
+#include <poll.h>
 #include <sys/socket.h>
+#include <sys/uio.h>
 #include <unistd.h>
 static constexpr SocketType INVALID_SOCKET = -1;
 
 auto socket_read(int fd, char *buf, std::size_t count) { return read(fd, buf, count); }
-auto socket_send(int fd, void const *buf, std::size_t count) { return send(fd, buf, count, MSG_NOSIGNAL); }
+/// Send #segments with a single sendmsg (i.e., writev with MSG_NOSIGNAL).
+/// \return number of bytes sent; negative on error.
+auto socket_sendv(int fd, iovec *segments, std::size_t count) -> int64_t {
+  msghdr message{};
+  message.msg_iov = segments;
+  message.msg_iovlen = count;
+  return sendmsg(fd, &message, MSG_NOSIGNAL);
+}
+
+using IoSegment = iovec;
+
+auto makeIoSegment(char const *data, std::size_t size) -> iovec {
+  // NOLINTNEXTLINE(cppcoreguidelines-pro-type-const-cast)
+  return { .iov_base = const_cast<char *>(data), .iov_len = size };
+}
+
+auto ioSegmentSize(iovec const &segment) -> std::size_t { return segment.iov_len; }
+
+auto advanceIoSegment(iovec &segment, std::size_t count) -> void {
+  segment.iov_base = static_cast<char *>(segment.iov_base) + count;
+  segment.iov_len -= count;
+}
+
+/// Maximum number of segments per call (IOV_MAX).
+static constexpr std::size_t maxIoSegments = IOV_MAX;
+
+/// Wait until #fd is readable (or closed).
+/// \param timeoutMs -1 to wait indefinitely.
+/// \return positive if readable, 0 on timeout and negative on error.
+auto socket_poll(int fd, int timeoutMs) -> int {
+  pollfd descriptor{ .fd = fd, .events = POLLIN, .revents = 0 };
+  return poll(&descriptor, 1, timeoutMs);
+}
+
+/// \return true if the last socket call failed without affecting the connection and may be repeated.
+auto socketInterrupted() -> bool { return errno == EINTR || errno == EAGAIN || errno == EWOULDBLOCK; }
+
+auto socketSetNonBlocking(int fd, bool enable) -> bool {
+  auto const flags = fcntl(fd, F_GETFL, 0);
+  if (flags < 0) { return false; }
+  return fcntl(fd, F_SETFL, enable ? (flags | O_NONBLOCK) : (flags & ~O_NONBLOCK)) == 0;
+}
 
 auto socketClose(int fd) { return close(fd); }
 
+/// Send #frames (header and body segments each) with the io_uring #ring.
+/// \return number of bytes that were sent in order (see IoUring::send).
+auto ring_sendv(dataspree::inference::IoUring &ring,
+  int fd,
+  std::span<std::span<iovec const> const> frames,
+  std::optional<std::chrono::steady_clock::time_point> deadline) -> std::size_t {
+  return ring.send(fd, frames, deadline);
+}
+
 #endif
 
 
 SocketType invalidSocket = INVALID_SOCKET;
 
 
-auto dataspree::inference::TcpConnection::sendData(char const *data, std::size_t size) const -> bool {
-  // encoding code
-  assert(size < std::numeric_limits<uint32_t>::max());
-  auto const messageSize{ static_cast<uint32_t>(size) };
+/// Append the #header and the #segments of a frame to #ioSegments, skipping the first #skip bytes (that were sent).
+auto appendIoSegments(std::vector<IoSegment> &ioSegments,
+  std::span<char const> header,
+  std::span<std::span<char const> const> segments,
+  std::size_t skip) -> void {
+  auto const append = [&ioSegments, &skip](std::span<char const> segment) {
+    if (skip >= segment.size()) {
+      skip -= segment.size();
+      return;
+    }
+    ioSegments.push_back(makeIoSegment(&segment[skip], segment.size() - skip));
+    skip = 0;
+  };
 
-  // send the size
-  int64_t bytesJustSent {0};
-  auto const messageSizeChunk = core::toBigEndian(messageSize);
-  static_assert(messageSizeChunk.size() == 4);
-  for (int64_t total = 0; static_cast<std::size_t>(total) < 4;
-       total += (bytesJustSent = socket_send(fdSocket, messageSizeChunk.data(), 4))) {
-    if (bytesJustSent < 0) {
-      spdlog::warn("Error sending message (part 1: size) {}.", bytesJustSent);
-      return false;
+  append(header);
+  // NOLINTNEXTLINE(altera-unroll-loops)
+  for (auto const &segment : segments) { append(segment); }
+}
+
+/// Skip #count sent bytes of #ioSegments from segment #first on.
+/// \return index of the first segment that was not sent completely, which is advanced to its first unsent byte.
+auto skipIoSegments(std::vector<IoSegment> &ioSegments, std::size_t first, std::size_t count) -> std::size_t {
+  // NOLINTNEXTLINE(altera-unroll-loops)
+  while (count > 0) {
+    auto const segmentSize = ioSegmentSize(ioSegments[first]);
+    if (count < segmentSize) {
+      advanceIoSegment(ioSegments[first], count);
+      break;
     }
+    count -= segmentSize;
+    ++first;
   }
+  return first;
+}
 
-  // send the encoding
+auto dataspree::inference::TcpConnection::frameHeader(std::size_t const messageSize) const
+  -> std::array<char, frameHeaderSize> {
+  assert(messageSize < std::numeric_limits<uint32_t>::max());
+
+  // Size (unsigned int 4, big endian) and encoding.
+  auto const messageSizeChunk = core::toBigEndian(static_cast<uint32_t>(messageSize));
   auto const encodingChunk = core::toBigEndian(core::getUnderlyingValue(this->receiveProperties.getEncodingMode()));
-  static_assert(encodingChunk.size() == 1);
+  static_assert(messageSizeChunk.size() == 4 && encodingChunk.size() == 1);
+  std::array<char, frameHeaderSize> header{};
+  std::memcpy(header.data(), messageSizeChunk.data(), messageSizeChunk.size());
+  std::memcpy(&header[messageSizeChunk.size()], encodingChunk.data(), encodingChunk.size());
+  return header;
+}
 
-  for (int64_t total = 0; static_cast<std::size_t>(total) < 1;
-       total += (bytesJustSent = socket_send(fdSocket, encodingChunk.data(), 1))) {
-    if (bytesJustSent < 0) {
-      spdlog::warn("Error sending message (part 2: encoding) {}.", bytesJustSent);
-      return false;
-    }
+auto dataspree::inference::TcpConnection::sendData(std::span<std::span<char const> const> segments) const -> bool {
+  std::size_t size{ 0 };
+  // NOLINTNEXTLINE(altera-unroll-loops)
+  for (auto const &segment : segments) { size += segment.size(); }
+  auto const header = frameHeader(size);
+
+  std::vector<IoSegment> ioSegments{};
+  ioSegments.reserve(segments.size() + 1);
+  appendIoSegments(ioSegments, header, segments, 0);
+
+  std::size_t first{ 0 };
+  std::size_t sent{ 0 };
+  if (this->sendRing != nullptr) {
+    // Header and body as linked operations; a frame that the ring did not send completely is resumed below.
+    std::array const frames{ std::span<IoSegment const>(ioSegments) };
+    sent = ring_sendv(*this->sendRing, fdSocket, frames, this->sendDeadline());
+    first = skipIoSegments(ioSegments, first, sent);
   }
 
-  // send the message
-  for (int64_t total = 0; static_cast<std::size_t>(total) < size;
-       total += (bytesJustSent = socket_send(fdSocket, data, size))) {
-    if (bytesJustSent < 0) {
-      spdlog::warn("Error sending message (part 3: data) {}.", bytesJustSent);
+  // NOLINTNEXTLINE(altera-unroll-loops)
+  while (first < ioSegments.size()) {
+    auto const count = std::min(ioSegments.size() - first, maxIoSegments);
+    this->countSocketCall();
+    auto bytesJustSent = socket_sendv(fdSocket, &ioSegments[first], count);
+#ifndef _WIN64
+    if (bytesJustSent < 0 && errno == EINTR) { continue; }
+#endif
+    if (bytesJustSent <= 0) {
+      spdlog::warn("Error sending message after {} of {} bytes: {}.", sent, header.size() + size, bytesJustSent);
       return false;
     }
+    sent += static_cast<std::size_t>(bytesJustSent);
+
+    // Skip the segments that were sent completely and resume within the first one that was not.
+    first = skipIoSegments(ioSegments, first, static_cast<std::size_t>(bytesJustSent));
   }
 
-  ++this->numberOfMessagesSentSinceStart;
+  countSentMessage(size);
+  return true;
+}
+
+auto dataspree::inference::TcpConnection::countSentMessage(std::size_t const size) const -> void {
+  auto const messageNumber = ++this->numberOfMessagesSentSinceStart;
   if (++this->numberOfMessagesSent % 100 == 0) {
     auto const [framerate, now] = this->getFramerateSent();
-    spdlog::debug("Sent out message #{} of size {}; {}fps {}ms.",
-      numberOfMessagesSentSinceStart,
-      size,
-      framerate,
-      1000 / framerate);
+    spdlog::debug("Sent out message #{} of size {}; {}fps {}ms.", messageNumber, size, framerate, 1000 / framerate);
 
     this->numberOfMessagesSent = 0;
     this->timeSent = now;
   } else {
-    spdlog::debug("Sent out message #{} of size {}.", numberOfMessagesSentSinceStart, size);
+    spdlog::debug("Sent out message #{} of size {}.", messageNumber, size);
   }
+}
 
+auto dataspree::inference::TcpConnection::countReceivedMessage(std::size_t const size) const noexcept -> void {
+  ++this->numberOfMessagesReceivedSinceStart;
+  if (++this->numberOfMessagesReceived % 100 == 0) {
+    auto const [framerate, now] = this->getFramerateReceived();
+    if (this->maxLatestMessages > 0) {
+      spdlog::debug("Received message #{} of size {}; {}fps {}ms; {} dropped.",
+        numberOfMessagesReceivedSinceStart,
+        size,
+        framerate,
+        1000 / framerate,
+        this->getNumberOfMessagesDropped());
+    } else {
+      spdlog::debug("Received message #{} of size {}; {}fps {}ms.",
+        numberOfMessagesReceivedSinceStart,
+        size,
+        framerate,
+        1000 / framerate);
+    }
+
+    this->numberOfMessagesReceived = 0;
+    this->timeReceived = now;
+  } else {
+    spdlog::debug("Received message #{} of size {}.", numberOfMessagesReceivedSinceStart, size);
+  }
+}
+
+auto dataspree::inference::TcpConnection::encodePendingMessage(PendingMessage &pending) const -> void {
+  pending.message =
+    encodeMessage(pending.messageItem, this->receiveProperties.getEncodingMode(), "", this->encodeProperties);
+  pending.size = pending.message.size();
+  pending.header = frameHeader(pending.size);
+}
+
+auto dataspree::inference::TcpConnection::appendMessageItem(core::Item &&messageItem) -> void {
+  // The message is encoded from the queued item, which it may refer to.
+  auto &pending = this->sendQueue.emplace_back(PendingMessage{ .messageItem = std::move(messageItem) });
+  try {
+    this->encodePendingMessage(pending);
+  } catch (...) {
+    this->sendQueue.pop_back();
+    throw;
+  }
+}
+
+auto dataspree::inference::TcpConnection::sendItemBatches(std::span<core::Item const> items,
+  std::string const &consumerName) -> bool {
+  auto const batchSize = this->batchProperties.maxBatchSize;
+
+  // NOLINTNEXTLINE(altera-unroll-loops)
+  for (std::size_t first = 0; first < items.size(); first += batchSize) {
+    auto const batch = items.subspan(first, std::min(batchSize, items.size() - first));
+    if (this->batchProperties.envelope) {
+      core::Item messageItem{};
+      messageItem["consumer_name"] = consumerName;
+      messageItem["items"] = std::vector<core::Item>(batch.begin(), batch.end());
+      if (!this->sendMessageItem(std::move(messageItem))) { return false; }
+    } else if (!this->sendMessageItems(batch, consumerName)) {
+      return false;
+    }
+  }
   return true;
 }
 
+auto dataspree::inference::TcpConnection::sendMessageItems(std::span<core::Item const> items,
+  std::string const &consumerName) -> bool {
+  if (!connected()) { return false; }
+
+  auto const messageItem = [&consumerName](core::Item const &item) {
+    core::Item message{};
+    message["consumer_name"] = consumerName;
+    message["item"] = item;
+    return message;
+  };
+
+  // NOLINTBEGIN(altera-unroll-loops)
+  if (this->nonBlocking) {
+    for (auto const &item : items) { this->appendMessageItem(messageItem(item)); }
+    return this->flushSendQueue();
+  }
+  if (this->producerWriter.joinable()) {
+    // The writer sends the messages that are queued together with a single call.
+    for (auto const &item : items) {
+      if (!this->enqueueProducerMessage(messageItem(item))) { return false; }
+    }
+    return true;
+  }
+
+  // The messages stay in place while they are sent, as they may refer to their items.
+  std::vector<std::unique_ptr<PendingMessage>> batch{};
+  std::vector<PendingMessage *> messages{};
+  batch.reserve(items.size());
+  messages.reserve(items.size());
+  for (auto const &item : items) {
+    auto &pending =
+      batch.emplace_back(std::make_unique<PendingMessage>(PendingMessage{ .messageItem = messageItem(item) }));
+    this->encodePendingMessage(*pending);
+    messages.push_back(pending.get());
+  }
+  // NOLINTEND(altera-unroll-loops)
+
+  return this->sendPendingMessages(messages);
+}
 
-[[nodiscard]] auto dataspree::inference::TcpConnection::receiveNumberOfBytes(
-  std::size_t const numberRequiredBytes) const noexcept -> std::optional<std::vector<char>> {
+auto dataspree::inference::TcpConnection::flushSendQueue() -> bool {
+  thread_local std::vector<IoSegment> ioSegments{};
 
-  auto const start = std::chrono::steady_clock::now();
+  // NOLINTBEGIN(altera-unroll-loops)
+  while (!this->sendQueue.empty()) {
+    // Gather the frames of as many queued messages as fit into a single call.
+    ioSegments.clear();
+    for (auto const &pending : this->sendQueue) {
+      if (ioSegments.size() >= maxIoSegments) { break; }
+      appendIoSegments(ioSegments, pending.header, pending.message.segments, pending.sent);
+    }
 
-  if (!connected()) { return std::nullopt; }
+    this->countSocketCall();
+    auto const bytesJustSent =
+      socket_sendv(fdSocket, ioSegments.data(), std::min(ioSegments.size(), maxIoSegments));
+    if (bytesJustSent < 0 && socketInterrupted()) { return true; }
+    if (bytesJustSent <= 0) {
+      spdlog::warn("Error sending queued message: {}.", bytesJustSent);
+      return false;
+    }
 
-  auto buffer = std::vector<char>(numberRequiredBytes);
-  auto numberReceivedBytes = std::size_t{ 0 };
+    for (auto remaining = static_cast<std::size_t>(bytesJustSent); remaining > 0;) {
+      auto &front = this->sendQueue.front();
+      auto const unsent = frameHeaderSize + front.size - front.sent;
+      if (remaining < unsent) {
+        front.sent += remaining;
+        break;
+      }
+      remaining -= unsent;
+      countSentMessage(front.size);
+      this->sendQueue.pop_front();
+    }
+  }
+  // NOLINTEND(altera-unroll-loops)
 
+  return true;
+}
+
+auto dataspree::inference::TcpConnection::setNonBlocking(bool const enable) -> bool {
+  if (enable && (this->maxLatestMessages > 0 || this->maxProducerMessages > 0 || this->ioUring)) { return false; }
+  if (!socketConnected() || !socketSetNonBlocking(this->fdSocket, enable)) { return false; }
+  this->nonBlocking = enable;
+
+  // Blocking sends of the messages that are still queued.
+  return enable || this->flushSendQueue();
+}
+
+auto dataspree::inference::TcpConnection::setMultiProducer(std::size_t const maxQueuedMessages) -> bool {
+  if (this->nonBlocking) { return false; }
+
+  this->stopProducerWriter();
+  this->maxProducerMessages = maxQueuedMessages;
+  this->startProducerWriter();
+  return true;
+}
+
+auto dataspree::inference::TcpConnection::startProducerWriter() -> void {
+  if (this->maxProducerMessages == 0 || !connected()) { return; }
+
+  this->producerWriterFailed = false;
+  this->producerWriter = std::thread([this]() { this->writeProducerMessages(); });
+}
+
+auto dataspree::inference::TcpConnection::stopProducerWriter() -> void {
+  if (!this->producerWriter.joinable()) { return; }
+
+  this->pushProducerMessage(new ProducerMessage{ .pending = PendingMessage{ .messageItem = {} }, .last = true });
+  this->producerWriter.join();
+}
+
+auto dataspree::inference::TcpConnection::setIoUring(bool const enable) -> bool {
+  if (enable && this->nonBlocking) { return false; }
+
+  // The threads of the other modes receive and send with the rings.
+  this->stopLatestMessagesReceiver();
+  this->stopProducerWriter();
+  this->stopIoUring();
+
+  // Without a connection, availability is detected with a probe ring (f.i., io_uring may be disabled in containers).
+  this->ioUring = enable && (connected() || IoUring::create(2, 1, 4096) != nullptr);
+  this->startIoUring();
+
+  this->startLatestMessagesReceiver();
+  this->startProducerWriter();
+  return this->ioUring == enable;
+}
+
+auto dataspree::inference::TcpConnection::startIoUring() -> void {
+  if (!this->ioUring || !connected()) { return; }
+
+  if (this->isReceiveConfigured()) {
+    this->receiveRing = IoUring::create(8, ioUringReceiveBuffers, ioUringReceiveBufferSize);
+  }
+  this->sendRing = IoUring::create(ioUringSendEntries);
+  if (this->sendRing == nullptr || (this->isReceiveConfigured() && this->receiveRing == nullptr)) {
+    spdlog::warn("Could not create the io_uring rings; using poll, read and sendmsg instead.");
+    this->stopIoUring();
+    this->ioUring = false;
+  }
+}
+
+auto dataspree::inference::TcpConnection::stopIoUring() -> void {
   // NOLINTNEXTLINE(altera-unroll-loops)
-  while (numberReceivedBytes < numberRequiredBytes) {
-    auto const numberMissingBytes = numberRequiredBytes - numberReceivedBytes;
-    if (auto const numberNewBytes = socket_read(fdSocket, &buffer[numberReceivedBytes], numberMissingBytes);
-        numberNewBytes < 0) {
-      return std::nullopt;
+  for (auto *ring : { &this->receiveRing, &this->sendRing }) {
+    if (*ring == nullptr) { continue; }
+    this->numberOfSocketCalls.fetch_add((*ring)->getNumberOfSyscalls(), std::memory_order_relaxed);
+    ring->reset();
+  }
+}
 
-    } else if (numberNewBytes == 0 and this->timeoutMs > 0) {
-      auto const finish = std::chrono::steady_clock::now();
-      auto const elapsedSeconds = std::chrono::duration_cast<std::chrono::duration<double>>(finish - start).count();
-      if (elapsedSeconds * 1000 > static_cast<double>(this->timeoutMs)) { return std::nullopt; }
+auto dataspree::inference::TcpConnection::getNumberOfSocketCalls() const noexcept -> uint64_t {
+  auto calls = this->numberOfSocketCalls.load(std::memory_order_relaxed);
+  if (this->receiveRing != nullptr) { calls += this->receiveRing->getNumberOfSyscalls(); }
+  if (this->sendRing != nullptr) { calls += this->sendRing->getNumberOfSyscalls(); }
+  return calls;
+}
+
+auto dataspree::inference::TcpConnection::enqueueProducerMessage(core::Item &&messageItem) -> bool {
+  if (this->producerWriterFailed.load(std::memory_order_acquire)) { return false; }
+
+  // The message is encoded from its item, which it may refer to; both stay in place until the message is sent.
+  auto message = std::make_unique<ProducerMessage>(
+    ProducerMessage{ .pending = PendingMessage{ .messageItem = std::move(messageItem) } });
+  this->encodePendingMessage(message->pending);
+
+  // Wait while the queue is full; the writer signals every batch that it sent (or dropped).
+  auto queued = this->numberOfProducerMessages.load(std::memory_order_acquire);
+  // NOLINTNEXTLINE(altera-unroll-loops)
+  while (queued >= this->maxProducerMessages
+         || !this->numberOfProducerMessages.compare_exchange_weak(queued, queued + 1, std::memory_order_acq_rel)) {
+    if (queued >= this->maxProducerMessages) {
+      this->numberOfProducerMessages.wait(queued, std::memory_order_acquire);
+      if (this->producerWriterFailed.load(std::memory_order_acquire)) { return false; }
+      queued = this->numberOfProducerMessages.load(std::memory_order_acquire);
+    }
+  }
+
+  this->pushProducerMessage(message.release());
+  return true;
+}
+
+auto dataspree::inference::TcpConnection::pushProducerMessage(ProducerMessage *const message) noexcept -> void {
+  auto *newest = this->producerMessages.load(std::memory_order_relaxed);
+  do {
+    message->next = newest;
+    // NOLINTNEXTLINE(altera-unroll-loops)
+  } while (!this->producerMessages.compare_exchange_weak(
+    newest, message, std::memory_order_release, std::memory_order_relaxed));
+
+  // The writer only waits while the queue is empty.
+  if (newest == nullptr) { this->producerMessages.notify_one(); }
+}
+
+auto dataspree::inference::TcpConnection::writeProducerMessages() -> void {
+  std::vector<std::unique_ptr<ProducerMessage>> batch{};
+  std::vector<PendingMessage *> messages{};
+
+  // NOLINTBEGIN(altera-unroll-loops)
+  while (true) {
+    this->producerMessages.wait(nullptr, std::memory_order_acquire);
+    this->lingerForProducerMessages();
+
+    // Take all queued messages at once; they are linked from the newest to the oldest.
+    batch.clear();
+    messages.clear();
+    for (auto *message = this->producerMessages.exchange(nullptr, std::memory_order_acquire); message != nullptr;) {
+      batch.emplace_back(std::exchange(message, message->next));
+    }
+    std::reverse(batch.begin(), batch.end());
+
+    auto last = false;
+    for (auto const &message : batch) {
+      if (message->last) {
+        last = true;
+      } else {
+        messages.push_back(&message->pending);
+      }
+    }
+
+    // Written in batches of at most maxBatchSize messages, after each of which the producers may queue again.
+    // Messages of a failed connection are dropped, such that no producer waits for them.
+    auto const maxBatchSize = this->batchProperties.maxBatchSize;
+    for (std::size_t begin = 0; begin < messages.size(); begin += maxBatchSize) {
+      auto const chunk = std::span(messages).subspan(begin, std::min(maxBatchSize, messages.size() - begin));
+      if (!this->producerWriterFailed.load(std::memory_order_relaxed) && !this->sendPendingMessages(chunk)) {
+        this->producerWriterFailed.store(true, std::memory_order_release);
+      }
+      this->numberOfProducerMessages.fetch_sub(chunk.size(), std::memory_order_acq_rel);
+      this->numberOfProducerMessages.notify_all();
+    }
+
+    if (last) { return; }
+  }
+  // NOLINTEND(altera-unroll-loops)
+}
+
+auto dataspree::inference::TcpConnection::lingerForProducerMessages() const -> void {
+  if (this->batchProperties.linger.count() <= 0) { return; }
+
+  // Producers do not signal every message; the queue is checked at a fraction of the linger time.
+  auto const fullBatch = std::min(this->batchProperties.maxBatchSize, this->maxProducerMessages);
+  auto const step = std::max(this->batchProperties.linger / 8, std::chrono::microseconds(10));
+  auto const deadline = std::chrono::steady_clock::now() + this->batchProperties.linger;
+  // NOLINTNEXTLINE(altera-unroll-loops)
+  while (this->numberOfProducerMessages.load(std::memory_order_acquire) < fullBatch
+         && std::chrono::steady_clock::now() < deadline) {
+    std::this_thread::sleep_for(step);
+  }
+}
+
+auto dataspree::inference::TcpConnection::sendPendingMessages(std::span<PendingMessage *const> messages) const
+  -> bool {
+  thread_local std::vector<IoSegment> ioSegments{};
+
+  // NOLINTBEGIN(altera-unroll-loops)
+  // Account #sent bytes to the messages in order.
+  auto const advance = [this, &messages](std::size_t sent) {
+    while (sent > 0) {
+      auto &front = *messages.front();
+      auto const unsent = frameHeaderSize + front.size - front.sent;
+      if (sent < unsent) {
+        front.sent += sent;
+        break;
+      }
+      sent -= unsent;
+      countSentMessage(front.size);
+      messages = messages.subspan(1);
+    }
+  };
+
+  if (this->sendRing != nullptr) {
+    // One frame (header and body) per message, submitted together; the messages that the ring did not send
+    // completely are resumed below.
+    thread_local std::vector<std::size_t> frameBegins{};
+    thread_local std::vector<std::span<IoSegment const>> frames{};
+    ioSegments.clear();
+    frameBegins.clear();
+    for (auto const *pending : messages) {
+      frameBegins.push_back(ioSegments.size());
+      appendIoSegments(ioSegments, pending->header, pending->message.segments, pending->sent);
+    }
+    frameBegins.push_back(ioSegments.size());
+
+    frames.clear();
+    for (std::size_t index = 0; index + 1 < frameBegins.size(); ++index) {
+      frames.push_back(std::span<IoSegment const>(ioSegments).subspan(
+        frameBegins[index], frameBegins[index + 1] - frameBegins[index]));
+    }
+    advance(ring_sendv(*this->sendRing, fdSocket, frames, this->sendDeadline()));
+  }
+
+  while (!messages.empty()) {
+    // Gather the frames of as many messages as fit into a single call.
+    ioSegments.clear();
+    for (auto const *pending : messages) {
+      if (ioSegments.size() >= maxIoSegments) { break; }
+      appendIoSegments(ioSegments, pending->header, pending->message.segments, pending->sent);
+    }
+
+    this->countSocketCall();
+    auto const bytesJustSent =
+      socket_sendv(fdSocket, ioSegments.data(), std::min(ioSegments.size(), maxIoSegments));
+#ifndef _WIN64
+    if (bytesJustSent < 0 && errno == EINTR) { continue; }
+#endif
+    if (bytesJustSent <= 0) {
+      spdlog::warn("Error sending queued message: {}.", bytesJustSent);
+      return false;
+    }
+    advance(static_cast<std::size_t>(bytesJustSent));
+  }
+  // NOLINTEND(altera-unroll-loops)
+
+  return true;
+}
+
+auto dataspree::inference::TcpConnection::setLatestMessagesOnly(std::size_t const count) -> bool {
+  if (this->nonBlocking) { return false; }
+  if (count > 0 && this->receiveProperties.getDecodeProperties().tileDeltaDecoder != nullptr) { return false; }
+
+  this->stopLatestMessagesReceiver();
+  this->maxLatestMessages = count;
+  this->startLatestMessagesReceiver();
+  return true;
+}
+
+auto dataspree::inference::TcpConnection::startLatestMessagesReceiver() -> void {
+  if (this->maxLatestMessages == 0 || !this->isReceiveConfigured() || !connected()) { return; }
+
+  {
+    std::scoped_lock const lock(this->latestMessages.mutex);
+    this->latestMessages.status = ReceiveStatus::OK;
+    this->latestMessages.stopping = false;
+  }
+  this->latestMessages.receiver = std::thread([this]() { this->receiveLatestMessages(); });
+}
+
+auto dataspree::inference::TcpConnection::stopLatestMessagesReceiver() -> void {
+  if (!this->latestMessages.receiver.joinable()) { return; }
+
+  {
+    std::scoped_lock const lock(this->latestMessages.mutex);
+    this->latestMessages.stopping = true;
+  }
+  this->latestMessages.receiver.join();
+
+  std::scoped_lock const lock(this->latestMessages.mutex);
+  // NOLINTNEXTLINE(altera-unroll-loops)
+  for (auto &message : this->latestMessages.messages) {
+    this->latestMessages.spareBuffers.push_back(std::move(message.second));
+  }
+  this->latestMessages.messages.clear();
+}
+
+auto dataspree::inference::TcpConnection::receiveLatestMessages() const noexcept -> void {
+  std::vector<std::pair<EncodingMode, std::span<char const>>> arrived{};
+
+  // NOLINTNEXTLINE(altera-unroll-loops)
+  while (true) {
+    {
+      std::scoped_lock const lock(this->latestMessages.mutex);
+      if (this->latestMessages.stopping) { return; }
+    }
+
+    // Wait for the rest of the next message; the socket is drained by every read (see fillReceiveBuffer).
+    auto numberRequiredBytes = frameHeaderSize;
+    if (this->receiveEnd - this->receiveBegin >= frameHeaderSize) {
+      numberRequiredBytes += this->bufferedMessageSize();
+    }
+    auto const status =
+      fillReceiveBuffer(numberRequiredBytes, std::chrono::steady_clock::now() + latestMessagesPollInterval);
+    if (status == ReceiveStatus::TIMEOUT) { continue; }
+
+    std::scoped_lock const lock(this->latestMessages.mutex);
+    if (status != ReceiveStatus::OK) {
+      this->latestMessages.status = status;
+      this->latestMessages.received.notify_all();
+      return;
+    }
+
+    // Only the headers are read; of the messages that arrived together, only the newest ones are copied.
+    arrived.clear();
+    // NOLINTNEXTLINE(altera-unroll-loops)
+    while (auto const message = this->takeBufferedFrame()) { arrived.push_back(message.value()); }
+
+    auto const kept = std::min(arrived.size(), this->maxLatestMessages);
+    auto dropped = arrived.size() - kept;
+    // NOLINTNEXTLINE(altera-unroll-loops)
+    for (auto const &[encodingMode, payload] : std::span(arrived).last(kept)) {
+      auto &messages = this->latestMessages.messages;
+      auto &spareBuffers = this->latestMessages.spareBuffers;
+      if (messages.size() == this->maxLatestMessages) {
+        spareBuffers.push_back(std::move(messages.front().second));
+        messages.pop_front();
+        ++dropped;
+      }
+
+      std::vector<char> buffer{};
+      if (!spareBuffers.empty()) {
+        buffer = std::move(spareBuffers.back());
+        spareBuffers.pop_back();
+      }
+      buffer.assign(payload.begin(), payload.end());
+      messages.emplace_back(encodingMode, std::move(buffer));
+    }
+
+    this->numberOfMessagesDroppedSinceStart.fetch_add(dropped, std::memory_order_relaxed);
+    if (kept > 0) { this->latestMessages.received.notify_one(); }
+  }
+}
+
+auto dataspree::inference::TcpConnection::takeLatestMessage(
+  std::optional<std::chrono::steady_clock::time_point> const deadline) const noexcept
+  -> std::tuple<ReceiveStatus, EncodingMode, std::span<char const>> {
+  std::unique_lock lock(this->latestMessages.mutex);
+  auto const ready = [this]() {
+    return !this->latestMessages.messages.empty() || this->latestMessages.status != ReceiveStatus::OK;
+  };
+  if (deadline.has_value()) {
+    this->latestMessages.received.wait_until(lock, deadline.value(), ready);
+  } else {
+    this->latestMessages.received.wait(lock, ready);
+  }
+
+  // Messages that were kept before the receiver stopped are taken first.
+  if (this->latestMessages.messages.empty()) {
+    this->receiveStatus =
+      this->latestMessages.status != ReceiveStatus::OK ? this->latestMessages.status : ReceiveStatus::TIMEOUT;
+    return { this->receiveStatus, EncodingMode{}, {} };
+  }
+
+  auto [encodingMode, payload] = std::move(this->latestMessages.messages.front());
+  this->latestMessages.messages.pop_front();
+  this->latestMessages.spareBuffers.push_back(std::exchange(this->latestMessage, std::move(payload)));
+  lock.unlock();
+
+  this->receiveStatus = ReceiveStatus::OK;
+  this->countReceivedMessage(this->latestMessage.size());
+  return { ReceiveStatus::OK, encodingMode, this->latestMessage };
+}
+
+auto dataspree::inference::TcpConnection::receiveAvailable() noexcept -> ReceiveStatus {
+  if (!connected()) { return this->receiveStatus = ReceiveStatus::FAILED; }
+
+  // Room for the message that is received next (or for its header).
+  auto numberRequiredBytes = frameHeaderSize;
+  if (auto const buffered = this->receiveEnd - this->receiveBegin; buffered >= frameHeaderSize) {
+    numberRequiredBytes += this->bufferedMessageSize();
+    numberRequiredBytes = std::max(numberRequiredBytes, buffered + 1);
+  }
+  if (!reserveReceiveBuffer(numberRequiredBytes)) { return this->receiveStatus = ReceiveStatus::FAILED; }
+
+  this->countSocketCall();
+  auto const numberNewBytes =
+    socket_read(fdSocket, &this->receiveBuffer[this->receiveEnd], this->receiveBuffer.size() - this->receiveEnd);
+  if (numberNewBytes == 0) { return this->receiveStatus = ReceiveStatus::CLOSED; }
+  if (numberNewBytes < 0) {
+    return this->receiveStatus = socketInterrupted() ? ReceiveStatus::OK : ReceiveStatus::FAILED;
+  }
+
+  this->receiveEnd += static_cast<std::size_t>(numberNewBytes);
+  return this->receiveStatus = ReceiveStatus::OK;
+}
+
+[[nodiscard]] auto dataspree::inference::TcpConnection::reserveReceiveBuffer(
+  std::size_t const numberRequiredBytes) const noexcept -> bool {
+  // Move the unconsumed bytes to the front if the message would not fit behind them.
+  if (this->receiveBegin == this->receiveEnd) {
+    this->receiveBegin = 0;
+    this->receiveEnd = 0;
+  } else if (this->receiveBegin + numberRequiredBytes > this->receiveBuffer.size()) {
+    std::memmove(this->receiveBuffer.data(),
+      &this->receiveBuffer[this->receiveBegin],
+      this->receiveEnd - this->receiveBegin);
+    this->receiveEnd -= this->receiveBegin;
+    this->receiveBegin = 0;
+  }
+  if (this->receiveBuffer.size() < this->receiveBegin + numberRequiredBytes) {
+    try {
+      this->receiveBuffer.resize(
+        std::max({ this->receiveBegin + numberRequiredBytes, 2 * this->receiveBuffer.size(), minReceiveBufferSize }));
+    } catch (std::bad_alloc const &) {
+      spdlog::warn("Could not allocate a receive buffer of {} bytes.", numberRequiredBytes);
+      return false;
+    }
+  }
+  return true;
+}
+
+[[nodiscard]] auto dataspree::inference::TcpConnection::fillReceiveBuffer(std::size_t const numberRequiredBytes,
+  std::optional<std::chrono::steady_clock::time_point> const deadline) const noexcept -> ReceiveStatus {
+  if (this->receiveEnd - this->receiveBegin >= numberRequiredBytes) { return ReceiveStatus::OK; }
+
+  if (!connected()) { return ReceiveStatus::FAILED; }
+
+  if (!reserveReceiveBuffer(numberRequiredBytes)) { return ReceiveStatus::FAILED; }
+
+  // NOLINTNEXTLINE(altera-unroll-loops)
+  while (this->receiveEnd - this->receiveBegin < numberRequiredBytes) {
+    if (this->receiveRing != nullptr) {
+      // Data that arrived since the last call is usually completed already, which costs no system call.
+      auto const numberNewBytes = this->receiveRing->receive(static_cast<int>(fdSocket),
+        std::span(&this->receiveBuffer[this->receiveEnd], this->receiveBuffer.size() - this->receiveEnd),
+        deadline);
+      if (numberNewBytes == IoUring::timedOut) { return ReceiveStatus::TIMEOUT; }
+      if (numberNewBytes == 0) { return ReceiveStatus::CLOSED; }
+      if (numberNewBytes < 0) { return ReceiveStatus::FAILED; }
+      this->receiveEnd += static_cast<std::size_t>(numberNewBytes);
+      continue;
+    }
+
+    auto waitMs = -1;
+    if (deadline.has_value()) {
+      auto const remaining =
+        std::chrono::ceil<std::chrono::milliseconds>(deadline.value() - std::chrono::steady_clock::now()).count();
+      if (remaining <= 0) { return ReceiveStatus::TIMEOUT; }
+      waitMs = static_cast<int>(std::min<decltype(remaining)>(remaining, std::numeric_limits<int>::max()));
+    }
+
+    this->countSocketCall();
+    if (auto const ready = socket_poll(fdSocket, waitMs); ready == 0) {
+      return ReceiveStatus::TIMEOUT;
+    } else if (ready < 0) {
+      if (socketInterrupted()) { continue; }
+      return ReceiveStatus::FAILED;
+    }
+
+    this->countSocketCall();
+    if (auto const numberNewBytes = socket_read(
+          fdSocket, &this->receiveBuffer[this->receiveEnd], this->receiveBuffer.size() - this->receiveEnd);
+        numberNewBytes == 0) {
+      return ReceiveStatus::CLOSED;
+
+    } else if (numberNewBytes < 0) {
+      if (socketInterrupted()) { continue; }
+      return ReceiveStatus::FAILED;
 
     } else {
-      numberReceivedBytes += static_cast<std::size_t>(numberNewBytes);
+      this->receiveEnd += static_cast<std::size_t>(numberNewBytes);
     }
   }
 
-  assert(numberReceivedBytes == numberRequiredBytes);
-  return buffer;
+  return ReceiveStatus::OK;
 }
 
 void dataspree::inference::TcpConnection::_disconnect() {
+  this->stopLatestMessagesReceiver();
+  this->stopProducerWriter();
+  // The rings cancel their operations on the socket before it is closed.
+  this->stopIoUring();
+
 #ifdef _WIN64
   try {
     if (this->fdClient >= 0) {
@@ -149,6 +880,12 @@ void dataspree::inference::TcpConnection::_disconnect() {
   }
   this->fdSocket = invalidSocket;
 
+  // Bytes of the previous connection do not continue on the next one.
+  this->receiveBegin = 0;
+  this->receiveEnd = 0;
+  this->sendQueue.clear();
+  this->nonBlocking = false;
+
 #ifdef _WIN64
   WSACleanup();
 #endif
@@ -196,14 +933,28 @@ auto dataspree::inference::TcpConnection::_connect() -> void {
     setsockopt(this->fdSocket, SOL_SOCKET, SO_SNDTIMEO, static_cast<const void *>(&timeval), sizeof(timeval));
 #endif
 
+    // Tile deltas refer to frames of the previous connection, which the peer may not have received.
+    if (auto const &encoder = this->encodeProperties.tileDeltaEncoder; encoder != nullptr) {
+      encoder->requestKeyframe();
+    }
+    if (auto const &decoder = this->receiveProperties.getDecodeProperties().tileDeltaDecoder; decoder != nullptr) {
+      decoder->reset();
+    }
+
     this->sendUpdateReceiveProperties();
 
     this->numberOfMessagesReceivedSinceStart = 0;
     this->numberOfMessagesSentSinceStart = 0;
+    this->numberOfMessagesDroppedSinceStart = 0;
     this->numberOfMessagesReceived = 0;
     this->numberOfMessagesSent = 0;
     this->timeSent = std::chrono::steady_clock::now();
     this->timeReceived = std::chrono::steady_clock::now();
+    this->numberOfSocketCalls = 0;
+
+    this->startIoUring();
+    this->startLatestMessagesReceiver();
+    this->startProducerWriter();
   }
 }
 
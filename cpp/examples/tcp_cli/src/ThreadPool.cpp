@@ -0,0 +1,40 @@
+#include <ThreadPool.hpp>
+
+#include <algorithm>
+
+dataspree::inference::ThreadPool::ThreadPool(std::size_t const numberOfThreads) {
+  auto const numberOfWorkers = std::max<std::size_t>(numberOfThreads, 1);
+  this->workers.reserve(numberOfWorkers);
+
+  // NOLINTNEXTLINE(altera-unroll-loops)
+  for (std::size_t i = 0; i < numberOfWorkers; ++i) {
+    this->workers.emplace_back([this]() { this->work(); });
+  }
+}
+
+dataspree::inference::ThreadPool::~ThreadPool() {
+  {
+    std::scoped_lock const lock(this->mutex);
+    this->stopping = true;
+  }
+  this->condition.notify_all();
+
+  // NOLINTNEXTLINE(altera-unroll-loops)
+  for (auto &worker : this->workers) { worker.join(); }
+}
+
+auto dataspree::inference::ThreadPool::work() -> void {
+  // NOLINTNEXTLINE(altera-unroll-loops)
+  while (true) {
+    std::function<void()> task;
+    {
+      std::unique_lock lock(this->mutex);
+      this->condition.wait(lock, [this]() { return this->stopping || !this->tasks.empty(); });
+      if (this->tasks.empty()) { return; }
+
+      task = std::move(this->tasks.front());
+      this->tasks.pop_front();
+    }
+    task();
+  }
+}
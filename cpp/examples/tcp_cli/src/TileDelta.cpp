@@ -0,0 +1,272 @@
+#include <FrameBufferPool.hpp>
+#include <TileDelta.hpp>
+
+#include <spdlog/spdlog.h>
+
+#include <dataspree/inference/core/Utils.hpp>
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cstdlib>
+#include <cstring>
+#include <limits>
+#include <numeric>
+
+// Payload layout (all integers little endian):
+//   magic "TDLT" | flags (u8, bit 0: keyframe) | sequence (u64) | reference sequence (u64)
+//   | rows (u32) | cols (u32) | type (u32) | tile size (u32) | number of tiles (u32)
+//   | number of tiles x [ tile index (u32) | tile content (rows x cols x elemSize bytes, clipped at the border) ]
+
+static constexpr std::array<unsigned char, 4> tileDeltaMagic{ 'T', 'D', 'L', 'T' };
+static constexpr std::size_t tileDeltaHeaderSize = 4 + 1 + 8 + 8 + 4 * 5;
+static constexpr unsigned char tileDeltaKeyframe = 0x01;
+
+template<typename T> static auto appendLittleEndian(std::vector<unsigned char> &bytes, T value) -> void {
+  auto const memory = dataspree::inference::core::toLittleEndian<T, unsigned char>(value);
+  bytes.insert(bytes.end(), memory.begin(), memory.end());
+}
+
+template<typename T>
+[[nodiscard]] static auto readLittleEndian(std::span<unsigned char const> bytes, std::size_t offset) -> T {
+  std::array<unsigned char, sizeof(T)> memory{};
+  std::memcpy(memory.data(), &bytes[offset], sizeof(T));
+  if constexpr (dataspree::inference::core::isBigEndian) { std::ranges::reverse(memory); }
+  return std::bit_cast<T>(memory);
+}
+
+/// Pixel region covered by the tile with the given index.
+[[nodiscard]] static auto tileRect(cv::Mat const &image, int tileSize, uint32_t tileIndex) -> cv::Rect {
+  auto const tilesPerRow = static_cast<uint32_t>((int64_t{ image.cols } + tileSize - 1) / tileSize);
+  auto const x = static_cast<int>(tileIndex % tilesPerRow) * tileSize;
+  auto const y = static_cast<int>(tileIndex / tilesPerRow) * tileSize;
+  return { x, y, std::min(tileSize, image.cols - x), std::min(tileSize, image.rows - y) };
+}
+
+/// \return true if any value of the tile differs by more than #threshold (8-bit depth) or at all (other depths).
+[[nodiscard]] static auto tileChanged(cv::Mat const &image,
+  cv::Mat const &reference,
+  cv::Rect const &rect,
+  int threshold) -> bool {
+  auto const rowBytes = static_cast<std::size_t>(rect.width) * image.elemSize();
+  auto const offset = static_cast<std::size_t>(rect.x) * image.elemSize();
+  auto const exact = threshold <= 0 || image.depth() != CV_8U;
+
+  // NOLINTBEGIN(altera-unroll-loops)
+  for (int row = rect.y; row < rect.y + rect.height; ++row) {
+    auto const *current = image.ptr<unsigned char>(row) + offset;
+    auto const *previous = reference.ptr<unsigned char>(row) + offset;
+
+    if (exact) {
+      if (std::memcmp(current, previous, rowBytes) != 0) { return true; }
+    } else {
+      for (std::size_t i = 0; i < rowBytes; ++i) {
+        if (std::abs(static_cast<int>(current[i]) - static_cast<int>(previous[i])) > threshold) { return true; }
+      }
+    }
+  }
+  // NOLINTEND(altera-unroll-loops)
+  return false;
+}
+
+auto dataspree::inference::TileDeltaEncoder::encode(std::string const &path, cv::Mat const &image)
+  -> std::vector<unsigned char> {
+
+  if (image.empty() || image.dims != 2 || this->properties.tileSize <= 0) {
+    spdlog::error("IMAGE_TILE_DELTA requires a non-empty two-dimensional image.");
+    return {};
+  }
+
+  auto const tileSize = this->properties.tileSize;
+  auto const tilesPerRow = static_cast<uint64_t>((int64_t{ image.cols } + tileSize - 1) / tileSize);
+  auto const tilesPerColumn = static_cast<uint64_t>((int64_t{ image.rows } + tileSize - 1) / tileSize);
+  if (tilesPerRow * tilesPerColumn > std::numeric_limits<uint32_t>::max()) {
+    spdlog::error("IMAGE_TILE_DELTA does not support {} tiles.", tilesPerRow * tilesPerColumn);
+    return {};
+  }
+  auto const numberOfTiles = static_cast<uint32_t>(tilesPerRow * tilesPerColumn);
+
+  std::scoped_lock const lock(this->mutex);
+  auto &reference = this->references[path];
+
+  auto const keyframe = reference.frame.empty() || reference.frame.rows != image.rows
+                        || reference.frame.cols != image.cols || reference.frame.type() != image.type()
+                        || (this->properties.keyframeInterval > 0
+                            && reference.framesSinceKeyframe + 1 >= this->properties.keyframeInterval);
+
+  auto const elemSize = image.elemSize();
+  std::vector<uint32_t> changedTiles{};
+  // Content of the changed tiles, which are clipped at the border.
+  std::size_t changedBytes{ 0 };
+  if (keyframe) {
+    reference.frame = image.clone();
+    reference.framesSinceKeyframe = 0;
+    changedTiles.resize(numberOfTiles);
+    std::iota(changedTiles.begin(), changedTiles.end(), uint32_t{ 0 });
+    changedBytes = image.total() * elemSize;
+
+  } else {
+    ++reference.framesSinceKeyframe;
+
+    // NOLINTNEXTLINE(altera-unroll-loops)
+    for (uint32_t tile = 0; tile < numberOfTiles; ++tile) {
+      auto const rect = tileRect(image, tileSize, tile);
+      if (tileChanged(image, reference.frame, rect, this->properties.threshold)) {
+        changedTiles.push_back(tile);
+        changedBytes += static_cast<std::size_t>(rect.width) * static_cast<std::size_t>(rect.height) * elemSize;
+
+        // The receiver only learns about transmitted tiles; unchanged tiles keep their previous content.
+        image(rect).copyTo(reference.frame(rect));
+      }
+    }
+  }
+
+  auto const referenceSequence = keyframe ? uint64_t{ 0 } : reference.sequence;
+  reference.sequence += 1;
+
+  std::vector<unsigned char> bytes{};
+  bytes.reserve(tileDeltaHeaderSize + changedTiles.size() * sizeof(uint32_t) + changedBytes);
+
+  bytes.insert(bytes.end(), tileDeltaMagic.begin(), tileDeltaMagic.end());
+  bytes.push_back(keyframe ? tileDeltaKeyframe : 0);
+  appendLittleEndian(bytes, reference.sequence);
+  appendLittleEndian(bytes, referenceSequence);
+  appendLittleEndian(bytes, static_cast<uint32_t>(image.rows));
+  appendLittleEndian(bytes, static_cast<uint32_t>(image.cols));
+  appendLittleEndian(bytes, static_cast<uint32_t>(image.type()));
+  appendLittleEndian(bytes, static_cast<uint32_t>(tileSize));
+  appendLittleEndian(bytes, static_cast<uint32_t>(changedTiles.size()));
+
+  // NOLINTBEGIN(altera-unroll-loops)
+  for (auto const tile : changedTiles) {
+    appendLittleEndian(bytes, tile);
+
+    auto const rect = tileRect(image, tileSize, tile);
+    auto const rowBytes = static_cast<std::size_t>(rect.width) * elemSize;
+    for (int row = rect.y; row < rect.y + rect.height; ++row) {
+      auto const *content = image.ptr<unsigned char>(row) + static_cast<std::size_t>(rect.x) * elemSize;
+      auto const start = bytes.size();
+      bytes.insert(bytes.end(), content, content + rowBytes);
+      core::toLittleEndian(&bytes[start], rowBytes, image.elemSize1());
+    }
+  }
+  // NOLINTEND(altera-unroll-loops)
+
+  return bytes;
+}
+
+auto dataspree::inference::TileDeltaEncoder::requestKeyframe() -> void {
+  std::scoped_lock const lock(this->mutex);
+  this->references.clear();
+}
+
+auto dataspree::inference::TileDeltaDecoder::decode(std::string const &path, std::span<unsigned char const> payload)
+  -> std::optional<cv::Mat> {
+
+  if (payload.size() < tileDeltaHeaderSize
+      || !std::equal(tileDeltaMagic.begin(), tileDeltaMagic.end(), payload.begin())) {
+    spdlog::warn("Could not decode tile delta image {}; invalid header.", path);
+    return std::nullopt;
+  }
+
+  auto const keyframe = (payload[4] & tileDeltaKeyframe) != 0;
+  auto const sequence = readLittleEndian<uint64_t>(payload, 5);
+  auto const referenceSequence = readLittleEndian<uint64_t>(payload, 13);
+  auto const rows = readLittleEndian<uint32_t>(payload, 21);
+  auto const cols = readLittleEndian<uint32_t>(payload, 25);
+  auto const type = readLittleEndian<uint32_t>(payload, 29);
+  auto const tileSize = readLittleEndian<uint32_t>(payload, 33);
+  auto const numberOfTiles = readLittleEndian<uint32_t>(payload, 37);
+
+  // The type must consist of a depth and a number of channels only (depth < CV_DEPTH_MAX, channels <= CV_CN_MAX).
+  constexpr auto maxInt = static_cast<uint32_t>(std::numeric_limits<int>::max());
+  if (rows == 0 || cols == 0 || rows > maxInt || cols > maxInt || type >= uint32_t{ CV_DEPTH_MAX * CV_CN_MAX }
+      || tileSize == 0 || tileSize > maxInt) {
+    spdlog::warn("Could not decode tile delta image {}; invalid size {}x{}, type {} or tile size {}.",
+      path,
+      cols,
+      rows,
+      type,
+      tileSize);
+    return std::nullopt;
+  }
+
+  auto const tilesPerRow = (static_cast<uint64_t>(cols) + tileSize - 1) / tileSize;
+  auto const tilesPerColumn = (static_cast<uint64_t>(rows) + tileSize - 1) / tileSize;
+
+  // A keyframe carries every tile (in order, see TileDeltaEncoder::encode), so that no pixel of the new frame stays
+  // uninitialized; bounding its size by the payload keeps a malformed header from allocating a huge frame.
+  auto const elemSize = static_cast<uint64_t>(CV_ELEM_SIZE(static_cast<int>(type)));
+  if (keyframe
+      && (numberOfTiles != tilesPerRow * tilesPerColumn
+          || uint64_t{ rows } * cols > (payload.size() - tileDeltaHeaderSize) / elemSize)) {
+    spdlog::warn("Could not decode tile delta image {}; keyframe of {}x{} with {} tiles in {} bytes.",
+      path,
+      cols,
+      rows,
+      numberOfTiles,
+      payload.size());
+    return std::nullopt;
+  }
+
+  std::scoped_lock const lock(this->mutex);
+  auto &reference = this->references[path];
+
+  auto frame = FrameBufferPool::instance().mat();
+  if (keyframe) {
+    frame.create(static_cast<int>(rows), static_cast<int>(cols), static_cast<int>(type));
+
+  } else if (reference.frame.empty() || reference.sequence != referenceSequence
+             || reference.frame.rows != static_cast<int>(rows) || reference.frame.cols != static_cast<int>(cols)
+             || reference.frame.type() != static_cast<int>(type)) {
+    spdlog::warn("Could not decode tile delta image {}; frame {} missing. Waiting for the next keyframe.",
+      path,
+      referenceSequence);
+    return std::nullopt;
+
+  } else {
+    frame = reference.frame;
+  }
+
+  std::size_t pos = tileDeltaHeaderSize;
+
+  // Tiles are applied to the reference in place; a malformed payload therefore invalidates the reference.
+  auto const malformed = [&]() -> std::optional<cv::Mat> {
+    spdlog::warn("Could not decode tile delta image {}; malformed payload.", path);
+    reference = Reference{};
+    return std::nullopt;
+  };
+
+  // NOLINTBEGIN(altera-unroll-loops)
+  for (uint32_t i = 0; i < numberOfTiles; ++i) {
+    if (pos + sizeof(uint32_t) > payload.size()) { return malformed(); }
+    auto const tile = readLittleEndian<uint32_t>(payload, pos);
+    pos += sizeof(uint32_t);
+    if (tile >= tilesPerRow * tilesPerColumn || (keyframe && tile != i)) { return malformed(); }
+
+    auto const rect = tileRect(frame, static_cast<int>(tileSize), tile);
+    auto const rowBytes = static_cast<std::size_t>(rect.width) * elemSize;
+    if (pos + rowBytes * static_cast<std::size_t>(rect.height) > payload.size()) { return malformed(); }
+
+    for (int row = rect.y; row < rect.y + rect.height; ++row) {
+      auto *content = frame.ptr<unsigned char>(row) + static_cast<std::size_t>(rect.x) * elemSize;
+      std::memcpy(content, &payload[pos], rowBytes);
+      core::toLittleEndian(content, rowBytes, frame.elemSize1());
+      pos += rowBytes;
+    }
+  }
+  // NOLINTEND(altera-unroll-loops)
+
+  reference.frame = frame;
+  reference.sequence = sequence;
+
+  // The application may modify the returned image; the reference must stay untouched.
+  auto image = FrameBufferPool::instance().mat();
+  frame.copyTo(image);
+  return image;
+}
+
+auto dataspree::inference::TileDeltaDecoder::reset() -> void {
+  std::scoped_lock const lock(this->mutex);
+  this->references.clear();
+}
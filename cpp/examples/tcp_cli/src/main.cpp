@@ -1,5 +1,12 @@
+#include <FrameBufferPool.hpp>
+#include <PipelinedConnection.hpp>
 #include <TcpConnection.hpp>
 
+#ifdef __linux__
+#include <EventLoop.hpp>
+#include <Task.hpp>
+#endif
+
 #include <dataspree/inference/core/Exception.hpp>
 #include <dataspree/inference/core/Item.hpp>
 
@@ -12,11 +19,207 @@
 
 #include <numbers>
 #include <chrono>
+#include <exception>
 #include <iostream>
 #include <string>
 #include <thread>
 #include <type_traits>
 
+/// Draw the detections of the received #item onto a copy of its image.
+/// \param displayImage reused for the copy; overwrites the buffer of the previous frame if the size did not change.
+/// \return true if the item contained an image, which was shown.
+auto visualize(dataspree::inference::core::Item const &item, cv::Mat &displayImage) -> bool {
+  auto const *image = item.find_at<cv::Mat>("image");
+  if (!image) { return false; }
+  image->copyTo(displayImage);
+
+  if (auto const *detections =
+        item.find_at<std::vector<dataspree::inference::core::Detection>>("inference", "detection");
+      detections) {
+    for (auto const &det : *detections) {
+      auto const centerX = static_cast<int>(std::max(det.x * static_cast<float>(image->cols), 0.0F));
+      auto const centerY = static_cast<int>(std::max(det.y * static_cast<float>(image->rows), 0.0F));
+      auto const width = static_cast<int>(std::max(det.width * static_cast<float>(image->cols), 0.0F));
+      auto const height = static_cast<int>(std::max(det.height * static_cast<float>(image->rows), 0.0F));
+      // auto const confidence = det.confidence;
+
+      auto const orientation = -det.orientation / std::numbers::pi_v<float> * 180;
+
+      auto const rect = cv::RotatedRect(cv::Point2f(static_cast<float>(centerX), static_cast<float>(centerY)),
+                                        cv::Size2f(static_cast<float>(width), static_cast<float>(height)),
+                                        orientation);
+      std::array<cv::Point2f, 4> vertices;
+      rect.points(vertices.data());
+#pragma unroll
+      for (std::size_t i = 0; i < 4; ++i) {
+        // NOLINTNEXTLINE(cppcoreguidelines-pro-bounds-constant-array-index)
+        line(displayImage, vertices[i], vertices[(i + 1) % 4], cv::Scalar(0, 255, 0), 2);
+      }
+    }
+  }
+  cv::imshow("visualization", displayImage);
+  cv::waitKey(1);
+  return true;
+}
+
+/// \return item that sends #displayImage (read from camera 0 if empty) with #sendImageEncoding.
+auto makeSendItem(cv::Mat &displayImage, std::size_t const messageCount, std::string const &sendImageEncoding)
+  -> dataspree::inference::core::Item {
+  // Read image from camera 0 if no image received.
+  if (displayImage.empty()) {
+    auto cam = cv::VideoCapture(0);
+    cam.read(displayImage);
+    cam.release();
+  }
+
+  dataspree::inference::core::Item item{};
+  item["image"] = displayImage;
+  item["id"] = messageCount;
+  item["encoded_elements"] = std::vector<dataspree::inference::core::Item>{};
+  item.at<std::vector<dataspree::inference::core::Item>>("encoded_elements")
+    .emplace_back(std::vector<dataspree::inference::core::Item>{
+      dataspree::inference::core::Item{ std::vector<std::string>{ "image" } },
+      dataspree::inference::core::Item{ sendImageEncoding } });
+  return item;
+}
+
+/// Same loop as in main, but receiving, visualizing and sending overlap (see PipelinedConnection).
+auto streamPipelined(dataspree::inference::TcpConnection &connection,
+  std::string const &consumerName,
+  std::string const &sendImageEncoding,
+  std::size_t const queueSize,
+  std::size_t const maxTimeouts) -> void {
+
+  dataspree::inference::PipelinedConnection pipeline(connection, queueSize, queueSize, maxTimeouts);
+  dataspree::inference::core::Item message{};
+
+  while (true) {
+
+    bool visualized = false;
+    auto displayImage = dataspree::inference::FrameBufferPool::instance().mat();
+    pipeline.start();
+
+    for (std::size_t messageCount = 0; ; ++messageCount) {
+
+      if (connection.isReceiveConfigured()) {
+        if (auto const status = pipeline.receive(message); status != dataspree::inference::ReceiveStatus::OK) {
+          if (status == dataspree::inference::ReceiveStatus::TIMEOUT) {
+            spdlog::warn("No message received within {} timeouts.", maxTimeouts);
+          }
+          break;
+        }
+
+        if (auto const *error = message.template find_at<std::string>("error"); error) {
+          throw std::runtime_error(error->c_str());
+        }
+
+        // Queued messages still send the previous image; the next one is drawn into a new buffer of the pool.
+        displayImage.release();
+        visualized = visualize(message.at("item"), displayImage) || visualized;
+      }
+
+      if (!consumerName.empty()) {
+        if (!pipeline.send(makeSendItem(displayImage, messageCount, sendImageEncoding), consumerName)) { break; }
+      }
+
+      if ((messageCount + 1) % 100 == 0) {
+        auto const statistics = pipeline.getStatistics();
+        spdlog::debug("Pipeline (busy / stalled ms per message): receive {:.2f} / {:.2f}, application {:.2f} / {:.2f}, "
+                      "send {:.2f} / {:.2f}; queued {} received, {} to send.",
+          statistics.receive.getBusyMs(),
+          statistics.receive.getStalledMs(),
+          statistics.application.getBusyMs(),
+          statistics.application.getStalledMs(),
+          statistics.send.getBusyMs(),
+          statistics.send.getStalledMs(),
+          statistics.receiveQueueDepth,
+          statistics.sendQueueDepth);
+      }
+    }
+
+    pipeline.stop();
+    if (visualized) {
+      cv::destroyWindow("visualization");
+      cv::waitKey(1);
+    }
+
+    // Attempt to reconnect
+    std::this_thread::sleep_for(std::chrono::seconds(2));
+    spdlog::info("Reconnecting.");
+    connection.establishConnection();
+  }
+}
+
+#ifdef __linux__
+/// Same loop as in main, written as a coroutine on #loop: receiving and sending suspend instead of blocking.
+auto streamAsync(dataspree::inference::EventLoop &loop,
+  dataspree::inference::TcpConnection &connection,
+  std::string const consumerName,
+  std::string const sendImageEncoding,
+  std::size_t const timeoutMs,
+  std::size_t const maxTimeouts) -> dataspree::inference::Task<void> {
+
+  // Received messages are decoded into the same item, so that its nodes are reused.
+  dataspree::inference::core::Item message{};
+
+  while (true) {
+
+    bool visualized = false;
+    auto displayImage = dataspree::inference::FrameBufferPool::instance().mat();
+
+    std::size_t timeouts{ 0 };
+    for (std::size_t messageCount = 0; ; ++messageCount) {
+
+      if (connection.isReceiveConfigured()) {
+        if (auto const status = co_await loop.receiveItemAsync(connection, message, timeoutMs);
+            status == dataspree::inference::ReceiveStatus::TIMEOUT) {
+          if (maxTimeouts == 0 || ++timeouts < maxTimeouts) { continue; }
+          spdlog::warn("No message received within {} timeouts.", maxTimeouts);
+          break;
+        } else if (status != dataspree::inference::ReceiveStatus::OK) {
+          break;
+        }
+        timeouts = 0;
+
+        if (auto const *error = message.template find_at<std::string>("error"); error) {
+          throw std::runtime_error(error->c_str());
+        }
+        visualized = visualize(message.at("item"), displayImage) || visualized;
+      }
+
+      if (!consumerName.empty()) {
+        // The image is sent from displayImage, so the next frame is only copied into it once the message was sent.
+        if (!co_await loop.sendItemAsync(connection, makeSendItem(displayImage, messageCount, sendImageEncoding),
+              consumerName)) {
+          break;
+        }
+      }
+    }
+
+    if (visualized) {
+      cv::destroyWindow("visualization");
+      cv::waitKey(1);
+    }
+
+    // Attempt to reconnect; the connection is added to the loop again by the next receive or send.
+    loop.remove(connection);
+    std::this_thread::sleep_for(std::chrono::seconds(2));
+    spdlog::info("Reconnecting.");
+    connection.establishConnection();
+  }
+}
+
+/// Await #task and stop #loop once it finished.
+auto runUntilDone(dataspree::inference::EventLoop &loop,
+  dataspree::inference::Task<void> task,
+  std::exception_ptr &failure) -> dataspree::inference::Task<void> {
+  try {
+    co_await task;
+  } catch (...) { failure = std::current_exception(); }
+  loop.stop();
+}
+#endif
+
 // NOLINTNEXTLINE(bugprone-exception-escape)
 auto main(int argc, char const *const *argv) -> int {
 
@@ -32,12 +235,36 @@ auto main(int argc, char const *const *argv) -> int {
     "Name of a registered Dataspree Inference Consumer or empty.")(
     "maxSendIntervalMs", boost::program_options::value<uint32_t>()->default_value(0))(
     "timeoutMs", boost::program_options::value<std::size_t>()->default_value(3500))(
+    "maxTimeouts", boost::program_options::value<std::size_t>()->default_value(10),
+    "Reconnect after this many receive timeouts in a row (f.i., if the peer vanished without closing the "
+    "connection); 0 waits indefinitely.")(
+    "decodeThreads", boost::program_options::value<std::size_t>()->default_value(0),
+    "Number of threads decoding the images of a received message concurrently; 0 decodes sequentially.")(
+    "encodeThreads", boost::program_options::value<std::size_t>()->default_value(0),
+    "Number of threads encoding the images of a sent message concurrently; 0 encodes sequentially.")(
+    "imageCacheSize", boost::program_options::value<std::size_t>()->default_value(0),
+    "Number of encoded images that are kept for repeated sends (f.i., of a static image); 0 disables the cache.")(
+    "minConfidence", boost::program_options::value<double>()->default_value(0.0),
+    "Detections with a lower confidence are dropped while decoding received messages.")(
+    "sendImageEncoding", boost::program_options::value<std::string>()->default_value("MAT_RAW"),
+    "Encoding of sent images (f.i., MAT_RAW, IMAGE_PNG, IMAGE_QOI or IMAGE_TILE_DELTA).")(
     "ip", boost::program_options::value<std::string>()->default_value("127.0.0.1"),
     "")("port", boost::program_options::value<uint16_t>()->default_value(6729), "")(
     "encoding",
     boost::program_options::value<int>()->default_value(
       dataspree::inference::core::getUnderlyingValue(dataspree::inference::EncodingMode::MSGPACK)),
-    "Encoding (0) JSON (1) MSGPACK.");
+    "Encoding (0) JSON (1) MSGPACK.")(
+    "async", boost::program_options::value<bool>()->default_value(false),
+    "Receive and send from a coroutine on an event loop (Linux only).")(
+    "pipelined", boost::program_options::value<bool>()->default_value(false),
+    "Receive and send on separate threads, overlapping with the visualization.")(
+    "pipelineQueueSize", boost::program_options::value<std::size_t>()->default_value(2),
+    "Number of messages that are queued between the threads of the pipelined mode.")(
+    "latestMessages", boost::program_options::value<std::size_t>()->default_value(0),
+    "Keep only this many of the newest received messages and drop older ones without decoding (IMAGE_TILE_DELTA "
+    "images are not decoded then); 0 keeps all.")(
+    "ioUring", boost::program_options::value<bool>()->default_value(false),
+    "Receive and send over io_uring if the kernel supports it (Linux only).");
 
   boost::program_options::variables_map variableMap;
   boost::program_options::store(boost::program_options::parse_command_line(argc, argv, description), variableMap);
@@ -48,88 +275,132 @@ auto main(int argc, char const *const *argv) -> int {
     return 0;
   }
   auto const consumerName = variableMap["consumerName"].as<std::string>();
-  auto connection = dataspree::inference::TcpConnection(
-    variableMap["ip"].as<std::string>(), variableMap["port"].as<uint16_t>(),
-    dataspree::inference::ReceiveProperties(
-      variableMap["producerName"].as<std::string>(),
-      dataspree::inference::EncodingMode(static_cast<EncodingModeType>(variableMap["encoding"].as<int>())),
-      variableMap["maxSendIntervalMs"].as<uint32_t>(),
-      variableMap["sendImage"].as<bool>()),
+
+  auto receiveProperties = dataspree::inference::ReceiveProperties(variableMap["producerName"].as<std::string>(),
+    dataspree::inference::EncodingMode(static_cast<EncodingModeType>(variableMap["encoding"].as<int>())),
+    variableMap["maxSendIntervalMs"].as<uint32_t>(),
+    variableMap["sendImage"].as<bool>());
+
+  auto const latestMessages = variableMap["latestMessages"].as<std::size_t>();
+  dataspree::inference::DecodeProperties decodeProperties{};
+  // Tile deltas cannot be decoded once the frames they refer to were dropped (see setLatestMessagesOnly).
+  if (latestMessages == 0) {
+    decodeProperties.tileDeltaDecoder = std::make_shared<dataspree::inference::TileDeltaDecoder>();
+  }
+  decodeProperties.typedDetections = true;
+  if (auto const minConfidence = variableMap["minConfidence"].as<double>(); minConfidence > 0.0) {
+    decodeProperties.filter.predicates.push_back({ { "inference", "detection" },
+      "confidence",
+      dataspree::inference::DecodeFilter::Comparison::GREATER_EQUAL,
+      minConfidence });
+  }
+  if (auto const decodeThreads = variableMap["decodeThreads"].as<std::size_t>(); decodeThreads > 0) {
+    decodeProperties.decodePool = std::make_shared<dataspree::inference::ThreadPool>(decodeThreads);
+  }
+  receiveProperties.setDecodeProperties(std::move(decodeProperties));
+
+  auto const sendImageEncoding = variableMap["sendImageEncoding"].as<std::string>();
+  dataspree::inference::EncodeProperties encodeProperties{};
+  if (auto const imageCacheSize = variableMap["imageCacheSize"].as<std::size_t>(); imageCacheSize > 0) {
+    encodeProperties.imageCache = std::make_shared<dataspree::inference::EncodedImageCache>(imageCacheSize);
+  }
+  if (sendImageEncoding == "IMAGE_TILE_DELTA") {
+    encodeProperties.tileDeltaEncoder = std::make_shared<dataspree::inference::TileDeltaEncoder>();
+  }
+  if (auto const encodeThreads = variableMap["encodeThreads"].as<std::size_t>(); encodeThreads > 0) {
+    encodeProperties.encodePool = std::make_shared<dataspree::inference::ThreadPool>(encodeThreads);
+  }
+
+  auto connection = dataspree::inference::TcpConnection(variableMap["ip"].as<std::string>(),
+    variableMap["port"].as<uint16_t>(),
+    std::move(receiveProperties),
     variableMap["timeoutMs"].as<std::size_t>());
+  connection.setEncodeProperties(std::move(encodeProperties));
+  if (latestMessages > 0) { connection.setLatestMessagesOnly(latestMessages); }
+  if (variableMap["ioUring"].as<bool>() && !connection.setIoUring(true)) {
+    spdlog::warn("io_uring is not available; using poll, read and sendmsg instead.");
+  }
 
 
   spdlog::set_level(spdlog::level::debug);
+  auto const maxTimeouts = variableMap["maxTimeouts"].as<std::size_t>();
+
+  if (variableMap["async"].as<bool>()) {
+#ifdef __linux__
+    if (connection.getLatestMessagesOnly() > 0) {
+      spdlog::error("The async option does not support latestMessages.");
+      return 1;
+    }
+    if (connection.getIoUring()) {
+      spdlog::error("The async option does not support ioUring.");
+      return 1;
+    }
+    dataspree::inference::EventLoop loop{};
+    std::exception_ptr failure{};
+    loop.spawn(runUntilDone(loop,
+      streamAsync(loop,
+        connection,
+        consumerName,
+        sendImageEncoding,
+        variableMap["timeoutMs"].as<std::size_t>(),
+        maxTimeouts),
+      failure));
+    loop.run();
+    if (failure) { std::rethrow_exception(failure); }
+    return 0;
+#else
+    spdlog::error("The async option requires Linux.");
+    return 1;
+#endif
+  }
+
+  if (variableMap["pipelined"].as<bool>()) {
+    streamPipelined(
+      connection, consumerName, sendImageEncoding, variableMap["pipelineQueueSize"].as<std::size_t>(), maxTimeouts);
+    return 0;
+  }
+
+  // Received messages are decoded into the same item, so that its nodes are reused.
+  dataspree::inference::core::Item message{};
 
   while (true) {
 
     bool visualized = false;
     std::size_t messageCount = 0;
-    cv::Mat displayImage;
+    auto displayImage = dataspree::inference::FrameBufferPool::instance().mat();
+
+    std::size_t timeouts{ 0 };
 
     for (; ; ++messageCount) {
 
       // receive Item if the user configured a producer from which they want to receive data.
       if (connection.isReceiveConfigured()) {
-        auto optionalItem = connection.receiveItem();
-        if (!optionalItem.has_value()) { break; }
-
-        auto &message = optionalItem.value();
+        // Keep waiting while the producer is idle; reconnect once the connection is closed (f.i., server restart) or
+        // stayed silent for maxTimeouts timeouts in a row (a vanished peer does not close the connection).
+        if (auto const status = connection.receiveItemInto(message);
+            status == dataspree::inference::ReceiveStatus::TIMEOUT) {
+          if (maxTimeouts == 0 || ++timeouts < maxTimeouts) { continue; }
+          spdlog::warn("No message received within {} timeouts.", maxTimeouts);
+          break;
+        } else if (status != dataspree::inference::ReceiveStatus::OK) {
+          break;
+        }
+        timeouts = 0;
 
         // Error message ->
         if (auto const *error = message.template find_at<std::string>("error"); error) {
           throw std::runtime_error(error->c_str());
         }
 
-        auto &item = message.at("item");
-
         // Visualize image and inference results.
-        if (auto const *image = item.find_at<cv::Mat>("image"); image) {
-          displayImage = image->clone();
-
-          if (auto const *detections = item.find_at("inference", "detection"); detections) {
-            for (auto const &det : *detections) {
-              auto const centerX = static_cast<int>(std::max(det.template at<double>("x") * image->cols, 0.0));
-              auto const centerY = static_cast<int>(std::max(det.template at<double>("y") * image->rows, 0.0));
-              auto const width = static_cast<int>(std::max(det.template at<double>("width") * image->cols, 0.0));
-              auto const height = static_cast<int>(std::max(det.template at<double>("height") * image->rows, 0.0));
-              // auto const confidence = det.template at<double>("confidence");
-
-              auto const orientation =
-                static_cast<float>(-(det.template at<double>("orientation")) / std::numbers::pi * 180);
-
-              auto const rect = cv::RotatedRect(cv::Point2f(static_cast<float>(centerX), static_cast<float>(centerY)),
-                                                cv::Size2f(static_cast<float>(width), static_cast<float>(height)),
-                                                orientation);
-              std::array<cv::Point2f, 4> vertices;
-              rect.points(vertices.data());
-#pragma unroll
-              for (std::size_t i = 0; i < 4; ++i) {
-                // NOLINTNEXTLINE(cppcoreguidelines-pro-bounds-constant-array-index)
-                line(displayImage, vertices[i], vertices[(i + 1) % 4], cv::Scalar(0, 255, 0), 2);
-              }
-            }
-          }
-          visualized = true;
-          cv::imshow("visualization", displayImage);
-          cv::waitKey(1);
-        }
+        visualized = visualize(message.at("item"), displayImage) || visualized;
       }
 
 
       // send out the item that was just received to a new producer.
       if (!consumerName.empty() ) {
 
-        // Read image from camera 0 if no image received.
-        if (displayImage.empty()) {
-          auto cam = cv::VideoCapture(0);
-          cam.read(displayImage);
-          cam.release();
-        }
-
-        dataspree::inference::core::Item item{};
-        item["image"] = displayImage;
-        item["id"] = messageCount;
-        if (!connection.sendItem(item, consumerName)) {
+        if (!connection.sendItem(makeSendItem(displayImage, messageCount, sendImageEncoding), consumerName)) {
           break;
         }
       }
@@ -0,0 +1,29 @@
+#ifndef DATASPREE_INFERENCE_CORE_DETECTION_HPP
+#define DATASPREE_INFERENCE_CORE_DETECTION_HPP
+
+#include <string>
+
+namespace dataspree::inference::core {
+
+/// Object detection in the standard inference schema; positions and sizes are relative to the image size.
+// NOLINTNEXTLINE(altera-struct-pack-align)
+struct Detection {
+
+  /// Center of the (rotated) bounding box.
+  float x{ 0.0F };
+  float y{ 0.0F };
+
+  float width{ 0.0F };
+  float height{ 0.0F };
+
+  /// Counter-clockwise rotation in radians.
+  float orientation{ 0.0F };
+
+  float confidence{ 0.0F };
+
+  std::string label{};
+};
+
+}// namespace dataspree::inference::core
+
+#endif// DATASPREE_INFERENCE_CORE_DETECTION_HPP
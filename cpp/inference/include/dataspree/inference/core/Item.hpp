@@ -1,7 +1,10 @@
 #ifndef DATASPREE_INFERENCE_CORE_ITEM_HPP
 #define DATASPREE_INFERENCE_CORE_ITEM_HPP
 
+#include <dataspree/inference/core/Detection.hpp>
 #include <dataspree/inference/core/Exception.hpp>
+#include <dataspree/inference/core/LazyMat.hpp>
+#include <dataspree/inference/core/PointCloud.hpp>
 #include <dataspree/inference/core/Utils.hpp>
 #include <dataspree/inference/core/Type.hpp>
 
@@ -26,17 +29,17 @@ namespace dataspree::inference::core {
 
 struct Item final {
 
-  [[nodiscard]] inline Item() noexcept : content(std::map<std::string, Item>{}), contentType(ItemType::OBJECT) {}
+  [[nodiscard]] inline Item() noexcept : content(ItemMap{}), contentType(ItemType::OBJECT) {}
 
   template<typename T>
   [[nodiscard]] explicit inline Item(T content) noexcept : content(content), contentType(deriveItemType<T>()) {}
 
-  [[nodiscard]] explicit inline Item(std::map<std::string, Item> &&map) noexcept
-    : content(std::forward<std::map<std::string, Item>>(map)), contentType(ItemType::OBJECT) {}
+  [[nodiscard]] explicit inline Item(ItemMap &&map) noexcept
+    : content(std::forward<ItemMap>(map)), contentType(ItemType::OBJECT) {}
 
   template<typename T>
   [[nodiscard]] explicit inline Item(std::map<std::string, T> map) noexcept : contentType(ItemType::OBJECT) {
-    auto item_map = std::map<std::string, Item>{};
+    auto item_map = ItemMap{};
 
 #pragma unroll 10
     for (auto &&[key, value] : map) { item_map[key] = Item(value); }
@@ -52,6 +55,10 @@ struct Item final {
       this->content = std::forward<std::vector<unsigned char>>(vec);
       this->contentType = ItemType::BYTE_ARRAY;
 
+    } else if constexpr (std::is_same_v<std::decay_t<T>, Detection>) {
+      this->content = std::forward<std::vector<Detection>>(vec);
+      this->contentType = ItemType::DETECTIONS;
+
     } else {
       auto out_vec = std::vector<Item>{};
       // std::copy(vec.begin(), vec.end(), std::back_inserter(out_vec)); <- not possible
@@ -69,6 +76,10 @@ struct Item final {
       this->content = std::forward<std::vector<unsigned char>>(vec);
       this->contentType = ItemType::BYTE_ARRAY;
 
+    } else if constexpr (std::is_same_v<std::decay_t<T>, Detection>) {
+      this->content = vec;
+      this->contentType = ItemType::DETECTIONS;
+
     } else {
       auto out_vec = std::vector<Item>{};
 #pragma unroll 10
@@ -162,15 +173,13 @@ struct Item final {
     this->template _value<std::vector<Item>>()->emplace_back(std::forward<Ts>(args)...);
   }
 
-  [[nodiscard]] auto items() const -> std::map<std::string, Item> const & {
-    return this->at<std::map<std::string, Item>>();
-  }
+  [[nodiscard]] auto items() const -> ItemMap const & { return this->at<ItemMap>(); }
 
-  [[nodiscard]] auto items() -> std::map<std::string, Item> & { return this->at<std::map<std::string, Item>>(); }
+  [[nodiscard]] auto items() -> ItemMap & { return this->at<ItemMap>(); }
 
   [[nodiscard]] auto contains(auto &&val) const noexcept -> bool { return this->items().contains(val); }
 
-  template<typename T> [[nodiscard]] inline auto erase(T &&val) { this->at<std::map<std::string, Item>>().erase(val); }
+  template<typename T> [[nodiscard]] inline auto erase(T &&val) { this->at<ItemMap>().erase(val); }
 
   /// Return the stored content type.
   [[nodiscard]] auto getType() const noexcept { return this->contentType; }
@@ -297,6 +306,9 @@ private:
     if (auto *result = try_any_cast<std::decay_t<T>, true>(this->content); result) {
       return result;
 
+    } else if (auto *lazyResult = _lazyValue<T, no_except>(); lazyResult) {
+      return lazyResult;
+
     } else {
       if constexpr (!no_except) {
         // bug in clang-tidy
@@ -313,6 +325,9 @@ private:
     if (auto *result = try_any_cast<std::decay_t<T>, true, true>(this->content); result) {
       return result;
 
+    } else if (auto *lazyResult = _lazyValue<T, no_except>(); lazyResult) {
+      return lazyResult;
+
     } else {
       if constexpr (!no_except) {
         // bug in clang-tidy
@@ -325,12 +340,29 @@ private:
     }
   }
 
+  /// Resolve cv::Mat queries on lazily decoded images; triggers decoding on first access.
+  template<typename T, bool no_except = false>
+  [[nodiscard]] inline auto _lazyValue() const noexcept(no_except) -> std::decay_t<T> * {
+    if constexpr (std::is_same_v<std::decay_t<T>, cv::Mat>) {
+      if (auto *lazy = try_any_cast<LazyMat, true>(this->content); lazy) {
+        if constexpr (no_except) {
+          try {
+            return &lazy->get();
+          } catch (std::exception const &) { return nullptr; }
+        } else {
+          return &lazy->get();
+        }
+      }
+    }
+    return nullptr;
+  }
+
   template<typename T = Item, bool no_except = false>
   [[nodiscard]] inline auto _value(std::string &&name) const noexcept(no_except) -> std::decay_t<T> const * {
 
     try {
       try {
-        auto parent = this->template _value<std::map<std::string, Item>, no_except>();
+        auto parent = this->template _value<ItemMap, no_except>();
         if constexpr (no_except) {
           if (!parent || !parent->contains(name)) { return nullptr; }
         }
@@ -366,7 +398,7 @@ private:
   template<typename T = Item, bool no_except = false>
   [[nodiscard]] inline auto _value(std::string &&name) noexcept(no_except) -> std::decay_t<T> * {
     try {
-      auto parent = this->template _value<std::map<std::string, Item>, no_except>();
+      auto parent = this->template _value<ItemMap, no_except>();
       if constexpr (no_except) {
         if (!parent || !parent->contains(name)) { return nullptr; }
       }
@@ -507,7 +539,7 @@ private:
   [[nodiscard]] inline auto _value(std::string &&first, Ts... second) const noexcept(no_except)
     -> std::decay_t<T> const * {
     try {
-      auto const parent = this->template _value<std::map<std::string, Item>, no_except>();
+      auto const parent = this->template _value<ItemMap, no_except>();
 
       if constexpr (no_except) {
         if (!parent || !parent->contains(first)) { return nullptr; }
@@ -531,7 +563,7 @@ private:
   template<typename T = Item, bool no_except = false, typename... Ts, typename = std::enable_if_t<sizeof...(Ts) >= 1>>
   [[nodiscard]] inline auto _value(std::string &&first, Ts... second) noexcept(no_except) -> std::decay_t<T> * {
     try {
-      auto const parent = this->template _value<std::map<std::string, Item>, no_except>();
+      auto const parent = this->template _value<ItemMap, no_except>();
 
       if constexpr (no_except) {
         if (!parent || !parent->contains(first)) { return nullptr; }
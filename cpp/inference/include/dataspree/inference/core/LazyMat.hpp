@@ -0,0 +1,80 @@
+#ifndef DATASPREE_INFERENCE_CORE_LAZY_MAT_HPP
+#define DATASPREE_INFERENCE_CORE_LAZY_MAT_HPP
+
+#include <opencv2/core/mat.hpp>
+
+#include <atomic>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <type_traits>
+#include <utility>
+
+namespace dataspree::inference::core {
+
+/// Image that keeps its encoded payload and only decodes it on first access.
+///
+/// Copies share the payload and the decoded image. Decoding happens exactly once, on whichever thread accesses the
+/// image first (or on the worker started by #prefetch).
+// NOLINTNEXTLINE(altera-struct-pack-align)
+struct [[nodiscard]] LazyMat final {
+
+  /// Transforms the encoded payload into an image.
+  using Decoder = std::function<cv::Mat(std::string &)>;
+
+  /// \tparam String Helper template to accept both rvalues and lvalues in a single constructor.
+  /// \param payload Encoded image (f.i., PNG or MAT_RAW bytes).
+  /// \param decoder Function that is invoked once to decode #payload.
+  template<typename String, typename = std::enable_if_t<std::is_constructible_v<std::string, std::decay_t<String>>>>
+  explicit LazyMat(String &&payload, Decoder decoder)
+    : state(std::make_shared<State>(std::forward<String>(payload), std::move(decoder))) {}
+
+  /// Return the decoded image; decodes the payload if this did not happen yet.
+  /// \throws Whatever the decoder throws. In that case, the next access attempts to decode again.
+  [[nodiscard]] inline auto get() const -> cv::Mat & {
+    decode(*this->state);
+    return this->state->mat;
+  }
+
+  /// Start decoding on a worker thread.
+  /// \return future that becomes ready as soon as the decoded image is available.
+  [[nodiscard]] inline auto prefetch() const -> std::future<void> {
+    return std::async(std::launch::async, [state = this->state]() { decode(*state); });
+  }
+
+  /// \return true if the payload has already been decoded.
+  [[nodiscard]] inline auto isDecoded() const noexcept -> bool {
+    return this->state->decoded.load(std::memory_order_acquire);
+  }
+
+private:
+  // NOLINTNEXTLINE(altera-struct-pack-align)
+  struct State {
+    inline State(std::string payload, Decoder &&decoder) : payload(std::move(payload)), decoder(std::move(decoder)) {}
+
+    std::string payload;
+    Decoder decoder;
+    cv::Mat mat{};
+    std::once_flag once{};
+    std::atomic<bool> decoded{ false };
+  };
+
+  static inline auto decode(State &state) -> void {
+    std::call_once(state.once, [&state]() {
+      state.mat = state.decoder(state.payload);
+
+      // The encoded representation is not required anymore.
+      state.payload = std::string{};
+      state.decoder = nullptr;
+      state.decoded.store(true, std::memory_order_release);
+    });
+  }
+
+  std::shared_ptr<State> state;
+};
+
+}// namespace dataspree::inference::core
+
+#endif// DATASPREE_INFERENCE_CORE_LAZY_MAT_HPP
@@ -0,0 +1,76 @@
+#ifndef DATASPREE_INFERENCE_CORE_PATH_QUERY_HPP
+#define DATASPREE_INFERENCE_CORE_PATH_QUERY_HPP
+
+#include <dataspree/inference/core/Item.hpp>
+
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <span>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace dataspree::inference::core {
+
+/// Compiled path query over Item trees.
+///
+/// A query consists of steps, each of which is an object key, an array index, "*" (any key or array element) or "**"
+/// (any number of levels, including none). F.i., {"inference", "detection", "*", "confidence"} selects the confidence
+/// of all detections and {"**", "rois"} all ROI lists, wherever they are in the tree. Compile a query once and
+/// execute it on every received item; matches are pointers into the queried tree, each reported once.
+///
+/// Queries descend into objects and arrays only. Typed nodes are leaves: the detections of a message decoded with
+/// ReceiveProperties::typedDetections form a single DETECTIONS node, which {"inference", "detection"} selects, while
+/// {"inference", "detection", "*", "confidence"} matches nothing; read the fields from the std::vector<Detection>.
+// NOLINTNEXTLINE(altera-struct-pack-align)
+struct [[nodiscard]] PathQuery final {
+
+  /// Compile a query from its steps (the syntax of ReceiveProperties::excludedPaths plus indices and "**").
+  explicit PathQuery(std::vector<std::string> const &path);
+
+  /// Compile a query from a string such as "inference.detection.*.confidence".
+  /// \param separator separates the steps of the query.
+  [[nodiscard]] static auto parse(std::string_view query, char separator = '.') -> PathQuery;
+
+  /// Find all nodes of #root that match the query in depth-first order.
+  /// \param matches buffer for the matches; cleared first and reused across calls to avoid allocations.
+  /// \return the matches; valid until #matches or the tree are modified.
+  auto execute(Item const &root, std::vector<Item const *> &matches) const -> std::span<Item const *const>;
+
+  auto execute(Item &root, std::vector<Item *> &matches) const -> std::span<Item *const>;
+
+  /// \return the first match in depth-first order or nullptr.
+  [[nodiscard]] auto first(Item const &root) const -> Item const *;
+
+  [[nodiscard]] auto first(Item &root) const -> Item *;
+
+  /// \return the number of steps after merging consecutive "**".
+  [[nodiscard]] inline auto size() const noexcept -> std::size_t { return steps.size(); }
+
+private:
+  enum class Kind : uint8_t { KEY = 0, ANY = 1, DESCENDANTS = 2 };
+
+  // NOLINTNEXTLINE(altera-struct-pack-align)
+  struct Step {
+    Kind kind;
+
+    /// Object key; also used as array index if it is a number (#index).
+    std::string key;
+    std::optional<std::size_t> index;
+  };
+
+  template<typename Node, typename Visitor>
+  auto match(Node &node, std::size_t step, Visitor &&visitor) const -> bool;
+
+  template<typename Node> auto collect(Node &root, std::vector<Node *> &matches) const -> std::span<Node *const>;
+
+  std::vector<Step> steps{};
+
+  /// Queries with several "**" reach nodes on several paths (f.i., {"**", "x", "**"} reaches x.x below both x).
+  bool repeatsMatches{ false };
+};
+
+}// namespace dataspree::inference::core
+
+#endif// DATASPREE_INFERENCE_CORE_PATH_QUERY_HPP
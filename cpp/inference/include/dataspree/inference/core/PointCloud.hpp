@@ -0,0 +1,111 @@
+#ifndef DATASPREE_INFERENCE_CORE_POINT_CLOUD_HPP
+#define DATASPREE_INFERENCE_CORE_POINT_CLOUD_HPP
+
+#include <opencv2/core/mat.hpp>
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <span>
+
+namespace dataspree::inference::core {
+
+/// Point cloud in structure-of-arrays layout.
+///
+/// Each field (x, y, z and optionally intensity and r, g, b) is a contiguous float array that starts at a 64 byte
+/// boundary, so that loops over a field vectorize. Like cv::Mat, copies share the points; use #clone for a deep copy.
+// NOLINTNEXTLINE(altera-struct-pack-align)
+struct [[nodiscard]] PointCloud final {
+
+  enum class Field : uint8_t { X = 0, Y = 1, Z = 2, INTENSITY = 3, R = 4, G = 5, B = 6 };
+
+  PointCloud() = default;
+
+  /// Allocate (uninitialized) fields for #size points.
+  /// \param intensity allocate the intensity field.
+  /// \param color allocate the r, g and b fields (0 - 255).
+  inline PointCloud(std::size_t size, bool intensity, bool color)
+    : numberOfPoints(size), stride(alignedStride(size)), intensity(intensity), color(color),
+      points(static_cast<float *>(cv::fastMalloc(std::max<std::size_t>(stride * numberOfFields(), 1) * sizeof(float))),
+        cv::fastFree) {}
+
+  [[nodiscard]] inline auto size() const noexcept -> std::size_t { return numberOfPoints; }
+
+  [[nodiscard]] inline auto empty() const noexcept -> bool { return numberOfPoints == 0; }
+
+  [[nodiscard]] inline auto hasIntensity() const noexcept -> bool { return intensity; }
+
+  [[nodiscard]] inline auto hasColor() const noexcept -> bool { return color; }
+
+  /// \return true if #field is allocated.
+  [[nodiscard]] inline auto has(Field field) const noexcept -> bool {
+    switch (field) {
+    case Field::INTENSITY:
+      return intensity;
+    case Field::R:
+      [[fallthrough]];
+    case Field::G:
+      [[fallthrough]];
+    case Field::B:
+      return color;
+    default:
+      return true;
+    }
+  }
+
+  /// \return the values of #field for all points; empty if the field is not allocated.
+  [[nodiscard]] inline auto field(Field field) noexcept -> std::span<float> {
+    if (!has(field) || !points) { return {}; }
+    return { points.get() + stride * plane(field), numberOfPoints };
+  }
+
+  [[nodiscard]] inline auto field(Field field) const noexcept -> std::span<float const> {
+    if (!has(field) || !points) { return {}; }
+    return { points.get() + stride * plane(field), numberOfPoints };
+  }
+
+  [[nodiscard]] inline auto x() noexcept -> std::span<float> { return field(Field::X); }
+  [[nodiscard]] inline auto y() noexcept -> std::span<float> { return field(Field::Y); }
+  [[nodiscard]] inline auto z() noexcept -> std::span<float> { return field(Field::Z); }
+  [[nodiscard]] inline auto x() const noexcept -> std::span<float const> { return field(Field::X); }
+  [[nodiscard]] inline auto y() const noexcept -> std::span<float const> { return field(Field::Y); }
+  [[nodiscard]] inline auto z() const noexcept -> std::span<float const> { return field(Field::Z); }
+
+  /// \return number of allocated fields (3, 4, 6 or 7).
+  [[nodiscard]] inline auto numberOfFields() const noexcept -> std::size_t {
+    return std::size_t{ 3 } + (intensity ? 1U : 0U) + (color ? 3U : 0U);
+  }
+
+  [[nodiscard]] inline auto clone() const -> PointCloud {
+    PointCloud copy(numberOfPoints, intensity, color);
+    if (points) { std::memcpy(copy.points.get(), points.get(), stride * numberOfFields() * sizeof(float)); }
+    return copy;
+  }
+
+private:
+  /// Number of floats per field, such that each field starts at a 64 byte boundary.
+  static constexpr auto alignedStride(std::size_t size) noexcept -> std::size_t {
+    constexpr std::size_t floatsPerCacheLine = 64 / sizeof(float);
+    return (size + floatsPerCacheLine - 1) / floatsPerCacheLine * floatsPerCacheLine;
+  }
+
+  /// Index of the plane that stores #field; planes of fields that are not allocated are skipped.
+  [[nodiscard]] inline auto plane(Field field) const noexcept -> std::size_t {
+    auto const index = static_cast<std::size_t>(field);
+    if (field == Field::INTENSITY || index < 3) { return index; }
+    return intensity ? index : index - 1;
+  }
+
+  std::size_t numberOfPoints{ 0 };
+  std::size_t stride{ 0 };
+  bool intensity{ false };
+  bool color{ false };
+
+  std::shared_ptr<float> points{};
+};
+
+}// namespace dataspree::inference::core
+
+#endif// DATASPREE_INFERENCE_CORE_POINT_CLOUD_HPP
@@ -4,6 +4,7 @@
 #include <opencv2/core/mat.hpp>
 
 #include <cstdint>
+#include <functional>
 #include <limits>
 #include <map>
 #include <string>
@@ -15,6 +16,15 @@ namespace dataspree::inference::core {
 
 struct Item;
 
+/// Children of an object item; the keys are compared transparently, so that they are found by std::string_view.
+using ItemMap = std::map<std::string, Item, std::less<>>;
+
+struct LazyMat;
+
+struct PointCloud;
+
+struct Detection;
+
 
 enum class ItemType : uint8_t {
   /// Map [str -> Object]
@@ -52,13 +62,19 @@ enum class ItemType : uint8_t {
   /// cv::Mat
   MAT = 16,
   BYTE_ARRAY = 17,
+  /// cv::Mat that is decoded on first access (LazyMat)
+  LAZY_MAT = 18,
+  /// Point cloud in structure-of-arrays layout (PointCloud)
+  POINT_CLOUD = 19,
+  /// Detections decoded into a contiguous array (std::vector<Detection>)
+  DETECTIONS = 20,
 
   OTHER = std::numeric_limits<uint8_t>::max(),
 };
 
 template <typename T> static consteval auto deriveItemType() noexcept -> ItemType {
   using DT = std::decay_t<T>;
-  if constexpr (std::is_same_v<DT, std::map<std::string, Item>>) {
+  if constexpr (std::is_same_v<DT, ItemMap>) {
     return ItemType::OBJECT;
   }
   if constexpr (std::is_same_v<DT, std::vector<Item>>) {
@@ -112,6 +128,15 @@ template <typename T> static consteval auto deriveItemType() noexcept -> ItemTyp
   if constexpr (std::is_same_v<DT, std::vector<unsigned char>>) {
     return ItemType::BYTE_ARRAY;
   }
+  if constexpr (std::is_same_v<DT, LazyMat>) {
+    return ItemType::LAZY_MAT;
+  }
+  if constexpr (std::is_same_v<DT, PointCloud>) {
+    return ItemType::POINT_CLOUD;
+  }
+  if constexpr (std::is_same_v<DT, std::vector<Detection>>) {
+    return ItemType::DETECTIONS;
+  }
 
   if constexpr (std::is_same_v<DT, char const *>) {
     return ItemType::NULL_TERMINATED_STRING;
@@ -0,0 +1,141 @@
+#include <dataspree/inference/core/PathQuery.hpp>
+
+#include <algorithm>
+#include <charconv>
+#include <unordered_set>
+
+dataspree::inference::core::PathQuery::PathQuery(std::vector<std::string> const &path) {
+  steps.reserve(path.size());
+
+  // NOLINTNEXTLINE(altera-unroll-loops)
+  for (auto const &key : path) {
+    if (key == "**") {
+      // Consecutive "**" match the same nodes as a single one (but would report them repeatedly).
+      if (steps.empty() || steps.back().kind != Kind::DESCENDANTS) {
+        repeatsMatches = repeatsMatches || std::ranges::any_of(steps, [](auto const &previous) {
+          return previous.kind == Kind::DESCENDANTS;
+        });
+        steps.push_back({ Kind::DESCENDANTS, key, {} });
+      }
+
+    } else if (key == "*") {
+      steps.push_back({ Kind::ANY, key, {} });
+
+    } else {
+      std::size_t index{ 0 };
+      auto const *const end = key.data() + key.size();
+      auto const [ptr, error] = std::from_chars(key.data(), end, index);
+      auto const isIndex = !key.empty() && error == std::errc{} && ptr == end;
+      steps.push_back({ Kind::KEY, key, isIndex ? std::optional(index) : std::nullopt });
+    }
+  }
+}
+
+auto dataspree::inference::core::PathQuery::parse(std::string_view query, char separator) -> PathQuery {
+  std::vector<std::string> path{};
+
+  // NOLINTNEXTLINE(altera-unroll-loops)
+  while (!query.empty()) {
+    auto const end = query.find(separator);
+    path.emplace_back(query.substr(0, end));
+    query = end == std::string_view::npos ? std::string_view{} : query.substr(end + 1);
+  }
+  return PathQuery(path);
+}
+
+/// Visit the nodes below #node that match the steps starting at #step.
+/// \param visitor is called with each match; returns false to stop the search.
+/// \return false if the search was stopped.
+template<typename Node, typename Visitor>
+// NOLINTNEXTLINE(misc-no-recursion)
+auto dataspree::inference::core::PathQuery::match(Node &node, std::size_t step, Visitor &&visitor) const -> bool {
+  if (step == steps.size()) { return visitor(&node); }
+
+  auto *const map = node.getType() == ItemType::OBJECT ? node.template find_at<ItemMap>() : nullptr;
+  auto *const vector = node.getType() == ItemType::ARRAY ? node.template find_at<std::vector<Item>>() : nullptr;
+
+  // Visit all children with the steps starting at #next.
+  auto const children = [&](std::size_t next) {
+    // NOLINTBEGIN(altera-unroll-loops)
+    if (map != nullptr) {
+      for (auto &child : *map) {
+        if (!match(child.second, next, visitor)) { return false; }
+      }
+    } else if (vector != nullptr) {
+      for (auto &child : *vector) {
+        if (!match(child, next, visitor)) { return false; }
+      }
+    }
+    // NOLINTEND(altera-unroll-loops)
+    return true;
+  };
+
+  auto const &current = steps[step];
+  switch (current.kind) {
+  case Kind::KEY:
+    if (map != nullptr) {
+      auto const child = map->find(current.key);
+      return child == map->end() || match(child->second, step + 1, visitor);
+    }
+    if (vector != nullptr && current.index.has_value() && current.index.value() < vector->size()) {
+      return match((*vector)[current.index.value()], step + 1, visitor);
+    }
+    return true;
+
+  case Kind::ANY:
+    return children(step + 1);
+
+  case Kind::DESCENDANTS:
+    // Either no further level or (at least) one more.
+    return match(node, step + 1, visitor) && children(step);
+
+  default:
+    return true;
+  }
+}
+
+template<typename Node>
+auto dataspree::inference::core::PathQuery::collect(Node &root, std::vector<Node *> &matches) const
+  -> std::span<Node *const> {
+  matches.clear();
+  (void)match(root, 0, [&matches](Node *node) {
+    matches.push_back(node);
+    return true;
+  });
+
+  if (repeatsMatches) {
+    // Keep the first occurrence of each node, which preserves the depth-first order.
+    std::unordered_set<Node const *> reported{};
+    reported.reserve(matches.size());
+    std::erase_if(matches, [&reported](Node *node) { return !reported.insert(node).second; });
+  }
+  return matches;
+}
+
+auto dataspree::inference::core::PathQuery::execute(Item const &root, std::vector<Item const *> &matches) const
+  -> std::span<Item const *const> {
+  return collect(root, matches);
+}
+
+auto dataspree::inference::core::PathQuery::execute(Item &root, std::vector<Item *> &matches) const
+  -> std::span<Item *const> {
+  return collect(root, matches);
+}
+
+auto dataspree::inference::core::PathQuery::first(Item const &root) const -> Item const * {
+  Item const *result{ nullptr };
+  (void)match(root, 0, [&result](Item const *node) {
+    result = node;
+    return false;
+  });
+  return result;
+}
+
+auto dataspree::inference::core::PathQuery::first(Item &root) const -> Item * {
+  Item *result{ nullptr };
+  (void)match(root, 0, [&result](Item *node) {
+    result = node;
+    return false;
+  });
+  return result;
+}
@@ -0,0 +1,296 @@
+#include <Conversion.hpp>
+
+#include <catch2/catch.hpp>
+#include <msgpack.hpp>
+#include <nlohmann/json.hpp>
+#include <opencv2/core/mat.hpp>
+
+#include <atomic>
+#include <cstdlib>
+#include <cstring>
+#include <new>
+#include <span>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace {
+
+/// Number of calls of the global operator new (replaced below).
+std::atomic<std::size_t> numberOfAllocations{ 0 };
+
+/// \return number of calls of operator new by #function.
+template<typename Function> auto countAllocations(Function &&function) -> std::size_t {
+  auto const before = numberOfAllocations.load();
+  function();
+  return numberOfAllocations.load() - before;
+}
+
+/// Message with keys that do not fit into the small string buffer of std::string.
+auto longKeyMessage(dataspree::inference::EncodingMode encodingMode) -> std::string {
+  dataspree::inference::core::Item item{};
+  item["a_key_that_does_not_fit_into_the_small_string_buffer"] = 42;
+  item["another_key_that_is_too_long_for_a_small_string"]["a_nested_key_that_is_too_long_as_well"] =
+    std::string(64, 'x');
+  item["a_list_of_values_with_a_long_key_as_well"] = std::vector<dataspree::inference::core::Item>{
+    dataspree::inference::core::Item(1.5), dataspree::inference::core::Item(std::string(32, 'y'))
+  };
+
+  std::string message{};
+  // NOLINTNEXTLINE(altera-unroll-loops)
+  for (auto const &segment : dataspree::inference::encodeMessage(item, encodingMode).segments) {
+    message.append(segment.data(), segment.size());
+  }
+  return message;
+}
+
+/// \return encoded message with a detection for each of #labels.
+auto detectionMessage(std::vector<dataspree::inference::core::Item> const &labels,
+  dataspree::inference::EncodingMode encodingMode) -> std::string {
+  std::vector<dataspree::inference::core::Item> detections{};
+  // NOLINTNEXTLINE(altera-unroll-loops)
+  for (auto const &label : labels) {
+    dataspree::inference::core::Item detection{};
+    detection["x"] = 0.5;
+    detection["y"] = 0.5;
+    detection["width"] = 0.25;
+    detection["height"] = 0.25;
+    detection["label"] = label;
+    detections.push_back(detection);
+  }
+
+  dataspree::inference::core::Item item{};
+  item["item"]["inference"]["detection"] = std::move(detections);
+
+  std::string message{};
+  // NOLINTNEXTLINE(altera-unroll-loops)
+  for (auto const &segment : dataspree::inference::encodeMessage(item, encodingMode).segments) {
+    message.append(segment.data(), segment.size());
+  }
+  return message;
+}
+
+/// \return #item encoded as a single message, with images encoded as MAT_RAW.
+auto encodedMessage(dataspree::inference::core::Item const &item, dataspree::inference::EncodingMode encodingMode)
+  -> std::string {
+  std::string message{};
+  // NOLINTNEXTLINE(altera-unroll-loops)
+  for (auto const &segment : dataspree::inference::encodeMessage(item, encodingMode, "MAT_RAW").segments) {
+    message.append(segment.data(), segment.size());
+  }
+  return message;
+}
+
+/// \return message with detections of the given confidences, masks and a camera id.
+auto confidenceMessage(std::vector<double> const &confidences, dataspree::inference::EncodingMode encodingMode)
+  -> std::string {
+  std::vector<dataspree::inference::core::Item> detections{};
+  // NOLINTNEXTLINE(altera-unroll-loops)
+  for (auto const confidence : confidences) {
+    dataspree::inference::core::Item detection{};
+    detection["x"] = 0.5;
+    detection["confidence"] = confidence;
+    detections.push_back(detection);
+  }
+
+  dataspree::inference::core::Item item{};
+  item["item"]["inference"]["detection"] = std::move(detections);
+  item["item"]["inference"]["masks"] = std::string(256, 'm');
+  item["item"]["camera"]["id"] = 3;
+  return encodedMessage(item, encodingMode);
+}
+
+}// namespace
+
+// NOLINTBEGIN(cppcoreguidelines-no-malloc,cppcoreguidelines-owning-memory)
+#if defined(__GNUC__) && !defined(__clang__)
+// The replacement functions are a matching pair of malloc and free.
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wmismatched-new-delete"
+#endif
+static auto allocate(std::size_t size) noexcept -> void * {
+  numberOfAllocations.fetch_add(1, std::memory_order_relaxed);
+  return std::malloc(size == 0 ? 1 : size);
+}
+
+auto operator new(std::size_t size) -> void * {
+  if (auto *const memory = allocate(size); memory != nullptr) { return memory; }
+  throw std::bad_alloc();
+}
+
+auto operator new[](std::size_t size) -> void * { return operator new(size); }
+
+auto operator new(std::size_t size, std::nothrow_t const & /*tag*/) noexcept -> void * { return allocate(size); }
+
+auto operator new[](std::size_t size, std::nothrow_t const & /*tag*/) noexcept -> void * { return allocate(size); }
+
+auto operator delete(void *memory) noexcept -> void { std::free(memory); }
+
+auto operator delete[](void *memory) noexcept -> void { std::free(memory); }
+
+auto operator delete(void *memory, std::size_t /*size*/) noexcept -> void { std::free(memory); }
+
+auto operator delete[](void *memory, std::size_t /*size*/) noexcept -> void { std::free(memory); }
+
+auto operator delete(void *memory, std::nothrow_t const & /*tag*/) noexcept -> void { std::free(memory); }
+
+auto operator delete[](void *memory, std::nothrow_t const & /*tag*/) noexcept -> void { std::free(memory); }
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC diagnostic pop
+#endif
+// NOLINTEND(cppcoreguidelines-no-malloc,cppcoreguidelines-owning-memory)
+
+TEST_CASE("Decoding into the previous item does not allocate in the steady state", "[conversion]") {
+  auto const encodingMode =
+    GENERATE(dataspree::inference::EncodingMode::JSON, dataspree::inference::EncodingMode::MSGPACK);
+  auto const message = longKeyMessage(encodingMode);
+
+  // Parses the message like decodeInto; its allocations are not part of the item tree.
+  auto const parse = [&message, encodingMode]() {
+    if (encodingMode == dataspree::inference::EncodingMode::MSGPACK) {
+      msgpack::unpacked handle{};
+      msgpack::unpack(handle, message.data(), message.size(), nullptr);
+    } else {
+      auto const source = std::span(message.data(), message.size());
+      [[maybe_unused]] auto const root = nlohmann::json::parse(source.begin(), source.end());
+    }
+  };
+
+  dataspree::inference::core::Item item{};
+  auto const decode = [&item, &message, encodingMode]() {
+    dataspree::inference::decodeInto(item, message.data(), message.size(), encodingMode);
+  };
+
+  // The first message builds the item tree.
+  decode();
+  REQUIRE(item.at<std::string>("another_key_that_is_too_long_for_a_small_string",
+            "a_nested_key_that_is_too_long_as_well")
+          == std::string(64, 'x'));
+
+  static constexpr std::size_t repetitions{ 16 };
+  std::size_t parsing{ 0 };
+  std::size_t decoding{ 0 };
+  // NOLINTNEXTLINE(altera-unroll-loops)
+  for (std::size_t index = 0; index < repetitions; ++index) {
+    parsing += countAllocations(parse);
+    decoding += countAllocations(decode);
+  }
+
+  CHECK(decoding == parsing);
+  CHECK(item.at<std::string>("a_list_of_values_with_a_long_key_as_well", 1U) == std::string(32, 'y'));
+}
+
+TEST_CASE("Detection labels are decoded alike in both encodings", "[conversion]") {
+  auto const encodingMode =
+    GENERATE(dataspree::inference::EncodingMode::JSON, dataspree::inference::EncodingMode::MSGPACK);
+  auto const message = detectionMessage({ dataspree::inference::core::Item(std::string("person")),
+                                          dataspree::inference::core::Item(int64_t{ 7 }),
+                                          dataspree::inference::core::Item(int64_t{ -3 }),
+                                          dataspree::inference::core::Item(2.5),
+                                          dataspree::inference::core::Item(true),
+                                          dataspree::inference::core::Item{} },
+    encodingMode);
+
+  dataspree::inference::DecodeProperties decodeProperties{};
+  decodeProperties.typedDetections = true;
+  auto const item = dataspree::inference::decodeItem(message.data(), message.size(), encodingMode, decodeProperties);
+
+  auto const &detections =
+    item.at<std::vector<dataspree::inference::core::Detection>>("item", "inference", "detection");
+  REQUIRE(detections.size() == 6);
+  CHECK(detections[0].label == "person");
+  CHECK(detections[1].label == "7");
+  CHECK(detections[2].label == "-3");
+  CHECK(detections[3].label == "2.5");
+  CHECK(detections[4].label.empty());
+  CHECK(detections[5].label.empty());
+}
+
+TEST_CASE("Lazily decoded images are decoded on first access", "[conversion]") {
+  auto const encodingMode =
+    GENERATE(dataspree::inference::EncodingMode::JSON, dataspree::inference::EncodingMode::MSGPACK);
+  dataspree::inference::DecodeProperties decodeProperties{};
+  decodeProperties.lazyImageDecoding = true;
+
+  SECTION("valid payload") {
+    cv::Mat image(6, 10, CV_8UC3);
+    // NOLINTNEXTLINE(altera-unroll-loops)
+    for (std::size_t index = 0; index < image.total() * image.elemSize(); ++index) {
+      image.data[index] = static_cast<unsigned char>(index);
+    }
+
+    dataspree::inference::core::Item message{};
+    message["item"]["image"] = image;
+    auto const encoded = encodedMessage(message, encodingMode);
+    auto const item = dataspree::inference::decodeItem(encoded.data(), encoded.size(), encodingMode, decodeProperties);
+
+    auto const &lazy = item.at("item", "image");
+    REQUIRE(lazy.getType() == dataspree::inference::core::ItemType::LAZY_MAT);
+    CHECK(!lazy.at<dataspree::inference::core::LazyMat>().isDecoded());
+
+    auto const &decoded = item.at<cv::Mat>("item", "image");
+    CHECK(lazy.at<dataspree::inference::core::LazyMat>().isDecoded());
+    REQUIRE(decoded.rows == image.rows);
+    REQUIRE(decoded.cols == image.cols);
+    REQUIRE(decoded.type() == image.type());
+    CHECK(std::memcmp(decoded.data, image.data, image.total() * image.elemSize()) == 0);
+  }
+
+  SECTION("invalid payload") {
+    dataspree::inference::core::Item message{};
+    message["item"]["image"] = std::string("bm90IGFuIGltYWdl");
+    message["item"]["encoded_elements"] =
+      std::vector<dataspree::inference::core::Item>{ dataspree::inference::core::Item(
+        std::vector<dataspree::inference::core::Item>{
+          dataspree::inference::core::Item(std::vector<std::string>{ "image" }),
+          dataspree::inference::core::Item(std::string("MAT_RAW")) }) };
+    auto const encoded = encodedMessage(message, encodingMode);
+
+    // Decoding the message succeeds; the image fails on access, on every access.
+    auto const item = dataspree::inference::decodeItem(encoded.data(), encoded.size(), encodingMode, decodeProperties);
+    REQUIRE(item.at("item", "image").getType() == dataspree::inference::core::ItemType::LAZY_MAT);
+    CHECK_THROWS_AS(static_cast<void>(item.at<cv::Mat>("item", "image")), std::runtime_error);
+    CHECK_THROWS_AS(static_cast<void>(item.at<cv::Mat>("item", "image")), std::runtime_error);
+    CHECK(item.find_at<cv::Mat>("item", "image") == nullptr);
+  }
+}
+
+TEST_CASE("The decode filter skips subtrees and drops rejected array elements", "[conversion]") {
+  auto const encodingMode =
+    GENERATE(dataspree::inference::EncodingMode::JSON, dataspree::inference::EncodingMode::MSGPACK);
+  auto const message = confidenceMessage({ 0.25, 0.75, 0.5, 0.125 }, encodingMode);
+  dataspree::inference::DecodeProperties decodeProperties{};
+
+  SECTION("predicates and excluded paths") {
+    decodeProperties.filter.excludedPaths = { { "inference", "masks" } };
+    decodeProperties.filter.predicates = { { .path = { "inference", "detection" },
+      .field = "confidence",
+      .comparison = dataspree::inference::DecodeFilter::Comparison::GREATER_EQUAL,
+      .value = 0.5 } };
+    auto const item = dataspree::inference::decodeItem(message.data(), message.size(), encodingMode, decodeProperties);
+
+    auto const &detections = item.at<std::vector<dataspree::inference::core::Item>>("item", "inference", "detection");
+    REQUIRE(detections.size() == 2);
+    CHECK(detections[0].at<double>("confidence") == 0.75);
+    CHECK(detections[1].at<double>("confidence") == 0.5);
+    CHECK(item.find_at("item", "inference", "masks") == nullptr);
+    CHECK(item.at<int64_t>("item", "camera", "id") == 3);
+  }
+
+  SECTION("included paths") {
+    decodeProperties.filter.includedPaths = { { "inference", "detection" } };
+    auto const item = dataspree::inference::decodeItem(message.data(), message.size(), encodingMode, decodeProperties);
+
+    CHECK(item.at<std::vector<dataspree::inference::core::Item>>("item", "inference", "detection").size() == 4);
+    CHECK(item.find_at("item", "inference", "masks") == nullptr);
+    CHECK(item.find_at("item", "camera") == nullptr);
+  }
+
+  SECTION("wildcards") {
+    decodeProperties.filter.excludedPaths = { { "inference", "detection", "*", "x" } };
+    auto const item = dataspree::inference::decodeItem(message.data(), message.size(), encodingMode, decodeProperties);
+
+    CHECK(item.find_at("item", "inference", "detection", 0U, "x") == nullptr);
+    CHECK(item.at<double>("item", "inference", "detection", 0U, "confidence") == 0.25);
+  }
+}
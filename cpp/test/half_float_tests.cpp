@@ -0,0 +1,235 @@
+#include <Conversion.hpp>
+#include <HalfFloat.hpp>
+
+#include <catch2/catch.hpp>
+#include <opencv2/core/mat.hpp>
+
+#include <bit>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <span>
+#include <string>
+#include <vector>
+
+namespace {
+
+[[nodiscard]] auto isHalfNan(uint16_t value) -> bool { return (value & 0x7c00U) == 0x7c00U && (value & 0x3ffU) != 0; }
+
+/// \return every half precision bit pattern in ascending order.
+[[nodiscard]] auto allHalfs() -> std::vector<uint16_t> {
+  std::vector<uint16_t> halfs(std::size_t{ 1 } << 16U);
+  // NOLINTNEXTLINE(altera-unroll-loops)
+  for (std::size_t index = 0; index < halfs.size(); ++index) { halfs[index] = static_cast<uint16_t>(index); }
+  return halfs;
+}
+
+/// \return little endian double at #offset of #bytes.
+[[nodiscard]] auto readDouble(std::vector<unsigned char> const &bytes, std::size_t offset) -> double {
+  uint64_t bits{ 0 };
+  // NOLINTNEXTLINE(altera-unroll-loops)
+  for (std::size_t index = 0; index < sizeof(double); ++index) {
+    bits |= static_cast<uint64_t>(bytes[offset + index]) << (8U * index);
+  }
+  return std::bit_cast<double>(bits);
+}
+
+/// \return image of #rows x #cols values in [#minimum, #maximum] that does not repeat along a row.
+[[nodiscard]] auto rampImage(int rows, int cols, float minimum, float maximum) -> cv::Mat {
+  cv::Mat image(rows, cols, CV_32FC1);
+  auto const count = static_cast<float>(rows * cols - 1);
+  // NOLINTBEGIN(altera-unroll-loops)
+  for (int row = 0; row < rows; ++row) {
+    for (int col = 0; col < cols; ++col) {
+      auto const position = static_cast<float>(row * cols + col) / count;
+      image.at<float>(row, col) = minimum + (maximum - minimum) * position * position;
+    }
+  }
+  // NOLINTEND(altera-unroll-loops)
+  return image;
+}
+
+/// \return decoded #image after encoding it with #encoding, and the encoded payload.
+[[nodiscard]] auto roundTrip(cv::Mat const &image, std::string const &encoding)
+  -> std::pair<cv::Mat, std::vector<unsigned char>> {
+  auto bytes = dataspree::inference::encodeImage(image, encoding);
+  REQUIRE(!bytes.empty());
+  dataspree::inference::Buffer payload(std::string(bytes.begin(), bytes.end()));
+  auto decoded = dataspree::inference::decodeImage(payload, encoding);
+  REQUIRE(decoded.has_value());
+  REQUIRE(decoded->type() == CV_32FC1);
+  REQUIRE(decoded->rows == image.rows);
+  REQUIRE(decoded->cols == image.cols);
+  return { decoded.value(), std::move(bytes) };
+}
+
+}// namespace
+
+TEST_CASE("Half precision values survive a round trip through single precision", "[half_float]") {
+  std::vector<uint16_t> failures{};
+  // NOLINTNEXTLINE(altera-unroll-loops)
+  for (auto const half : allHalfs()) {
+    auto const value = dataspree::inference::halfToFloat(half);
+    auto const restored = dataspree::inference::floatToHalf(value);
+    if (isHalfNan(half) ? !std::isnan(value) || !isHalfNan(restored) : restored != half) { failures.push_back(half); }
+  }
+  CHECK(failures.empty());
+}
+
+TEST_CASE("Special half precision values are converted exactly", "[half_float]") {
+  using dataspree::inference::floatToHalf;
+  using dataspree::inference::halfToFloat;
+  auto const infinity = std::numeric_limits<float>::infinity();
+
+  SECTION("subnormals") {
+    CHECK(halfToFloat(0x0001U) == std::ldexp(1.0F, -24));
+    CHECK(halfToFloat(0x03ffU) == std::ldexp(1023.0F, -24));
+    CHECK(halfToFloat(0x8001U) == -std::ldexp(1.0F, -24));
+    CHECK(floatToHalf(std::ldexp(1.0F, -24)) == 0x0001U);
+    CHECK(floatToHalf(std::ldexp(1.0F, -14)) == 0x0400U);
+
+    // Half of the smallest subnormal rounds to even (zero), anything above to the smallest subnormal.
+    CHECK(floatToHalf(std::ldexp(1.0F, -25)) == 0x0000U);
+    CHECK(floatToHalf(std::nextafter(std::ldexp(1.0F, -25), 1.0F)) == 0x0001U);
+    CHECK(floatToHalf(std::ldexp(3.0F, -25)) == 0x0002U);
+    CHECK(floatToHalf(std::ldexp(1.0F, -26)) == 0x0000U);
+    CHECK(floatToHalf(-std::ldexp(1.0F, -26)) == 0x8000U);
+  }
+
+  SECTION("zeros and rounding to nearest even") {
+    CHECK(floatToHalf(0.0F) == 0x0000U);
+    CHECK(floatToHalf(-0.0F) == 0x8000U);
+    CHECK(std::signbit(halfToFloat(0x8000U)));
+    CHECK(floatToHalf(1.0F + std::ldexp(1.0F, -11)) == 0x3c00U);
+    CHECK(floatToHalf(1.0F + std::ldexp(3.0F, -11)) == 0x3c02U);
+  }
+
+  SECTION("infinity and overflow") {
+    CHECK(halfToFloat(0x7c00U) == infinity);
+    CHECK(halfToFloat(0xfc00U) == -infinity);
+    CHECK(floatToHalf(infinity) == 0x7c00U);
+    CHECK(floatToHalf(-infinity) == 0xfc00U);
+    CHECK(floatToHalf(65504.0F) == 0x7bffU);
+    CHECK(floatToHalf(65519.0F) == 0x7bffU);
+    CHECK(floatToHalf(65520.0F) == 0x7c00U);
+    CHECK(floatToHalf(-1e10F) == 0xfc00U);
+  }
+
+  SECTION("NaN") {
+    CHECK(std::isnan(halfToFloat(0x7e00U)));
+    CHECK(std::isnan(halfToFloat(0x7c01U)));
+    CHECK(std::isnan(halfToFloat(0xfe00U)));
+    CHECK(isHalfNan(floatToHalf(std::numeric_limits<float>::quiet_NaN())));
+    CHECK(isHalfNan(floatToHalf(std::numeric_limits<float>::signaling_NaN())));
+    CHECK(isHalfNan(floatToHalf(std::bit_cast<float>(0x7f800001U))));
+  }
+}
+
+TEST_CASE("The half precision kernel matches the scalar conversion", "[half_float]") {
+  INFO("Kernel: " << dataspree::inference::halfFloatKernel());
+
+  SECTION("half to single precision") {
+    auto const halfs = allHalfs();
+    std::vector<float> floats(halfs.size());
+    dataspree::inference::halfToFloat(std::span<uint16_t const>(halfs), std::span<float>(floats));
+
+    std::vector<uint16_t> failures{};
+    // NOLINTNEXTLINE(altera-unroll-loops)
+    for (std::size_t index = 0; index < halfs.size(); ++index) {
+      auto const expected = dataspree::inference::halfToFloat(halfs[index]);
+      if (std::bit_cast<uint32_t>(floats[index]) != std::bit_cast<uint32_t>(expected)) {
+        failures.push_back(halfs[index]);
+      }
+    }
+    CHECK(failures.empty());
+  }
+
+  SECTION("single to half precision") {
+    // Every finite half, the ties between neighbours and the values next to them (positive and negative), with a
+    // length that is not a multiple of the vector width.
+    std::vector<float> floats{ std::numeric_limits<float>::infinity(),
+      std::numeric_limits<float>::quiet_NaN(),
+      1e10F,
+      std::ldexp(1.0F, -30),
+      std::numeric_limits<float>::denorm_min() };
+    // NOLINTNEXTLINE(altera-unroll-loops)
+    for (uint16_t half = 0; half < 0x7bffU; ++half) {
+      auto const lower = dataspree::inference::halfToFloat(half);
+      auto const tie = (lower + dataspree::inference::halfToFloat(static_cast<uint16_t>(half + 1U))) / 2.0F;
+      // NOLINTNEXTLINE(altera-unroll-loops)
+      for (auto const value : { lower, tie, std::nextafter(tie, 0.0F), std::nextafter(tie, 1e10F) }) {
+        floats.push_back(value);
+        floats.push_back(-value);
+      }
+    }
+    REQUIRE(floats.size() % 8 != 0);
+
+    std::vector<uint16_t> halfs(floats.size());
+    dataspree::inference::floatToHalf(std::span<float const>(floats), std::span<uint16_t>(halfs));
+
+    std::vector<float> failures{};
+    // NOLINTNEXTLINE(altera-unroll-loops)
+    for (std::size_t index = 0; index < floats.size(); ++index) {
+      if (halfs[index] != dataspree::inference::floatToHalf(floats[index])) { failures.push_back(floats[index]); }
+    }
+    CHECK(failures.empty());
+  }
+}
+
+TEST_CASE("MAT_RAW_F16 decodes to the nearest half precision values", "[half_float]") {
+  auto const image = rampImage(13, 29, -70000.0F, 70000.0F);
+  auto const [decoded, bytes] = roundTrip(image, "MAT_RAW_F16");
+
+  std::size_t mismatches{ 0 };
+  // NOLINTBEGIN(altera-unroll-loops)
+  for (int row = 0; row < image.rows; ++row) {
+    for (int col = 0; col < image.cols; ++col) {
+      auto const half = dataspree::inference::floatToHalf(image.at<float>(row, col));
+      auto const expected = dataspree::inference::halfToFloat(half);
+      mismatches += decoded.at<float>(row, col) == expected ? 0U : 1U;
+    }
+  }
+  // NOLINTEND(altera-unroll-loops)
+  CHECK(mismatches == 0);
+}
+
+TEST_CASE("Quantized MAT_RAW stays within half of the transmitted scale", "[half_float]") {
+  auto const encoding = GENERATE(std::string("MAT_RAW_Q8"), std::string("MAT_RAW_Q16"));
+  auto const levels = encoding == "MAT_RAW_Q8" ? double{ std::numeric_limits<uint8_t>::max() }
+                                               : double{ std::numeric_limits<uint16_t>::max() };
+  auto const minimum = GENERATE(-1000.0F, 0.25F);
+  auto const maximum = minimum + GENERATE(1.0F, 3000.0F);
+  INFO(encoding << " over [" << minimum << ", " << maximum << "]");
+
+  auto const image = rampImage(17, 31, minimum, maximum);
+  auto const [decoded, bytes] = roundTrip(image, encoding);
+
+  // The header holds the scale and the offset with which value = quantized * scale + offset.
+  auto const scale = readDouble(bytes, 0);
+  auto const offset = readDouble(bytes, sizeof(double));
+  CHECK(offset == Approx(minimum));
+  CHECK(scale == Approx((static_cast<double>(maximum) - static_cast<double>(minimum)) / levels));
+
+  // Half of the scale, plus the rounding of the decoded single precision values.
+  auto const bound = scale / 2.0 + (std::abs(offset) + scale * levels) * std::numeric_limits<float>::epsilon();
+  double maximumError{ 0.0 };
+  // NOLINTBEGIN(altera-unroll-loops)
+  for (int row = 0; row < image.rows; ++row) {
+    for (int col = 0; col < image.cols; ++col) {
+      auto const error = std::abs(static_cast<double>(decoded.at<float>(row, col)) - image.at<float>(row, col));
+      maximumError = std::max(maximumError, error);
+    }
+  }
+  // NOLINTEND(altera-unroll-loops)
+  CHECK(maximumError <= bound);
+}
+
+TEST_CASE("Quantized MAT_RAW restores constant images", "[half_float]") {
+  auto const encoding = GENERATE(std::string("MAT_RAW_Q8"), std::string("MAT_RAW_Q16"));
+  auto const image = rampImage(5, 7, 42.5F, 42.5F);
+  auto const [decoded, bytes] = roundTrip(image, encoding);
+
+  CHECK(readDouble(bytes, 0) == 1.0);
+  CHECK(readDouble(bytes, sizeof(double)) == 42.5);
+  CHECK(decoded.at<float>(4, 6) == 42.5F);
+}
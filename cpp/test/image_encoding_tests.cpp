@@ -0,0 +1,125 @@
+#include <Conversion.hpp>
+
+#include <catch2/catch.hpp>
+#include <opencv2/core/mat.hpp>
+
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <vector>
+
+namespace {
+
+/// Offset of the rank in a MAT_RAW payload (after the numpy kind and the element size).
+constexpr std::size_t matRawRankOffset{ 2 };
+
+/// Sizes of the QOI header and end marker, and of an RGB chunk.
+constexpr std::size_t qoiHeaderSize{ 14 };
+constexpr std::size_t qoiPaddingSize{ 8 };
+constexpr std::size_t qoiRgbSize{ 4 };
+
+/// \return single-row image of #cols pixels, alternating between the first #channels values of #first and #second.
+[[nodiscard]] auto alternatingImage(int cols,
+  int channels,
+  std::vector<unsigned char> const &first,
+  std::vector<unsigned char> const &second) -> cv::Mat {
+  cv::Mat image(1, cols, CV_MAKETYPE(CV_8U, channels));
+  auto const pixelSize = static_cast<std::size_t>(channels);
+  // NOLINTNEXTLINE(altera-unroll-loops)
+  for (int col = 0; col < cols; ++col) {
+    auto const &pixel = col % 2 == 0 ? first : second;
+    std::memcpy(image.ptr<unsigned char>(0) + static_cast<std::size_t>(col) * pixelSize, pixel.data(), pixelSize);
+  }
+  return image;
+}
+
+/// \return image of #sizes with #channels channels of 8 bits and values that differ between neighbouring elements.
+[[nodiscard]] auto patternImage(std::vector<int> const &sizes, int channels) -> cv::Mat {
+  cv::Mat image(static_cast<int>(sizes.size()), sizes.data(), CV_MAKETYPE(CV_8U, channels));
+  // NOLINTNEXTLINE(altera-unroll-loops)
+  for (std::size_t index = 0; index < image.total() * image.elemSize(); ++index) {
+    image.data[index] = static_cast<unsigned char>(index * 7U + 3U);
+  }
+  return image;
+}
+
+/// \return decoded #image after encoding it with #encoding, and the encoded payload.
+[[nodiscard]] auto roundTrip(cv::Mat const &image, std::string const &encoding)
+  -> std::pair<cv::Mat, std::vector<unsigned char>> {
+  auto bytes = dataspree::inference::encodeImage(image, encoding);
+  REQUIRE(!bytes.empty());
+  dataspree::inference::Buffer payload(std::string(bytes.begin(), bytes.end()));
+  auto decoded = dataspree::inference::decodeImage(payload, encoding);
+  REQUIRE(decoded.has_value());
+  return { decoded.value(), std::move(bytes) };
+}
+
+/// \return true if #decoded has the sizes, type and content of #image.
+[[nodiscard]] auto equals(cv::Mat const &decoded, cv::Mat const &image) -> bool {
+  if (decoded.dims != image.dims || decoded.type() != image.type() || !decoded.isContinuous()) { return false; }
+  // NOLINTNEXTLINE(altera-unroll-loops)
+  for (int dimension = 0; dimension < image.dims; ++dimension) {
+    if (decoded.size[dimension] != image.size[dimension]) { return false; }
+  }
+  return std::memcmp(decoded.data, image.data, image.total() * image.elemSize()) == 0;
+}
+
+}// namespace
+
+TEST_CASE("MAT_RAW round trips keep the dimensions and channels", "[image_encoding]") {
+  SECTION("2-D, one channel") {
+    auto const image = patternImage({ 7, 11 }, 1);
+    auto const [decoded, bytes] = roundTrip(image, "MAT_RAW");
+    CHECK(bytes[matRawRankOffset] == 3);
+    CHECK(equals(decoded, image));
+  }
+
+  SECTION("2-D, three channels") {
+    auto const image = patternImage({ 7, 11 }, 3);
+    auto const [decoded, bytes] = roundTrip(image, "MAT_RAW");
+    CHECK(bytes[matRawRankOffset] == 3);
+    CHECK(equals(decoded, image));
+  }
+
+  SECTION("3-D, one channel") {
+    auto const image = patternImage({ 4, 5, 6 }, 1);
+    auto const [decoded, bytes] = roundTrip(image, "MAT_RAW");
+    CHECK(bytes[matRawRankOffset] == 4);
+    CHECK(equals(decoded, image));
+  }
+}
+
+TEST_CASE("QOI round trips are lossless", "[image_encoding]") {
+  SECTION("BGR and BGRA") {
+    auto const channels = GENERATE(3, 4);
+    auto const image = patternImage({ 13, 17 }, channels);
+    auto const [decoded, bytes] = roundTrip(image, "IMAGE_QOI");
+    CHECK(equals(decoded, image));
+  }
+
+  SECTION("runs") {
+    // An RGB chunk for the first pixel and runs of at most 62 pixels for the others.
+    auto const image = alternatingImage(200, 3, { 30, 20, 10 }, { 30, 20, 10 });
+    auto const [decoded, bytes] = roundTrip(image, "IMAGE_QOI");
+    CHECK(bytes.size() == qoiHeaderSize + qoiRgbSize + 4 + qoiPaddingSize);
+    CHECK(equals(decoded, image));
+  }
+
+  SECTION("index hits") {
+    // RGB chunks for the first two pixels, which are too different for DIFF or LUMA chunks, and index hits after.
+    auto const channels = GENERATE(3, 4);
+    auto const image = alternatingImage(50, channels, { 0, 0, 200, 255 }, { 200, 100, 50, 255 });
+    auto const [decoded, bytes] = roundTrip(image, "IMAGE_QOI");
+    CHECK(bytes.size() == qoiHeaderSize + 2 * qoiRgbSize + 48 + qoiPaddingSize);
+    CHECK(equals(decoded, image));
+  }
+
+  SECTION("the index starts with transparent black") {
+    // Opaque black must not hit the initial index, which a decoder following the specification reads as transparent.
+    auto const image = alternatingImage(2, 4, { 0, 0, 200, 255 }, { 0, 0, 0, 255 });
+    auto const [decoded, bytes] = roundTrip(image, "IMAGE_QOI");
+    CHECK(std::vector<unsigned char>(bytes.begin() + qoiHeaderSize, bytes.end() - qoiPaddingSize)
+          == std::vector<unsigned char>{ 0xfe, 200, 0, 0, 0xfe, 0, 0, 0 });
+    CHECK(equals(decoded, image));
+  }
+}
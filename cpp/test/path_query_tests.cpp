@@ -0,0 +1,93 @@
+#include <dataspree/inference/core/Detection.hpp>
+#include <dataspree/inference/core/Item.hpp>
+#include <dataspree/inference/core/PathQuery.hpp>
+
+#include <catch2/catch.hpp>
+
+#include <string>
+#include <vector>
+
+namespace {
+
+/// \return detection item with the given confidence.
+auto detection(double confidence) -> dataspree::inference::core::Item {
+  dataspree::inference::core::Item item{};
+  item["x"] = 0.5;
+  item["confidence"] = confidence;
+  return item;
+}
+
+/// \return message item with two detections and a list of ROIs at two levels.
+auto message() -> dataspree::inference::core::Item {
+  dataspree::inference::core::Item item{};
+  item["inference"]["detection"] = std::vector<dataspree::inference::core::Item>{ detection(0.25), detection(0.75) };
+  item["inference"]["rois"] = std::vector<dataspree::inference::core::Item>{ dataspree::inference::core::Item(1) };
+  item["camera"]["rois"] = std::vector<dataspree::inference::core::Item>{};
+  return item;
+}
+
+/// \return the confidences of #matches.
+auto confidences(std::span<dataspree::inference::core::Item const *const> matches) -> std::vector<double> {
+  std::vector<double> values{};
+  // NOLINTNEXTLINE(altera-unroll-loops)
+  for (auto const *match : matches) { values.push_back(match->at<double>()); }
+  return values;
+}
+
+}// namespace
+
+TEST_CASE("Path queries select keys and indices", "[path_query]") {
+  auto const item = message();
+  std::vector<dataspree::inference::core::Item const *> matches{};
+
+  auto const confidence = dataspree::inference::core::PathQuery::parse("inference.detection.1.confidence");
+  CHECK(confidences(confidence.execute(item, matches)) == std::vector<double>{ 0.75 });
+  CHECK(confidence.first(item) == &item.at("inference").at("detection").at(1U).at("confidence"));
+
+  CHECK(dataspree::inference::core::PathQuery::parse("inference.detection.2.confidence").first(item) == nullptr);
+  CHECK(dataspree::inference::core::PathQuery::parse("inference.missing").execute(item, matches).empty());
+}
+
+TEST_CASE("Path queries match any element with * and any level with **", "[path_query]") {
+  auto const item = message();
+  std::vector<dataspree::inference::core::Item const *> matches{};
+
+  SECTION("*") {
+    auto const query = dataspree::inference::core::PathQuery({ "inference", "detection", "*", "confidence" });
+    CHECK(confidences(query.execute(item, matches)) == std::vector<double>{ 0.25, 0.75 });
+  }
+
+  SECTION("**") {
+    auto const query = dataspree::inference::core::PathQuery({ "**", "rois" });
+    REQUIRE(query.execute(item, matches).size() == 2);
+    CHECK(matches[0] == &item.at("camera").at("rois"));
+    CHECK(matches[1] == &item.at("inference").at("rois"));
+
+    CHECK(confidences(dataspree::inference::core::PathQuery({ "**", "confidence" }).execute(item, matches))
+          == std::vector<double>{ 0.25, 0.75 });
+  }
+
+  SECTION("consecutive ** are merged") {
+    CHECK(dataspree::inference::core::PathQuery({ "**", "**", "rois" }).size() == 2);
+  }
+
+  SECTION("nodes reached by several ** are reported once") {
+    dataspree::inference::core::Item nested{};
+    nested["x"]["x"]["y"] = 1;
+
+    auto const query = dataspree::inference::core::PathQuery({ "**", "x", "**" });
+    REQUIRE(query.execute(nested, matches).size() == 3);
+    CHECK(matches[0] == &nested.at("x"));
+    CHECK(matches[1] == &nested.at("x").at("x"));
+    CHECK(matches[2] == &nested.at("x").at("x").at("y"));
+  }
+}
+
+TEST_CASE("Path queries treat typed detections as leaves", "[path_query]") {
+  dataspree::inference::core::Item item{};
+  item["inference"]["detection"] = std::vector<dataspree::inference::core::Detection>(2);
+
+  CHECK(dataspree::inference::core::PathQuery::parse("inference.detection").first(item)
+        == &item.at("inference").at("detection"));
+  CHECK(dataspree::inference::core::PathQuery::parse("inference.detection.*.confidence").first(item) == nullptr);
+}
@@ -0,0 +1,442 @@
+#include <TcpConnection.hpp>
+#include <TileDelta.hpp>
+
+#include <catch2/catch.hpp>
+#include <opencv2/core/mat.hpp>
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <memory>
+#include <optional>
+#include <span>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+namespace {
+
+/// Timeout of the connections under test.
+constexpr std::size_t timeoutMs{ 2000 };
+
+/// Size of the frame header: message size (4 bytes, big endian) and encoding.
+constexpr std::size_t frameHeaderSize{ 5 };
+
+/// Socket that is closed on destruction.
+// NOLINTNEXTLINE(altera-struct-pack-align)
+struct Socket final {
+  explicit Socket(int descriptor) : fd(descriptor) {}
+  ~Socket() { close(this->fd); }
+
+  Socket(Socket const &) = delete;
+  Socket(Socket &&) = delete;
+  auto operator=(Socket const &) -> Socket & = delete;
+  auto operator=(Socket &&) -> Socket & = delete;
+
+  int fd;
+};
+
+/// Loopback server that plays the Dataspree Inference side of the connections under test.
+// NOLINTNEXTLINE(altera-struct-pack-align)
+struct Server final {
+
+  /// \param receiveBufferSize if not 0, the receive buffer size of the accepted sockets.
+  explicit Server(int receiveBufferSize = 0) {
+    if (receiveBufferSize > 0) {
+      setsockopt(this->listener.fd, SOL_SOCKET, SO_RCVBUF, &receiveBufferSize, sizeof(receiveBufferSize));
+    }
+
+    sockaddr_in address{};
+    address.sin_family = AF_INET;
+    address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    socklen_t addressSize{ sizeof(address) };
+    // NOLINTBEGIN(cppcoreguidelines-pro-type-reinterpret-cast)
+    REQUIRE(bind(this->listener.fd, reinterpret_cast<sockaddr *>(&address), sizeof(address)) == 0);
+    REQUIRE(listen(this->listener.fd, 1) == 0);
+    REQUIRE(getsockname(this->listener.fd, reinterpret_cast<sockaddr *>(&address), &addressSize) == 0);
+    // NOLINTEND(cppcoreguidelines-pro-type-reinterpret-cast)
+    this->port = ntohs(address.sin_port);
+  }
+
+  /// \return the next connection.
+  [[nodiscard]] auto accept() const -> std::unique_ptr<Socket> {
+    return std::make_unique<Socket>(::accept(this->listener.fd, nullptr, nullptr));
+  }
+
+  Socket listener{ socket(AF_INET, SOCK_STREAM, 0) };
+  uint16_t port{ 0 };
+};
+
+/// Read #size bytes into #buffer, in reads of at most #chunkSize bytes with #pause after each of them.
+/// \return false if the connection was closed before.
+auto readExactly(int fd,
+  char *buffer,
+  std::size_t size,
+  std::size_t chunkSize = std::numeric_limits<std::size_t>::max(),
+  std::chrono::microseconds pause = {}) -> bool {
+  // NOLINTNEXTLINE(altera-unroll-loops)
+  for (std::size_t offset = 0; offset < size;) {
+    auto const bytesRead = read(fd, &buffer[offset], std::min(size - offset, chunkSize));
+    if (bytesRead <= 0) { return false; }
+    offset += static_cast<std::size_t>(bytesRead);
+    std::this_thread::sleep_for(pause);
+  }
+  return true;
+}
+
+/// Read and decode the next frame like the server does.
+/// \return the decoded message, or std::nullopt if the connection was closed before.
+auto readMessage(int fd, std::size_t chunkSize = std::numeric_limits<std::size_t>::max(),
+  std::chrono::microseconds pause = {}) -> std::optional<dataspree::inference::core::Item> {
+  std::array<char, frameHeaderSize> header{};
+  if (!readExactly(fd, header.data(), header.size(), chunkSize, pause)) { return std::nullopt; }
+  auto const encodingMode = static_cast<dataspree::inference::EncodingMode>(header[4]);
+  auto const size = dataspree::inference::core::readBigEndian<uint32_t>(header.data());
+
+  std::string body(size, '\0');
+  if (!readExactly(fd, body.data(), body.size(), chunkSize, pause)) { return std::nullopt; }
+  return dataspree::inference::decodeItem(body.data(), body.size(), encodingMode);
+}
+
+/// \return frame of the JSON message #body, as sent by the server.
+[[nodiscard]] auto frame(std::string_view body) -> std::string {
+  auto const size = dataspree::inference::core::toBigEndian(static_cast<uint32_t>(body.size()));
+  std::string result(size.begin(), size.end());
+  result.push_back(static_cast<char>(dataspree::inference::EncodingMode::JSON));
+  result.append(body);
+  return result;
+}
+
+/// Write all of #bytes.
+auto writeAll(int fd, std::span<char const> bytes) -> void {
+  // NOLINTNEXTLINE(altera-unroll-loops)
+  while (!bytes.empty()) {
+    auto const bytesWritten = write(fd, bytes.data(), bytes.size());
+    REQUIRE(bytesWritten > 0);
+    bytes = bytes.subspan(static_cast<std::size_t>(bytesWritten));
+  }
+}
+
+/// \return image of #rows x #cols x 3 bytes with values that differ between neighbouring elements.
+[[nodiscard]] auto patternImage(int rows, int cols) -> cv::Mat {
+  cv::Mat image(rows, cols, CV_8UC3);
+  // NOLINTNEXTLINE(altera-unroll-loops)
+  for (std::size_t index = 0; index < image.total() * image.elemSize(); ++index) {
+    image.data[index] = static_cast<unsigned char>(index * 7U + 3U);
+  }
+  return image;
+}
+
+/// \return true if #decoded has the sizes, type and content of #image.
+[[nodiscard]] auto equals(cv::Mat const &decoded, cv::Mat const &image) -> bool {
+  return decoded.rows == image.rows && decoded.cols == image.cols && decoded.type() == image.type()
+         && std::memcmp(decoded.data, image.data, image.total() * image.elemSize()) == 0;
+}
+
+}// namespace
+
+TEST_CASE("Frames are sent completely after partial writes", "[tcp_connection]") {
+  auto const encodingMode =
+    GENERATE(dataspree::inference::EncodingMode::JSON, dataspree::inference::EncodingMode::MSGPACK);
+
+  // Small socket buffers and a slow reader; each frame takes several send timeouts, after each of which sendmsg
+  // returns the part of the frame that was sent so far.
+  static constexpr int bufferSize{ 4096 };
+  static constexpr std::size_t sendTimeoutMs{ 250 };
+  Server const server(bufferSize);
+  dataspree::inference::TcpConnection connection(
+    "127.0.0.1", server.port, dataspree::inference::ReceiveProperties(std::string(""), encodingMode), sendTimeoutMs);
+  REQUIRE(setsockopt(connection.getSocket(), SOL_SOCKET, SO_SNDBUF, &bufferSize, sizeof(bufferSize)) == 0);
+  auto const peer = server.accept();
+
+  static constexpr std::size_t numberOfMessages{ 2 };
+  std::vector<dataspree::inference::core::Item> messages{};
+  std::thread reader([&messages, fd = peer->fd]() {
+    // NOLINTNEXTLINE(altera-unroll-loops)
+    for (std::size_t index = 0; index < numberOfMessages; ++index) {
+      auto message = readMessage(fd, bufferSize, std::chrono::milliseconds(4));
+      if (!message.has_value()) { break; }
+      messages.push_back(std::move(message.value()));
+    }
+  });
+
+  auto const image = patternImage(400, 500);
+  // NOLINTNEXTLINE(altera-unroll-loops)
+  for (std::size_t index = 0; index < numberOfMessages; ++index) {
+    dataspree::inference::core::Item item{};
+    item["index"] = static_cast<int64_t>(index);
+    item["image"] = image;
+    CHECK(connection.sendItem(item, std::string("consumer")));
+  }
+  reader.join();
+
+  CHECK(connection.getNumberOfSocketCalls() > numberOfMessages);
+  REQUIRE(messages.size() == numberOfMessages);
+  // NOLINTNEXTLINE(altera-unroll-loops)
+  for (std::size_t index = 0; index < numberOfMessages; ++index) {
+    CHECK(messages[index].at<std::string>("consumer_name") == "consumer");
+    CHECK(messages[index].at<int64_t>("item", "index") == static_cast<int64_t>(index));
+    CHECK(equals(messages[index].at<cv::Mat>("item", "image"), image));
+  }
+}
+
+TEST_CASE("Frames are received across reads that split them", "[tcp_connection]") {
+  Server const server{};
+  dataspree::inference::TcpConnection connection("127.0.0.1",
+    server.port,
+    dataspree::inference::ReceiveProperties(std::string("producer"), dataspree::inference::EncodingMode::JSON),
+    timeoutMs);
+  auto const peer = server.accept();
+
+  // The configuration message that the connection sends first.
+  auto const configuration = readMessage(peer->fd);
+  REQUIRE(configuration.has_value());
+  CHECK(configuration->at<std::string>("producer_name") == "producer");
+
+  SECTION("split headers and bodies") {
+    std::string bytes{};
+    // NOLINTNEXTLINE(altera-unroll-loops)
+    for (int index = 0; index < 3; ++index) {
+      bytes += frame(R"({"index":)" + std::to_string(index) + R"(,"payload":")" + std::string(100, 'x') + R"("})");
+    }
+
+    // Within the first header, within the first body, within the third header, and the rest.
+    std::thread writer([&bytes, fd = peer->fd]() {
+      std::size_t offset{ 0 };
+      // NOLINTNEXTLINE(altera-unroll-loops)
+      for (std::size_t const end : { std::size_t{ 3 }, std::size_t{ 50 }, 2 * bytes.size() / 3 + 2, bytes.size() }) {
+        writeAll(fd, std::span(bytes).subspan(offset, end - offset));
+        offset = end;
+        std::this_thread::sleep_for(std::chrono::milliseconds(20));
+      }
+    });
+
+    dataspree::inference::core::Item item{};
+    // NOLINTNEXTLINE(altera-unroll-loops)
+    for (int64_t index = 0; index < 3; ++index) {
+      REQUIRE(connection.receiveItemInto(item) == dataspree::inference::ReceiveStatus::OK);
+      CHECK(item.at<int64_t>("index") == index);
+      CHECK(item.at<std::string>("payload") == std::string(100, 'x'));
+    }
+    writer.join();
+  }
+
+  SECTION("several frames per read") {
+    // Small frames that arrive together are parsed from the read buffer without a syscall each.
+    static constexpr int64_t numberOfMessages{ 200 };
+    std::string bytes{};
+    // NOLINTNEXTLINE(altera-unroll-loops)
+    for (int64_t index = 0; index < numberOfMessages; ++index) {
+      bytes += frame(R"({"index":)" + std::to_string(index) + "}");
+    }
+    writeAll(peer->fd, bytes);
+
+    auto const socketCalls = connection.getNumberOfSocketCalls();
+    dataspree::inference::core::Item item{};
+    // NOLINTNEXTLINE(altera-unroll-loops)
+    for (int64_t index = 0; index < numberOfMessages; ++index) {
+      REQUIRE(connection.receiveItemInto(item) == dataspree::inference::ReceiveStatus::OK);
+      CHECK(item.at<int64_t>("index") == index);
+    }
+    CHECK(connection.getNumberOfSocketCalls() - socketCalls < 10);
+  }
+
+  SECTION("closed connection") {
+    writeAll(peer->fd, frame(R"({"index":0})").substr(0, 7));
+    shutdown(peer->fd, SHUT_WR);
+    CHECK(!connection.receiveItem().has_value());
+    CHECK(connection.getReceiveStatus() == dataspree::inference::ReceiveStatus::CLOSED);
+  }
+}
+
+TEST_CASE("Only the latest received messages are kept and the others are counted as dropped", "[tcp_connection]") {
+  Server const server{};
+  dataspree::inference::TcpConnection connection("127.0.0.1",
+    server.port,
+    dataspree::inference::ReceiveProperties(std::string("producer"), dataspree::inference::EncodingMode::JSON),
+    timeoutMs);
+  auto const peer = server.accept();
+  REQUIRE(readMessage(peer->fd).has_value());
+
+  static constexpr std::size_t kept{ 2 };
+  static constexpr int64_t numberOfMessages{ 10 };
+  REQUIRE(connection.setLatestMessagesOnly(kept));
+
+  std::string bytes{};
+  // NOLINTNEXTLINE(altera-unroll-loops)
+  for (int64_t index = 0; index < numberOfMessages; ++index) {
+    bytes += frame(R"({"index":)" + std::to_string(index) + "}");
+  }
+  writeAll(peer->fd, bytes);
+
+  // The background receiver drains the socket without a consumer.
+  auto const deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(timeoutMs);
+  // NOLINTNEXTLINE(altera-unroll-loops)
+  while (connection.getNumberOfMessagesDropped() < numberOfMessages - kept
+         && std::chrono::steady_clock::now() < deadline) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+  }
+  CHECK(connection.getNumberOfMessagesDropped() == numberOfMessages - kept);
+
+  dataspree::inference::core::Item item{};
+  REQUIRE(connection.receiveItemInto(item) == dataspree::inference::ReceiveStatus::OK);
+  CHECK(item.at<int64_t>("index") == numberOfMessages - 2);
+  REQUIRE(connection.receiveItemInto(item) == dataspree::inference::ReceiveStatus::OK);
+  CHECK(item.at<int64_t>("index") == numberOfMessages - 1);
+
+  shutdown(peer->fd, SHUT_WR);
+  CHECK(connection.receiveItemInto(item) == dataspree::inference::ReceiveStatus::CLOSED);
+  CHECK(connection.getNumberOfMessagesDropped() == numberOfMessages - kept);
+}
+
+TEST_CASE("Only the latest received messages cannot be kept with tile delta decoding", "[tcp_connection]") {
+  Server const server{};
+  dataspree::inference::DecodeProperties decodeProperties{};
+  decodeProperties.tileDeltaDecoder = std::make_shared<dataspree::inference::TileDeltaDecoder>();
+  dataspree::inference::ReceiveProperties receiveProperties(std::string(""));
+  receiveProperties.setDecodeProperties(decodeProperties);
+  dataspree::inference::TcpConnection connection("127.0.0.1", server.port, std::move(receiveProperties), timeoutMs);
+
+  CHECK(!connection.setLatestMessagesOnly(2));
+  CHECK(connection.getLatestMessagesOnly() == 0);
+}
+
+TEST_CASE("Frames of several producer threads do not interleave", "[tcp_connection]") {
+  Server const server{};
+  dataspree::inference::TcpConnection connection("127.0.0.1",
+    server.port,
+    dataspree::inference::ReceiveProperties(std::string(""), dataspree::inference::EncodingMode::JSON),
+    timeoutMs);
+  auto const peer = server.accept();
+  REQUIRE(connection.setMultiProducer(16));
+
+  static constexpr int64_t numberOfThreads{ 4 };
+  static constexpr int64_t numberOfMessages{ 100 };
+  std::vector<dataspree::inference::core::Item> messages{};
+  std::thread reader([&messages, fd = peer->fd]() {
+    // NOLINTNEXTLINE(altera-unroll-loops)
+    for (int64_t index = 0; index < numberOfThreads * numberOfMessages; ++index) {
+      auto message = readMessage(fd);
+      if (!message.has_value()) { break; }
+      messages.push_back(std::move(message.value()));
+    }
+  });
+
+  // Payloads of up to 64 KiB, such that frames take several writes.
+  auto const payload = [](int64_t thread, int64_t index) {
+    auto const size = static_cast<std::size_t>((index * 997 + thread * 7919) % 65536);
+    return std::string(size, static_cast<char>('a' + thread));
+  };
+
+  // Catch assertions are not thread-safe.
+  std::atomic<std::size_t> failedSends{ 0 };
+  std::vector<std::thread> producers{};
+  // NOLINTNEXTLINE(altera-unroll-loops)
+  for (int64_t thread = 0; thread < numberOfThreads; ++thread) {
+    producers.emplace_back([&connection, &payload, &failedSends, thread]() {
+      // NOLINTNEXTLINE(altera-unroll-loops)
+      for (int64_t index = 0; index < numberOfMessages; ++index) {
+        dataspree::inference::core::Item item{};
+        item["thread"] = thread;
+        item["index"] = index;
+        item["payload"] = payload(thread, index);
+        if (!connection.sendItem(item, std::string("consumer"))) { ++failedSends; }
+      }
+    });
+  }
+  // NOLINTNEXTLINE(altera-unroll-loops)
+  for (auto &producer : producers) { producer.join(); }
+  CHECK(failedSends.load() == 0);
+
+  // Sends the queued messages.
+  REQUIRE(connection.setMultiProducer(0));
+  CHECK(connection.getNumberOfPendingSends() == 0);
+  CHECK(connection.getNumberOfMessagesSent() == numberOfThreads * numberOfMessages);
+  reader.join();
+
+  // The messages of each thread arrive complete and in the order in which they were sent.
+  REQUIRE(messages.size() == numberOfThreads * numberOfMessages);
+  std::array<int64_t, numberOfThreads> next{};
+  // NOLINTNEXTLINE(altera-unroll-loops)
+  for (auto const &message : messages) {
+    auto const thread = message.at<int64_t>("item", "thread");
+    auto const index = message.at<int64_t>("item", "index");
+    REQUIRE(thread < numberOfThreads);
+    CHECK(index == next.at(static_cast<std::size_t>(thread))++);
+    CHECK(message.at<std::string>("item", "payload") == payload(thread, index));
+  }
+}
+
+TEST_CASE("Several items are sent in batches", "[tcp_connection]") {
+  Server const server{};
+  dataspree::inference::TcpConnection connection("127.0.0.1",
+    server.port,
+    dataspree::inference::ReceiveProperties(std::string(""), dataspree::inference::EncodingMode::JSON),
+    timeoutMs);
+  auto const peer = server.accept();
+
+  static constexpr std::size_t numberOfItems{ 10 };
+  static constexpr std::size_t maxBatchSize{ 4 };
+  std::vector<dataspree::inference::core::Item> items(numberOfItems);
+  // NOLINTNEXTLINE(altera-unroll-loops)
+  for (std::size_t index = 0; index < numberOfItems; ++index) { items[index]["index"] = static_cast<int64_t>(index); }
+
+  SECTION("one frame per item") {
+    connection.setBatchProperties({ .maxBatchSize = maxBatchSize });
+    REQUIRE(connection.sendItems(items, std::string("consumer")));
+
+    // The frames of a batch are written with a single call.
+    CHECK(connection.getNumberOfSocketCalls() == (numberOfItems + maxBatchSize - 1) / maxBatchSize);
+    CHECK(connection.getNumberOfMessagesSent() == numberOfItems);
+    // NOLINTNEXTLINE(altera-unroll-loops)
+    for (std::size_t index = 0; index < numberOfItems; ++index) {
+      auto const message = readMessage(peer->fd);
+      REQUIRE(message.has_value());
+      CHECK(message->at<std::string>("consumer_name") == "consumer");
+      CHECK(message->at<int64_t>("item", "index") == static_cast<int64_t>(index));
+    }
+  }
+
+  SECTION("envelopes") {
+    connection.setBatchProperties({ .maxBatchSize = maxBatchSize, .envelope = true });
+    REQUIRE(connection.sendItems(items, std::string("consumer")));
+
+    std::size_t index{ 0 };
+    // NOLINTNEXTLINE(altera-unroll-loops)
+    for (std::size_t const batchSize : { maxBatchSize, maxBatchSize, numberOfItems - 2 * maxBatchSize }) {
+      auto const message = readMessage(peer->fd);
+      REQUIRE(message.has_value());
+      CHECK(message->at<std::string>("consumer_name") == "consumer");
+      auto const &batch = message->at<std::vector<dataspree::inference::core::Item>>("items");
+      REQUIRE(batch.size() == batchSize);
+      // NOLINTNEXTLINE(altera-unroll-loops)
+      for (auto const &item : batch) { CHECK(item.at<int64_t>("index") == static_cast<int64_t>(index++)); }
+    }
+  }
+
+  SECTION("multi-producer") {
+    connection.setBatchProperties({ .maxBatchSize = maxBatchSize, .linger = std::chrono::milliseconds(5) });
+    REQUIRE(connection.setMultiProducer(numberOfItems));
+    REQUIRE(connection.sendItems(items, std::string("consumer")));
+    REQUIRE(connection.setMultiProducer(0));
+
+    // The writer sends the queued messages in batches of at most maxBatchSize.
+    CHECK(connection.getNumberOfSocketCalls() >= (numberOfItems + maxBatchSize - 1) / maxBatchSize);
+    // NOLINTNEXTLINE(altera-unroll-loops)
+    for (std::size_t index = 0; index < numberOfItems; ++index) {
+      auto const message = readMessage(peer->fd);
+      REQUIRE(message.has_value());
+      CHECK(message->at<int64_t>("item", "index") == static_cast<int64_t>(index));
+    }
+  }
+}
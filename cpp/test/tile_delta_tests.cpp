@@ -0,0 +1,73 @@
+#include <TileDelta.hpp>
+
+#include <catch2/catch.hpp>
+#include <opencv2/core/mat.hpp>
+
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+namespace {
+
+/// Offsets of the header fields of an IMAGE_TILE_DELTA payload.
+constexpr std::size_t rowsOffset{ 21 };
+constexpr std::size_t typeOffset{ 29 };
+constexpr std::size_t numberOfTilesOffset{ 37 };
+
+auto writeUint32(std::vector<unsigned char> &payload, std::size_t offset, uint32_t value) -> void {
+  // NOLINTNEXTLINE(altera-unroll-loops)
+  for (std::size_t index = 0; index < sizeof(uint32_t); ++index) {
+    payload[offset + index] = static_cast<unsigned char>(value >> (8U * index));
+  }
+}
+
+/// \return keyframe payload of a 3-channel 8-bit image of 100 x 70 pixels in tiles of 32 pixels.
+auto keyframe() -> std::vector<unsigned char> {
+  cv::Mat image(70, 100, CV_8UC3);
+  // NOLINTNEXTLINE(altera-unroll-loops)
+  for (std::size_t index = 0; index < image.total() * image.elemSize(); ++index) {
+    image.data[index] = static_cast<unsigned char>(index * 7U);
+  }
+  dataspree::inference::TileDeltaEncoder encoder({ .tileSize = 32 });
+  return encoder.encode("image", image);
+}
+
+}// namespace
+
+TEST_CASE("Tile delta keyframes are decoded", "[tile_delta]") {
+  auto const payload = keyframe();
+  dataspree::inference::TileDeltaDecoder decoder{};
+  auto const frame = decoder.decode("image", payload);
+  REQUIRE(frame.has_value());
+  CHECK(frame->rows == 70);
+  CHECK(frame->cols == 100);
+  CHECK(frame->type() == CV_8UC3);
+  CHECK(std::memcmp(frame->data, &payload[45], 32 * 3) == 0);
+}
+
+TEST_CASE("Malformed tile delta keyframes are rejected without allocating their frame", "[tile_delta]") {
+  auto payload = keyframe();
+  dataspree::inference::TileDeltaDecoder decoder{};
+
+  SECTION("type with more than the depth and the channels") {
+    writeUint32(payload, typeOffset, 1U << 20U);
+    CHECK_FALSE(decoder.decode("image", payload).has_value());
+  }
+
+  SECTION("size beyond the payload") {
+    writeUint32(payload, rowsOffset, 1U << 30U);
+    writeUint32(payload, rowsOffset + sizeof(uint32_t), 1U << 30U);
+    CHECK_FALSE(decoder.decode("image", payload).has_value());
+  }
+
+  SECTION("missing tiles") {
+    writeUint32(payload, numberOfTilesOffset, 5);
+    CHECK_FALSE(decoder.decode("image", payload).has_value());
+  }
+
+  SECTION("tiles out of order") {
+    // The index of the first tile (which follows the header) is overwritten with the index of the second one.
+    writeUint32(payload, numberOfTilesOffset + sizeof(uint32_t), 1);
+    CHECK_FALSE(decoder.decode("image", payload).has_value());
+  }
+}